@@ -0,0 +1,158 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2016-2018 The Cats Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <cstdio>
+
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "Cats/Corecat/Concurrent.hpp"
+#include "Cats/Corecat/Data/AsyncFile.hpp"
+
+
+using namespace Cats::Corecat;
+
+
+constexpr std::size_t CHUNK_SIZE = 65536;
+constexpr std::size_t CHUNK_COUNT = 32;
+
+class Reader : public Coroutine<Reader> {
+    
+private:
+    
+    AsyncFile* file;
+    std::vector<char> buffer;
+    std::uint64_t offset = 0;
+    std::size_t count = 0;
+    
+public:
+    
+    std::uint64_t total = 0;
+    
+public:
+    
+    Reader(AsyncFile& file_) : file(&file_), buffer(CHUNK_SIZE * 4) {}
+    
+    void operator ()() {
+        
+        CORECAT_COROUTINE {
+            
+            while(true) {
+                
+                CORECAT_AWAIT_FOR(file->read(buffer.data(), buffer.size(), offset), count);
+                if(!count) break;
+                offset += count, total += count;
+                
+            }
+            
+        }
+        
+    }
+    
+};
+
+int main() {
+    
+    try {
+        
+        AsyncFileContext context;
+        std::cout << "Backend: " << (context.isIOUring() ? "io_uring" : "ThreadPoolExecutor") << std::endl;
+        
+        std::vector<char> data(CHUNK_SIZE * CHUNK_COUNT);
+        for(std::size_t i = 0; i < data.size(); ++i) data[i] = char(i * 7);
+        
+        {
+            
+            // Keep every block in flight at once
+            AsyncFile file(context, "AsyncFile.tmp", AsyncFile::Mode::WRITE);
+            std::size_t written = 0;
+            for(std::size_t i = 0; i < CHUNK_COUNT; ++i)
+                file.write(data.data() + i * CHUNK_SIZE, CHUNK_SIZE, i * CHUNK_SIZE).then([&](std::size_t n) { written += n; });
+            context.run();
+            std::cout << "Written: " << written << std::endl;
+            
+        }
+        
+        AsyncFile file(context, "AsyncFile.tmp");
+        
+        auto reader = std::make_shared<Reader>(file);
+        (*reader)();
+        context.run();
+        std::cout << "Read: " << reader->total << std::endl;
+        
+        std::vector<Byte> fixed(CHUNK_SIZE * CHUNK_COUNT);
+        ArrayView<Byte> buffers[] = {{fixed.data(), fixed.size()}};
+        context.registerBuffers(buffers);
+        std::size_t mismatch = 0;
+        for(std::size_t i = 0; i < CHUNK_COUNT; ++i)
+            file.readFixed(0, i * CHUNK_SIZE, CHUNK_SIZE, i * CHUNK_SIZE);
+        context.run();
+        for(std::size_t i = 0; i < data.size(); ++i) mismatch += static_cast<char>(fixed[i]) != data[i];
+        context.unregisterBuffers();
+        std::cout << "Mismatch: " << mismatch << std::endl;
+        
+        // A read running past the end of the file stops there on either backend
+        std::vector<char> whole(data.size() + CHUNK_SIZE);
+        for(bool tryIOUring : {true, false}) {
+            
+            AsyncFileContext c(16, tryIOUring);
+            AsyncFile f(c, "AsyncFile.tmp");
+            std::size_t n = 0;
+            f.read(whole.data(), whole.size(), 0).then([&](std::size_t x) { n = x; });
+            c.run();
+            std::cout << "Read past the end (" << (c.isIOUring() ? "io_uring" : "ThreadPoolExecutor") << "): " << n << std::endl;
+            
+        }
+        
+        // A continuation that queues a new read while later reads of the same batch are still to be settled
+        for(bool tryIOUring : {true, false}) {
+            
+            AsyncFileContext c(16, tryIOUring);
+            AsyncFile f(c, "AsyncFile.tmp");
+            std::vector<char> a(200), b(400), chained(300);
+            std::size_t na = 0, nb = 0, nc = 0;
+            f.read(a.data(), a.size(), 0).then([&](std::size_t x) {
+                
+                na = x;
+                f.read(chained.data(), chained.size(), 1000).then([&](std::size_t y) { nc = y; });
+                
+            });
+            f.read(b.data(), b.size(), 2000).then([&](std::size_t x) { nb = x; });
+            c.run();
+            std::cout << "Chained read (" << (c.isIOUring() ? "io_uring" : "ThreadPoolExecutor") << "): "
+                << na << " " << nb << " " << nc << std::endl;
+                
+        }
+        
+        file.close();
+        std::remove("AsyncFile.tmp");
+        
+    } catch(std::exception& e) { std::cerr << e.what() << std::endl; return 1; }
+    
+    return 0;
+    
+}
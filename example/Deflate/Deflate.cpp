@@ -0,0 +1,144 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2016-2018 The Cats Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <iostream>
+#include <vector>
+
+#include "Cats/Corecat/Concurrent.hpp"
+#include "Cats/Corecat/Data.hpp"
+#include "Cats/Corecat/Data/Stream/DeflateOutputStream.hpp"
+#include "Cats/Corecat/Data/Stream/InflateInputStream.hpp"
+
+
+using namespace Cats::Corecat;
+
+
+class VectorOutputStream : public OutputStream<char> {
+    
+public:
+    
+    std::vector<char> data;
+    
+public:
+    
+    std::size_t write(const char* buffer, std::size_t count) override { data.insert(data.end(), buffer, buffer + count); return count; }
+    void flush() override {}
+    
+};
+
+template <typename F>
+double measure(std::size_t size, F&& f) {
+    
+    auto startTime = std::chrono::high_resolution_clock::now();
+    f();
+    auto endTime = std::chrono::high_resolution_clock::now();
+    return size / std::chrono::duration<double>(endTime - startTime).count() / 1048576;
+    
+}
+
+int main() {
+    
+    try {
+        
+        // Text-like input: words drawn from a small vocabulary
+        const char* word[] = {"the ", "quick ", "brown ", "fox ", "jumps ", "over ", "lazy ", "dog ", "Corecat ", "stream ", "\n"};
+        std::vector<char> input;
+        std::uint32_t seed = 1;
+        while(input.size() < 16777216) {
+            
+            seed = seed * 1103515245 + 12345;
+            for(auto p = word[(seed >> 16) % 11]; *p; ++p) input.push_back(*p);
+            
+        }
+        
+        {
+            
+            // Block mode on the only pool thread compresses the blocks the pool cannot get to itself
+            ThreadPoolExecutor pool(1);
+            VectorOutputStream compressed;
+            std::promise<void> result;
+            auto future = result.get_future();
+            pool.execute([&] {
+                
+                try {
+                    
+                    auto os = createDeflateOutputStream(compressed, pool);
+                    os.writeAll(input.data(), 1048576);
+                    os.finish();
+                    result.set_value();
+                    
+                } catch(...) { result.set_exception(std::current_exception()); }
+                
+            });
+            future.get();
+            std::vector<char> output(1048576);
+            MemoryDataView<char> dv(compressed.data.data(), compressed.data.size());
+            auto dvis = createDataViewInputStream(dv);
+            auto is = createInflateInputStream(dvis);
+            is.readAll(output.data(), output.size());
+            std::cout << "Block mode from a pool thread: " << (std::equal(output.begin(), output.end(), input.begin()) ? "matches" : "MISMATCH") << std::endl;
+            
+        }
+        
+        ThreadPoolExecutor executor;
+        for(int level : {1, 6, 9}) {
+            
+            for(bool block : {false, true}) {
+                
+                VectorOutputStream compressed;
+                double deflateSpeed = measure(input.size(), [&] {
+                    
+                    auto os = block ? createDeflateOutputStream(compressed, executor, level) : createDeflateOutputStream(compressed, level);
+                    os.writeAll(input.data(), input.size());
+                    os.finish();
+                    
+                });
+                
+                std::vector<char> output(input.size());
+                MemoryDataView<char> dv(compressed.data.data(), compressed.data.size());
+                double inflateSpeed = measure(input.size(), [&] {
+                    
+                    auto dvis = createDataViewInputStream(dv);
+                    auto is = createInflateInputStream(dvis);
+                    is.readAll(output.data(), output.size());
+                    
+                });
+                
+                std::cout << "zlib level " << level << (block ? " block" : " stream") << ": ratio " << (double(compressed.data.size()) / input.size())
+                    << ", deflate " << deflateSpeed << " MB/s, inflate " << inflateSpeed << " MB/s" << (output == input ? "" : " (MISMATCH)") << std::endl;
+                    
+            }
+            
+        }
+        
+    } catch(std::exception& e) { std::cerr << e.what() << std::endl; return 1; }
+    
+    return 0;
+    
+}
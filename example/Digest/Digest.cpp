@@ -0,0 +1,313 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2016-2018 The Cats Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Cats/Corecat/Concurrent.hpp"
+#include "Cats/Corecat/Data/DataView.hpp"
+#include "Cats/Corecat/Data/Digest.hpp"
+#include "Cats/Corecat/Data/Stream.hpp"
+
+
+using namespace Cats::Corecat;
+
+
+class NullOutputStream : public OutputStream<char> {
+    
+public:
+    
+    std::size_t write(const char* /*buffer*/, std::size_t count) override { return count; }
+    void flush() override {}
+    
+};
+
+// Hashes size bytes repeatedly for about 0.2 s and returns GB/s
+template <typename F>
+double measure(std::size_t size, F&& f) {
+    
+    using Clock = std::chrono::high_resolution_clock;
+    std::size_t count = 0;
+    auto startTime = Clock::now(), endTime = startTime;
+    do {
+        
+        for(std::size_t i = 0; i < 16; ++i) f();
+        count += 16;
+        endTime = Clock::now();
+        
+    } while(endTime - startTime < std::chrono::milliseconds(200));
+    return double(size) * count / std::chrono::duration<double>(endTime - startTime).count() / 1e9;
+    
+}
+
+// Whether a digest reused after reset() in the middle of a message agrees with a fresh one
+template <typename D>
+bool checkReset(const std::vector<Byte>& data) {
+    
+    D fresh, reused;
+    fresh.update({data.data(), 100});
+    reused.update({data.data() + 1000, 37});
+    reused.reset();
+    reused.update({data.data(), 100});
+    return fresh.finish() == reused.finish();
+    
+}
+
+template <std::size_t N>
+std::string toHex(const std::array<Byte, N>& digest) {
+    
+    std::string s;
+    for(auto b : digest) {
+        
+        char t[3];
+        std::snprintf(t, sizeof(t), "%02x", unsigned(b));
+        s += t;
+        
+    }
+    return s;
+    
+}
+
+ArrayView<const Byte> toView(const std::string& s) { return {reinterpret_cast<const Byte*>(s.data()), s.size()}; }
+
+// Runs a Merkle-Damgard transform on its own, without the dispatch in SHA256 and SHA1
+template <std::size_t N, typename F>
+std::string hashSoftware(const std::uint32_t (&h)[N], const std::string& message, F&& transform) {
+    
+    std::uint32_t state[N];
+    std::copy(h, h + N, state);
+    auto f = [&](const unsigned char* p, std::size_t count) { transform(state, p, count); };
+    Data::Impl::DigestBlockBuffer buffer;
+    buffer.update(reinterpret_cast<const unsigned char*>(message.data()), message.size(), f);
+    buffer.finish(f);
+    std::array<Byte, N * 4> digest;
+    for(std::size_t i = 0; i < N; ++i) Data::Impl::storeBigEndian32(reinterpret_cast<unsigned char*>(digest.data()) + i * 4, state[i]);
+    return toHex(digest);
+    
+}
+
+// Checks the published test vectors against both the dispatching and the software paths
+void checkKnownAnswers() {
+    
+    const std::string check = "123456789";
+    auto p = reinterpret_cast<const unsigned char*>(check.data());
+    CRC32C crc;
+    crc.update(toView(check));
+    std::cout << "Known answers: CRC32C " << (crc.finish() == 0xE3069283)
+        << ", software " << (~Data::Impl::updateCRC32CSoftware(0xFFFFFFFF, p, check.size()) == 0xE3069283);
+        
+    // FIPS 180 examples
+    struct { std::string message, sha1, sha256; } sha[] = {
+        {"abc", "a9993e364706816aba3e25717850c26c9cd0d89d", "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"},
+        {"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", "84983e441c3bd26ebaae4aa1f95129e5e54670f1",
+            "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"},
+    };
+    bool sha1 = true, sha1Software = true, sha256 = true, sha256Software = true;
+    for(auto& x : sha) {
+        
+        sha1 &= toHex(SHA1::hash(toView(x.message))) == x.sha1;
+        sha1Software &= hashSoftware(Data::Impl::SHA1_H, x.message, Data::Impl::transformSHA1Software) == x.sha1;
+        sha256 &= toHex(SHA256::hash(toView(x.message))) == x.sha256;
+        sha256Software &= hashSoftware(Data::Impl::SHA256_H, x.message, Data::Impl::transformSHA256Software) == x.sha256;
+        
+    }
+    std::cout << ", SHA-1 " << sha1 << ", software " << sha1Software << ", SHA-256 " << sha256 << ", software " << sha256Software;
+    
+    ArrayView<const Byte> message[8];
+    SHA256::Type digest[8];
+    for(std::size_t i = 0; i < 8; ++i) message[i] = toView(sha[i % 2].message);
+    SHA256::hash(message, digest);
+    bool x8 = true;
+    for(std::size_t i = 0; i < 8; ++i) x8 &= toHex(digest[i]) == sha[i % 2].sha256;
+    std::cout << ", x8 " << x8;
+#if defined(CORECAT_ARCHITECTURE_X86) || defined(CORECAT_ARCHITECTURE_X86_64)
+    if(X86Feature::AVX2) {
+        
+        Data::Impl::hashSHA256x8AVX2(message, digest);
+        bool avx2 = true;
+        for(std::size_t i = 0; i < 8; ++i) avx2 &= toHex(digest[i]) == sha[i % 2].sha256;
+        std::cout << ", AVX2 " << avx2;
+        
+    }
+#endif
+    
+    // From the official test_vectors.json, whose input is the bytes 0, 1, ..., 250, 0, 1, ...; the longer ones span
+    // several chunks and go through the parent nodes, the eight-chunk AVX2 path and the pool
+    struct { std::size_t length; std::string blake3; } vectors[] = {
+        {0, "af1349b9f5f9a1a6a0404dea36dcc9499bcb25c9adc112b7cc9a93cae41f3262"},
+        {1024, "42214739f095a406f3fc83deb889744ac00df831c10daa55189b5d121c855af7"},
+        {1025, "d00278ae47eb27b34faecf67b4fe263f82d5412916c1ffd97c8cb7fb814b8444"},
+        {2048, "e776b6028c7cd22a4d0ba182a8bf62205d2ef576467e838ed6f2529b85fba24a"},
+        {31744, "62b6960e1a44bcc1eb1a611a8d6235b6b4b78f32e7abc4fb4c6cdcce94895c47"},
+        {102400, "bc3e3d41a1146b069abffad3c0d44860cf664390afce4d9661f7902e7943e085"},
+    };
+    ThreadPoolExecutor pool(4);
+    bool blake3 = true, blake3Stream = true;
+    for(auto& x : vectors) {
+        
+        std::vector<Byte> input(x.length);
+        for(std::size_t i = 0; i < x.length; ++i) input[i] = Byte(i % 251);
+        blake3 &= toHex(BLAKE3::hash({input.data(), input.size()})) == x.blake3;
+        blake3 &= toHex(BLAKE3::hash({input.data(), input.size()}, &pool)) == x.blake3;
+        BLAKE3 b;
+        for(std::size_t i = 0; i < x.length; i += 1000) b.update({input.data() + i, std::min<std::size_t>(x.length - i, 1000)});
+        blake3Stream &= toHex(b.finish()) == x.blake3;
+        
+    }
+    std::cout << ", BLAKE3 " << blake3 << ", streamed " << blake3Stream << std::endl;
+        
+}
+
+int main() {
+    
+    std::vector<Byte> data(1048576);
+    for(std::size_t i = 0; i < data.size(); ++i) data[i] = Byte(i * 131 + (i >> 8));
+    
+    std::cout << std::boolalpha;
+    checkKnownAnswers();
+    std::cout << "Reset: CRC32C " << checkReset<CRC32C>(data) << ", SHA-256 " << checkReset<SHA256>(data)
+        << ", SHA-1 " << checkReset<SHA1>(data) << ", BLAKE3 " << checkReset<BLAKE3>(data) << std::endl;
+    
+    std::uint32_t sink = 0;
+    for(std::size_t size : {64, 4096, 65536, 1048576}) {
+        
+        auto p = reinterpret_cast<const unsigned char*>(data.data());
+        CRC32C crc;
+        std::cout << "CRC32C " << size << " B: "
+            << measure(size, [&] { crc.update({data.data(), size}); sink ^= crc.finish(); }) << " GB/s, software "
+            << measure(size, [&] { sink ^= Data::Impl::updateCRC32CSoftware(sink, p, size); }) << " GB/s" << std::endl;
+            
+    }
+    for(std::size_t size : {64, 4096, 1048576}) {
+        
+        auto p = reinterpret_cast<const unsigned char*>(data.data());
+        std::uint32_t state[8] = {};
+        SHA256 sha256;
+        SHA1 sha1;
+        std::cout << "SHA-256 " << size << " B: "
+            << measure(size, [&] { sha256.update({data.data(), size}); sink ^= std::uint32_t(sha256.finish()[0]); }) << " GB/s, software "
+            << measure(size, [&] { Data::Impl::transformSHA256Software(state, p, size / 64); }) << " GB/s" << std::endl;
+        std::cout << "SHA-1 " << size << " B: "
+            << measure(size, [&] { sha1.update({data.data(), size}); sink ^= std::uint32_t(sha1.finish()[0]); }) << " GB/s, software "
+            << measure(size, [&] { Data::Impl::transformSHA1Software(state, p, size / 64); }) << " GB/s" << std::endl;
+            
+        ArrayView<const Byte> message[8];
+        SHA256::Type digest[8];
+        for(std::size_t i = 0; i < 8; ++i) message[i] = {data.data(), size};
+        std::cout << "SHA-256 x8 " << size << " B: "
+            << measure(size * 8, [&] { SHA256::hash(message, digest); sink ^= std::uint32_t(digest[7][0]); }) << " GB/s";
+#if defined(CORECAT_ARCHITECTURE_X86) || defined(CORECAT_ARCHITECTURE_X86_64)
+        if(X86Feature::AVX2) std::cout << ", AVX2 " << measure(size * 8, [&] { Data::Impl::hashSHA256x8AVX2(message, digest); }) << " GB/s";
+#endif
+        std::cout << std::endl;
+        sink ^= state[0];
+        
+    }
+    for(std::size_t size : {64, 4096, 1048576}) {
+        
+        auto p = reinterpret_cast<const unsigned char*>(data.data());
+        BLAKE3 blake3;
+        std::cout << "BLAKE3 " << size << " B: "
+            << measure(size, [&] { blake3.update({data.data(), size}); sink ^= std::uint32_t(blake3.finish()[0]); }) << " GB/s, one chunk at a time "
+            << measure(size, [&] { for(std::size_t i = 0; i < size; i += 1024) sink ^= Data::Impl::hashChunkBLAKE3(p + i, std::min<std::size_t>(size - i, 1024), i)[0]; }) << " GB/s" << std::endl;
+            
+    }
+    // The tree mode lets hash() scale with the pool size on large inputs
+    std::vector<Byte> large(16 * data.size());
+    for(std::size_t i = 0; i < large.size(); ++i) large[i] = data[i % data.size()] ^ Byte(i >> 20);
+    for(std::size_t threads : {std::size_t(1), std::size_t(2), std::size_t(4), std::size_t(std::thread::hardware_concurrency())}) {
+        
+        ThreadPoolExecutor pool(threads);
+        std::cout << "BLAKE3 " << large.size() << " B with " << threads << " threads: "
+            << measure(large.size(), [&] { sink ^= std::uint32_t(BLAKE3::hash({large.data(), large.size()}, &pool)[0]); }) << " GB/s" << std::endl;
+            
+    }
+    {
+        
+        // A hash started on the only pool thread runs its subtrees itself instead of waiting for a free thread
+        ThreadPoolExecutor pool(1);
+        std::promise<BLAKE3::Type> result;
+        auto future = result.get_future();
+        pool.execute([&] { result.set_value(BLAKE3::hash({large.data(), large.size()}, &pool)); });
+        std::cout << "BLAKE3 from a pool thread: " << (future.get() == BLAKE3::hash({large.data(), large.size()})) << std::endl;
+        
+    }
+    {
+        
+        const char* path = "Digest.tmp";
+        std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(large.data()), large.size());
+        {
+            
+            MappedDataView<Byte> file(path);
+            ArrayView<const Byte> view(file.getData(), std::size_t(file.getSize()));
+            bool match = BLAKE3::hash(view) == BLAKE3::hash({large.data(), large.size()});
+            std::cout << "BLAKE3 mapped file: " << measure(large.size(), [&] { sink ^= std::uint32_t(BLAKE3::hash(view)[0]); }) << " GB/s, "
+                << (match ? "matches" : "differs from") << " the in-memory hash" << std::endl;
+                
+        }
+        std::remove(path);
+        
+    }
+    // Hashing on the pool overlaps the copy into the stream
+    ThreadPoolExecutor executor;
+    NullOutputStream null;
+    auto buffer = reinterpret_cast<const char*>(data.data());
+    for(auto e : {static_cast<ThreadPoolExecutor*>(nullptr), &executor}) {
+        
+        auto os = createDigestOutputStream<SHA256>(null, e);
+        std::cout << "DigestOutputStream<SHA256>" << (e ? " with executor: " : ": ")
+            << measure(data.size(), [&] { for(std::size_t i = 0; i < data.size(); i += 4096) os.write(buffer + i, 4096); }) << " GB/s" << std::endl;
+        sink ^= std::uint32_t(os.finish()[0]);
+        
+    }
+    {
+        
+        // Chunks that the only pool thread cannot get to are hashed by the writer itself
+        ThreadPoolExecutor pool(1);
+        std::promise<SHA256::Type> result;
+        auto future = result.get_future();
+        pool.execute([&] {
+            
+            auto os = createDigestOutputStream<SHA256>(null, &pool);
+            os.writeAll(buffer, data.size());
+            result.set_value(os.finish());
+            
+        });
+        SHA256 sha256;
+        sha256.update({data.data(), data.size()});
+        std::cout << "DigestOutputStream<SHA256> from a pool thread: " << (future.get() == sha256.finish()) << std::endl;
+        
+    }
+    std::cout << "Checksum: " << sink << std::endl;
+    
+    return 0;
+    
+}
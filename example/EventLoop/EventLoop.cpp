@@ -0,0 +1,138 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2016-2018 The Cats Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include "Cats/Corecat/Concurrent/EventLoop.hpp"
+#include "Cats/Corecat/Data/Stream/FdInputStream.hpp"
+#include "Cats/Corecat/Data/Stream/FdOutputStream.hpp"
+#include "Cats/Corecat/System/Pipe.hpp"
+#include "Cats/Corecat/System/Process.hpp"
+
+
+using namespace Cats::Corecat;
+
+
+// Writes a message into one end, then reads until the whole message came back out of the other
+struct Connection {
+    
+    FdOutputStream output;
+    FdInputStream input;
+    char message[64] = "The quick brown fox jumps over the lazy dog";
+    char buffer[64] = {};
+    std::size_t sent = 0;
+    std::size_t received = 0;
+    std::size_t length = sizeof(message);
+    
+    Connection(int output_, int input_) : output(output_), input(input_) {}
+    
+    void send(EventLoop& loop) {
+        
+        output.writeAsync(loop, message + sent, length - sent).then([this, &loop](std::size_t n) {
+            
+            sent += n;
+            if(sent < length) send(loop);
+            else loop.remove(output.getFd()), output.close();
+            
+        });
+        
+    }
+    void receive(EventLoop& loop, std::size_t& done) {
+        
+        input.readAsync(loop, buffer + received, sizeof(buffer) - received).then([this, &loop, &done](std::size_t n) {
+            
+            received += n;
+            if(n) receive(loop, done);
+            else if(received == length && std::equal(buffer, buffer + length, message)) ++done;
+            
+        });
+        
+    }
+    
+};
+
+int main() {
+    
+    try {
+        
+        // Every socket pair costs two descriptors
+        rlimit limit;
+        ::getrlimit(RLIMIT_NOFILE, &limit);
+        limit.rlim_cur = limit.rlim_max;
+        ::setrlimit(RLIMIT_NOFILE, &limit);
+        ::getrlimit(RLIMIT_NOFILE, &limit);
+        std::size_t socketCount = std::min<std::size_t>(4000, (limit.rlim_cur - 64) / 2);
+        constexpr std::size_t PROCESS_COUNT = 16;
+        
+        EventLoop loop;
+        std::vector<std::unique_ptr<Connection>> connection;
+        std::vector<std::unique_ptr<Process>> process;
+        
+        for(std::size_t i = 0; i < socketCount; ++i) {
+            
+            int fd[2];
+            createSocketPair(fd, true);
+            connection.emplace_back(new Connection(fd[0], fd[1]));
+            
+        }
+        
+        // Each child is cat: what goes into its stdin comes back out of its stdout
+        for(std::size_t i = 0; i < PROCESS_COUNT; ++i) {
+            
+            int input[2], output[2];
+            createPipe(input);
+            createPipe(output);
+            ProcessOption option("cat");
+            const char* argument[] = {"cat", nullptr};
+            option.argument = argument;
+            option.input = input[0], option.output = output[1];
+            process.emplace_back(new Process(option));
+            ::close(input[0]), ::close(output[1]);
+            setNonBlocking(input[1]), setNonBlocking(output[0]);
+            connection.emplace_back(new Connection(input[1], output[0]));
+            
+        }
+        
+        std::size_t done = 0;
+        for(auto&& x : connection) x->receive(loop, done), x->send(loop);
+        std::size_t batch = 0;
+        while(loop.getPending()) loop.poll(), ++batch;
+        for(auto&& x : process) x->wait();
+        
+        std::cout << "Socket pairs: " << socketCount << std::endl;
+        std::cout << "Processes: " << PROCESS_COUNT << std::endl;
+        std::cout << "Completed: " << done << " / " << connection.size() << std::endl;
+        std::cout << "Batches: " << batch << std::endl;
+        
+    } catch(std::exception& e) { std::cerr << e.what() << std::endl; return 1; }
+    
+    return 0;
+    
+}
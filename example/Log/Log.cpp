@@ -0,0 +1,143 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2016-2018 The Cats Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <cstdio>
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+#include "Cats/Corecat/Log.hpp"
+
+
+using namespace Cats::Corecat;
+
+
+class StdoutOutputStream : public OutputStream<char> {
+    
+public:
+    
+    std::size_t write(const char* buffer, std::size_t count) override { std::cout.write(buffer, count); return count; }
+    void flush() override { std::cout.flush(); }
+    
+};
+
+// Discards what is written, keeping only the count
+class CountOutputStream : public OutputStream<char> {
+    
+public:
+    
+    std::size_t size = 0;
+    
+    std::size_t write(const char*, std::size_t count) override { size += count; return count; }
+    void flush() override {}
+    
+};
+
+template <typename F>
+double measure(std::size_t count, F&& f) {
+    
+    using Clock = std::chrono::steady_clock;
+    auto startTime = Clock::now();
+    f();
+    return std::chrono::duration<double, std::nano>(Clock::now() - startTime).count() / count;
+    
+}
+
+int main() {
+    
+    {
+        StdoutOutputStream output;
+        Logger logger(output, LogLevel::LOG_DEBUG);
+        CORECAT_LOG(logger, LogLevel::LOG_INFO, "Listening on {}:{}", "0.0.0.0", 8080);
+        CORECAT_LOG(logger, LogLevel::LOG_DEBUG, "Request {} took {:.3f} ms", 42, 1.5);
+        CORECAT_LOG(logger, LogLevel::LOG_TRACE, "Not written, and {} is not evaluated", std::printf("side effect\n"));
+        logger.setLevel(LogLevel::LOG_WARNING);
+        CORECAT_LOG(logger, LogLevel::LOG_INFO, "Filtered out");
+        CORECAT_LOG(logger, LogLevel::LOG_ERROR, "Disk {} is {}% full", "/dev/sda1", 97);
+        logger.flush();
+    }
+    std::cout << std::endl;
+    
+    // flush() returns while another thread keeps logging
+    {
+        CountOutputStream output;
+        Logger logger(output);
+        std::atomic<bool> stop = {false};
+        std::thread producer([&] { while(!stop) CORECAT_LOG(logger, LogLevel::LOG_INFO, "Busy {}", 0); });
+        for(int i = 0; i < 100; ++i) logger.flush();
+        stop = true;
+        producer.join();
+        std::cout << "Flush under load: done" << std::endl;
+    }
+    
+    // Records are timed in bursts that fit in the ring, so that the cost of log() is measured apart from the logger
+    // thread, which then catches up during flush()
+    constexpr std::size_t BURST = 65536, ROUND = 16;
+    CountOutputStream output;
+    Logger logger(output, LogLevel::LOG_INFO, 16777216);
+    double enqueue = 0, filtered = 0, total = 0;
+    String8 user = "alice";
+    for(std::size_t round = 0; round < ROUND; ++round) {
+        
+        total += measure(BURST, [&] {
+            
+            enqueue += measure(BURST, [&] {
+                
+                for(std::size_t i = 0; i < BURST; ++i) CORECAT_LOG(logger, LogLevel::LOG_INFO, "Request {} from {} took {:.3f} ms", i, user, 0.25);
+                
+            });
+            logger.flush();
+            
+        });
+        filtered += measure(BURST, [&] {
+            
+            for(std::size_t i = 0; i < BURST; ++i) CORECAT_LOG(logger, LogLevel::LOG_DEBUG, "Request {} from {} took {:.3f} ms", i, user, 0.25);
+            
+        });
+        
+    }
+    std::cout << "Logger: log() " << enqueue / ROUND << " ns, filtered out " << filtered / ROUND << " ns, with formatting and writing "
+        << total / ROUND << " ns per record" << std::endl;
+        
+    // Formatting every line in place and writing it out, as a synchronous logger does
+    CountOutputStream direct;
+    std::cout << "Synchronous: " << measure(BURST, [&] {
+        
+        for(std::size_t i = 0; i < BURST; ++i) {
+            
+            CORECAT_FORMAT("[INFO] Request {} from {} took {:.3f} ms\n").formatTo(direct, i, user, 0.25);
+            direct.flush();
+            
+        }
+        
+    }) << " ns per record" << std::endl;
+    std::cout << "Checksum: " << output.size + direct.size << std::endl;
+    
+    return 0;
+    
+}
@@ -0,0 +1,221 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2016-2018 The Cats Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <cstdint>
+#include <cstring>
+
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include "Cats/Corecat/Data/DataView.hpp"
+#include "Cats/Corecat/Data/Stream.hpp"
+#include "Cats/Corecat/Util/Endian.hpp"
+
+
+using namespace Cats::Corecat;
+
+
+class VectorOutputStream : public OutputStream<char> {
+    
+public:
+    
+    std::vector<char> data;
+    
+public:
+    
+    std::size_t write(const char* buffer, std::size_t count) override { data.insert(data.end(), buffer, buffer + count); return count; }
+    void flush() override {}
+    
+};
+
+template <typename F>
+double measure(std::size_t size, F&& f) {
+    
+    auto startTime = std::chrono::high_resolution_clock::now();
+    f();
+    auto endTime = std::chrono::high_resolution_clock::now();
+    return size / std::chrono::duration<double>(endTime - startTime).count() / 1e9;
+    
+}
+
+// Whether values written by BinaryWriter come back from BinaryReader, through buffers small enough to split them
+bool checkBinary() {
+    
+    const std::uint64_t varint[] = {0, 1, 127, 128, 300, 16383, 16384, (std::uint64_t(1) << 56) - 1, std::uint64_t(1) << 56,
+        std::uint64_t(1) << 63, std::numeric_limits<std::uint64_t>::max()};
+    const std::int64_t zigZag[] = {0, -1, 1, -64, 64, std::numeric_limits<std::int64_t>::min(), std::numeric_limits<std::int64_t>::max()};
+    std::vector<char> longData(1000, 'x');
+    String8 longString(longData.data(), longData.size());
+    
+    VectorOutputStream os;
+    {
+        BinaryWriter<Endian::BIG> writer(os, 16);
+        for(int i = 0; i < 3; ++i) {
+            
+            writer.put<std::uint32_t>(0x01020304);
+            writer.put<std::uint32_t, Endian::LITTLE>(0x01020304);
+            writer.put<std::int16_t>(-2);
+            writer.put<float>(1.5f);
+            writer.put<double>(-0.1);
+            for(auto x : varint) writer.putVarint(x);
+            for(auto x : zigZag) writer.putZigZag(x);
+            writer.putString("");
+            writer.putString("Corecat");
+            writer.putString(longString);
+            
+        }
+    }
+    // 0x01020304 in big and little endian and -2 in big endian, then after the floats and 5 bytes of varints, 300 as AC 02
+    static const unsigned char PREFIX[] = {1, 2, 3, 4, 4, 3, 2, 1, 0xFF, 0xFE};
+    if(os.data.size() < 29 || std::memcmp(os.data.data(), PREFIX, sizeof(PREFIX))) return false;
+    if(std::uint8_t(os.data[27]) != 0xAC || os.data[28] != 0x02) return false;
+    
+    MemoryDataView<char> dv(os.data.data(), os.data.size());
+    auto is = createDataViewInputStream(dv);
+    BinaryReader<Endian::BIG> reader(is, 16);
+    for(int i = 0; i < 3; ++i) {
+        
+        if(reader.get<std::uint32_t>() != 0x01020304 || reader.get<std::uint32_t, Endian::LITTLE>() != 0x01020304) return false;
+        if(reader.get<std::int16_t>() != -2 || reader.get<float>() != 1.5f || reader.get<double>() != -0.1) return false;
+        for(auto x : varint) if(reader.getVarint() != x) return false;
+        for(auto x : zigZag) if(reader.getZigZag() != x) return false;
+        if(reader.getString() != "" || reader.getString() != "Corecat" || reader.getString() != longString) return false;
+        
+    }
+    return true;
+    
+}
+
+// Whether a 10-byte varint whose last byte carries more than the top bit is rejected
+bool checkVarintOverflow() {
+    
+    char valid[] = "\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\x01", invalid[] = "\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\x02";
+    MemoryDataView<char> dv1(valid, 10), dv2(invalid, 10);
+    auto is1 = createDataViewInputStream(dv1), is2 = createDataViewInputStream(dv2);
+    if(createBinaryReader(is1).getVarint() != std::numeric_limits<std::uint64_t>::max()) return false;
+    try { createBinaryReader(is2).getVarint(); } catch(IOException&) { return true; }
+    return false;
+    
+}
+
+// Whether a string claiming 2^64 - 1 bytes ends in an IOException instead of a huge allocation
+bool checkStringLength() {
+    
+    char bogus[] = "\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\x01" "abc";
+    MemoryDataView<char> dv(bogus, 13);
+    auto is = createDataViewInputStream(dv);
+    try { createBinaryReader(is).getString(); } catch(IOException&) { return true; }
+    return false;
+    
+}
+
+// Whether the bulk reverseEndian agrees with the scalar one for every count up to 100
+template <typename T>
+bool checkReverse(const std::vector<std::uint8_t>& bytes) {
+    
+    std::vector<T> v(100);
+    std::memcpy(v.data(), bytes.data(), v.size() * sizeof(T));
+    for(std::size_t count = 0; count <= v.size(); ++count) {
+        
+        std::vector<T> a(v.begin(), v.begin() + count), b = a;
+        reverseEndian(a.data(), count);
+        for(auto&& x : b) x = reverseEndian(x);
+        if(a != b) return false;
+        
+    }
+    return true;
+    
+}
+
+int main() {
+    
+    try {
+        
+        std::vector<std::uint8_t> bytes(65536);
+        std::uint32_t seed = 1;
+        for(auto&& x : bytes) seed = seed * 1103515245 + 12345, x = std::uint8_t(seed >> 16);
+        
+        std::cout << std::boolalpha << "reverseEndian: "
+            << checkReverse<std::uint16_t>(bytes) << " " << checkReverse<std::uint32_t>(bytes) << " " << checkReverse<std::uint64_t>(bytes) << std::endl;
+            
+        // Big-endian 16-bit values read through 64-bit units, in odd-sized reads and skips, at odd buffer offsets
+        std::vector<std::uint64_t> units(bytes.size() / 8);
+        std::memcpy(units.data(), bytes.data(), bytes.size());
+        MemoryDataView<std::uint64_t> dv(units.data(), units.size());
+        auto dvis = createDataViewInputStream(dv);
+        auto is = createCastInputStream<std::uint16_t, std::uint64_t, Endian::BIG>(dvis);
+        std::vector<std::uint16_t> buffer(1024);
+        std::size_t offset = 0, step = 0;
+        bool match = true;
+        while(offset < bytes.size() / 2) {
+            
+            std::size_t count = ++step % 7 * 97 % 513;
+            if(step % 3 == 0) { is.skip(count), offset += count; continue; }
+            std::size_t x = is.read(buffer.data() + step % 2, count);
+            for(std::size_t i = 0; i < x; ++i)
+                match &= buffer[step % 2 + i] == (bytes[(offset + i) * 2] << 8 | bytes[(offset + i) * 2 + 1]);
+            offset += x;
+            if(!x && count) break;
+            
+        }
+        std::cout << "CastInputStream: " << (match && offset >= bytes.size() / 2) << std::endl;
+        
+        std::cout << "BinaryWriter and BinaryReader: " << checkBinary() << ", varint overflow rejected: " << checkVarintOverflow()
+            << ", bogus string length rejected: " << checkStringLength() << std::endl;
+        
+        // Varints of mixed lengths, as in a typical message
+        std::vector<std::uint64_t> value(1048576);
+        for(auto&& x : value) seed = seed * 1103515245 + 12345, x = std::uint64_t(seed >> 8) >> (seed % 24);
+        VectorOutputStream varintOutput;
+        double putSpeed = measure(value.size(), [&] {
+            
+            auto writer = createBinaryWriter(varintOutput);
+            for(auto x : value) writer.putVarint(x);
+            
+        });
+        MemoryDataView<char> varintView(varintOutput.data.data(), varintOutput.data.size());
+        std::uint64_t sum = 0;
+        double getSpeed = measure(value.size(), [&] {
+            
+            auto varintInput = createDataViewInputStream(varintView);
+            auto reader = createBinaryReader(varintInput);
+            for(std::size_t i = 0; i < value.size(); ++i) sum += reader.getVarint();
+            
+        });
+        std::cout << "Varint: put " << putSpeed * 1000 << " M/s, get " << getSpeed * 1000 << " M/s (checksum " << sum << ")" << std::endl;
+        
+        std::vector<std::uint32_t> data(16777216);
+        std::memcpy(data.data(), bytes.data(), bytes.size());
+        double speed = measure(data.size() * 4, [&] { for(int i = 0; i < 16; ++i) convertEndian<Endian::BIG, Endian::LITTLE>(data.data(), data.size()); }) * 16;
+        std::cout << "convertEndian: " << speed << " GB/s" << std::endl;
+        
+    } catch(std::exception& e) { std::cerr << e.what() << std::endl; return 1; }
+    
+    return 0;
+    
+}
@@ -24,14 +24,50 @@
  *
  */
 
+#include <cstdint>
+
 #include <iostream>
+#include <limits>
+#include <string>
 
 #include "Cats/Corecat/Text.hpp"
+#include "Cats/Corecat/Util/Range.hpp"
 
 
 using namespace Cats::Corecat;
 
 
+// A byte count written with a binary unit; the precision gives the fraction digits
+struct ByteSize { std::uint64_t value; };
+
+namespace Cats {
+namespace Corecat {
+
+template <>
+struct FormatTraits<ByteSize> {
+    
+    template <typename C>
+    static constexpr bool check(const FormatSpec<C>& spec) noexcept { return !spec.type && !spec.width; }
+    template <typename W>
+    static void format(W& writer, const ByteSize& size, const FormatSpec<typename W::CharsetType::CharType>& spec) {
+        
+        static const char* const UNIT[] = {" B", " KiB", " MiB", " GiB", " TiB"};
+        double value = double(size.value);
+        std::size_t unit = 0;
+        for(; value >= 1024 && unit < 4; ++unit) value /= 1024;
+        FormatSpec<typename W::CharsetType::CharType> number;
+        number.type = 'f', number.precision = spec.precision < 0 ? 1 : spec.precision;
+        formatString(writer, value, number);
+        writer.append(UNIT[unit], std::char_traits<char>::length(UNIT[unit]));
+        
+    }
+    
+};
+
+}
+}
+
+
 #define PRINT(x) do { std::cout << #x << "\n    -> " << (x) << std::endl; } while(0)
 
 int main() {
@@ -56,7 +92,23 @@ int main() {
     
     PRINT(str1.find("567")); // 5
     PRINT(str1.find("567", 6)); // -1
+    PRINT(str1.rfind('5')); // 5
+    PRINT(str1.rfind("567", 7)); // -1
+    PRINT(str1.findAnyOf("975")); // 5
+    std::cout << std::endl;
+    
+    for(auto&& x : "a,b,,c"_sv | split(',')) std::cout << '[' << x << ']'; // [a][b][][c]
+    std::cout << std::endl;
+    for(auto&& x : "a::b"_sv | split("::"_sv)) std::cout << '[' << x << ']'; // [a][b]
+    std::cout << std::endl;
+    for(auto&& x : "a::b"_sv | split(""_sv)) std::cout << '[' << x << ']'; // [a::b]
     std::cout << std::endl;
+    for(auto&& x : "a, b;c"_sv | splitAny(",; ") | filter([](StringView8 sv) { return !sv.isEmpty(); })) std::cout << '[' << x << ']'; // [a][b][c]
+    std::cout << std::endl;
+    for(auto&& x : "one\r\ntwo\n"_sv | lines()) std::cout << '[' << x << ']'; // [one][two]
+    std::cout << std::endl;
+    for(auto&& x : "  one  two "_sv | tokenize([](char c) { return c == ' '; })) std::cout << '[' << x << ']'; // [one][two]
+    std::cout << std::endl << std::endl;
     
     PRINT(str1.repeat(2)); // "01234567890123456789"
     PRINT(str1 * 2); // "01234567890123456789"
@@ -75,12 +127,62 @@ int main() {
     
     PRINT("{}, {}!"_format("Hello", "world")); // Hello, world!
     PRINT("{2}, {1}, {0}"_format("A", "B", "C")); // C, B, A
+    PRINT(CORECAT_FORMAT("{}, {}!")("Hello", "world")); // Hello, world!
+    PRINT("{}, {}!"_format.formattedSize("Hello", "world")); // 13
     std::cout << std::endl;
     
     PRINT("{0:_<5} | {0:_^5} | {0:_>5}"_format(123)); // 123__ | _123_ | __123
     PRINT("{0:_>+5} | {0:_>-5} | {0:_> 5}"_format(123)); // _+123 | __123 |  _ 123
     PRINT("{0:b}, {0:o}, {0:d}, {0:x}, {0:X}, {0:c}"_format(90)); // 1011010, 132, 90, 5a, 5A, Z
     PRINT("{0:#b}, {0:#o}, {0:#d}, {0:#x}, {0:#X}"_format(90)); // 0b1011010, 0o132, 90, 0x5a, 0x5A
+    PRINT("{0}, {0:.3f}, {0:.2e}, {0:g}, {1:.1%}"_format(0.1 + 0.2, 0.125)); // 0.30000000000000004, 0.300, 3.00e-01, 0.3, 12.5%
+    PRINT("{:.3e}"_format(std::numeric_limits<double>::denorm_min())); // 4.941e-324
+    PRINT("{0:e}, {0:+E}, {1:e}"_format(1.0, 123456789.0)); // 1.000000e+00, +1.000000E+00, 1.234568e+08
+    PRINT(CORECAT_FORMAT("{}, {:.3}")(ByteSize{1536}, ByteSize{5368709120})); // 1.5 KiB, 5.000 GiB
+    PRINT("{{\"msg\":\"{:j}\"}}"_format("say \"hi\"\n")); // {"msg":"say \"hi\"\n"}
+    std::cout << std::endl;
+    
+    PRINT(parseInteger<int>("-12345"_sv).value); // -12345
+    PRINT(parseInteger<std::uint32_t>("ff"_sv, 16).value); // 255
+    PRINT(parseInteger<std::int8_t>("300"_sv).error == ParseError::OUT_OF_RANGE); // true
+    PRINT(parseFloat<double>("2.5e-3"_sv).value); // 0.0025
+    PRINT(bool(parseFloat<double>("1.5x"_sv))); // false
+    std::cout << std::endl;
+    
+    // Enough fragments to fill the first 256-byte segment and several doubled ones after it
+    auto build = [](StringBuilder8& builder, String8& expected, int count) {
+        
+        for(int i = 0; i < count; ++i) {
+            
+            auto fragment = "fragment {}, "_format(i);
+            builder << fragment, expected += fragment;
+            
+        }
+        
+    };
+    StringBuilder8 builder;
+    String8 expected;
+    build(builder, expected, 400);
+    PRINT(builder.getLength()); // 5490
+    PRINT(builder.toString() == expected); // true
+    StringBuilder8 moved(std::move(builder));
+    PRINT(moved.toString() == expected && builder.isEmpty()); // true
+    moved.clear(), expected.clear();
+    build(moved, expected, 50);
+    PRINT(moved.toString() == expected); // true
+    builder << "reused";
+    PRINT(builder.toString()); // reused
+    builder = std::move(moved);
+    PRINT(builder.toString() == expected && moved.isEmpty()); // true
+    std::cout << std::endl;
+    
+    auto key = SharedString8::intern("key"_sv);
+    SharedString8 plain("key");
+    PRINT(SharedString8::intern("key"_sv).getData() == key.getData()); // true
+    PRINT(plain.intern().getData() == key.getData()); // true
+    PRINT(plain.getData() == key.getData()); // false
+    PRINT(plain == key && key == plain); // true
+    PRINT(SharedString8::intern("kez"_sv) == key); // false
     
     return 0;
     
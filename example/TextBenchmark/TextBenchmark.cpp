@@ -0,0 +1,437 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2016-2018 The Cats Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Cats/Corecat/Text.hpp"
+#include "Cats/Corecat/Util/Range.hpp"
+
+
+using namespace Cats::Corecat;
+
+
+// Runs f repeatedly for about 0.2 s and returns GB/s over size bytes
+template <typename F>
+double measure(std::size_t size, F&& f) {
+    
+    using Clock = std::chrono::high_resolution_clock;
+    std::size_t count = 0;
+    auto startTime = Clock::now(), endTime = startTime;
+    do {
+        
+        for(std::size_t i = 0; i < 16; ++i) f();
+        count += 16;
+        endTime = Clock::now();
+        
+    } while(endTime - startTime < std::chrono::milliseconds(200));
+    return double(size) * count / std::chrono::duration<double>(endTime - startTime).count() / 1e9;
+    
+}
+
+// Discards what is written, keeping only the count
+class CountOutputStream : public OutputStream<char> {
+    
+public:
+    
+    std::size_t size = 0;
+    
+    std::size_t write(const char*, std::size_t count) override { size += count; return count; }
+    void flush() override {}
+    
+};
+
+// toString of T in M/s for each decimal length T can have; signed types get random signs
+template <typename T>
+void measureInteger(const char* name, std::size_t& sink) {
+    
+    std::mt19937_64 random(42);
+    std::vector<T> values(1024);
+    std::uint64_t max = std::uint64_t(std::numeric_limits<T>::max());
+    std::cout << "Integer " << name << ":";
+    for(std::uint64_t low = 1, length = 1; ; low *= 10, ++length) {
+        
+        std::uint64_t high = low > max / 10 ? max : low * 10 - 1;
+        for(auto& x : values) {
+            
+            x = T(length == 1 ? random() % 10 : low + random() % (high - low + 1));
+            if(std::is_signed<T>::value && random() % 2) x = T(0) - x;
+            
+        }
+        std::cout << ' ' << length << ": " << measure(values.size(), [&] {
+            
+            for(auto x : values) sink += toString8(x).getLength();
+            
+        }) * 1e3;
+        if(high == max) break;
+        
+    }
+    std::cout << " M/s" << std::endl;
+    
+}
+
+int main() {
+    
+    std::size_t sink = 0;
+    
+    // Transcoding
+    std::string ascii, mixed;
+    while(ascii.size() < 1048576) ascii += "The quick brown fox jumps over the lazy dog. ";
+    while(mixed.size() < 1048576) mixed += "Gr\xC3\xBC\xC3\x9F Gott, \xD0\x9F\xD1\x80\xD0\xB8\xD0\xB2\xD0\xB5\xD1\x82, \xE4\xBD\xA0\xE5\xA5\xBD, \xF0\x9F\x98\x80! ";
+    for(auto text : {&ascii, &mixed}) {
+        
+        const char* name = text == &ascii ? "ASCII" : "mixed";
+        String8 s8(text->data(), text->size());
+        String16 s16(s8);
+        String32 s32(s8);
+        std::cout << "UTF-8 validate (" << name << "): "
+            << measure(s8.getLength(), [&] { sink += UTF8Charset<>::validate(s8.begin(), s8.end()) - s8.begin(); }) << " GB/s" << std::endl;
+        std::cout << "String16(String8) (" << name << "): "
+            << measure(s8.getLength(), [&] { sink += String16(s8).getLength(); }) << " GB/s" << std::endl;
+        std::cout << "String32(String8) (" << name << "): "
+            << measure(s8.getLength(), [&] { sink += String32(s8).getLength(); }) << " GB/s" << std::endl;
+        std::cout << "String8(String16) (" << name << "): "
+            << measure(s8.getLength(), [&] { sink += String8(s16).getLength(); }) << " GB/s" << std::endl;
+        std::cout << "String8(String32) (" << name << "): "
+            << measure(s8.getLength(), [&] { sink += String8(s32).getLength(); }) << " GB/s" << std::endl;
+        // The code point loop that the kernels replace, for comparison
+        std::cout << "Code point loop (" << name << "): " << measure(s8.getLength(), [&] {
+            
+            String16 t;
+            t.reserve(s8.getLength());
+            const char* p = s8.begin();
+            while(p != s8.end()) {
+                
+                char16_t buf[UTF16Charset<>::MAX_CODE_UNIT], *q = buf;
+                UTF16Charset<>::encode(q, std::end(buf), UTF8Charset<>::decode(p, s8.end()));
+                t.append(buf, q - buf);
+                
+            }
+            sink += t.getLength();
+            
+        }) << " GB/s" << std::endl;
+        
+    }
+    
+    // Searching a log buffer; std::string::find is the same algorithm as std::string_view::find, which needs C++17
+    std::string log;
+    for(std::size_t i = 0; log.size() < 1048576; ++i)
+        log += "2024-01-01 12:00:00.000 INFO [worker-" + std::to_string(i % 16) + "] request " + std::to_string(i) + " completed in 12 ms\n";
+    log += "2024-01-01 12:00:00.000 ERROR [worker-3] connection reset by peer\n";
+    StringView8 view(log.data(), log.size());
+    // Read through a volatile so that repeated searches cannot be folded into one
+    volatile std::size_t zero = 0;
+    struct { const char* name; const char* needle; } searches[] = {{"find(char)", "#"}, {"find(short)", "reset"}, {"find(long)", "[worker-3] connection reset by peer"}};
+    for(auto& x : searches) {
+        
+        std::string needle(x.needle);
+        std::cout << x.name << ": " << measure(log.size(), [&] {
+            
+            sink += needle.size() == 1 ? view.find(needle[0], zero) : view.find(x.needle, zero);
+            
+        }) << " GB/s, std::string::find " << measure(log.size(), [&] {
+            
+            sink += needle.size() == 1 ? log.find(needle[0], zero) : log.find(needle, zero);
+            
+        }) << " GB/s" << std::endl;
+        
+    }
+    std::cout << "rfind(char): " << measure(log.size(), [&] { sink += view.rfind('#', log.size() - zero); }) << " GB/s, std::string::rfind "
+        << measure(log.size(), [&] { sink += log.rfind('#', log.size() - zero); }) << " GB/s" << std::endl;
+    std::cout << "findAnyOf: " << measure(log.size(), [&] { sink += view.findAnyOf("#$%", zero); }) << " GB/s, std::string::find_first_of "
+        << measure(log.size(), [&] { sink += log.find_first_of("#$%", zero); }) << " GB/s" << std::endl;
+        
+    // Comparison and terminator search
+    String16 wide1(String8(ascii.data(), ascii.size())), wide2(wide1);
+    std::cout << "String16 ==: " << measure(wide1.getLength() * 2, [&] { sink += wide1 == wide2; }) << " GB/s, compare "
+        << measure(wide1.getLength() * 2, [&] { sink += wide1 < wide2; }) << " GB/s, getLength "
+        << measure(wide1.getLength() * 2, [&] { sink += UTF16Charset<>::getLength(wide1.getData() + zero); }) << " GB/s" << std::endl;
+    std::vector<String8> keys;
+    for(std::size_t i = 0; i < 100000; ++i) keys.emplace_back(("service.http.request." + std::to_string(i * 7919 % 100000) + ".latency").c_str());
+    std::vector<StringView8> order(keys.begin(), keys.end());
+    std::cout << "Sort 100000 keys: " << measure(keys.size(), [&] {
+        
+        std::vector<StringView8> v(order);
+        std::sort(v.begin(), v.end());
+        sink += v[0].getLength();
+        
+    }) * 1e3 << " M keys/s" << std::endl;
+    
+    // Building a large response out of small fragments. Each round also pays for faulting in fresh pages for the 4 MiB
+    // result whenever the C library has returned the previous one to the system
+    std::vector<String8> fragments;
+    std::size_t total = 0;
+    for(std::size_t i = 0; total < 4194304; ++i) fragments.emplace_back(("{\"id\":" + std::to_string(i) + ",\"ok\":true},").c_str()), total += fragments.back().getLength();
+    std::cout << "StringBuilder: " << measure(total, [&] {
+        
+        StringBuilder8 builder;
+        for(auto&& x : fragments) builder << x;
+        sink += builder.toString().getLength();
+        
+    }) << " GB/s, String::append " << measure(total, [&] {
+        
+        String8 str;
+        for(auto&& x : fragments) str += x;
+        sink += str.getLength();
+        
+    }) << " GB/s, std::string::append " << measure(total, [&] {
+        
+        std::string str;
+        for(auto&& x : fragments) str.append(x.getData(), x.getLength());
+        sink += str.size();
+        
+    }) << " GB/s" << std::endl;
+    
+    // Summing the numeric column of a CSV file, against the find loop that copies every field into a String
+    std::string csv;
+    for(std::size_t i = 0; csv.size() < 1048576; ++i) csv += "2024-01-01,worker-" + std::to_string(i % 16) + ",GET,/api/v1/items," + std::to_string(i % 1000) + "\n";
+    StringView8 csvView(csv.data(), csv.size());
+    std::cout << "Split CSV: " << measure(csv.size(), [&] {
+        
+        for(auto&& line : csvView.slice(zero) | lines()) sink += (*(line | split(',') | skip(4)).begin())[0] - '0';
+        
+    }) << " GB/s, find and copy " << measure(csv.size(), [&] {
+        
+        for(std::size_t p = zero, q; p < csv.size(); p = q + 1) {
+            
+            q = csvView.find('\n', p);
+            std::vector<String8> fields;
+            for(std::size_t i = p, j; ; i = j + 1) {
+                
+                j = std::min<std::size_t>(csvView.find(',', i), q);
+                fields.emplace_back(csvView.slice(i, j));
+                if(j == q) break;
+                
+            }
+            sink += fields[4][0] - '0';
+            
+        }
+        
+    }) << " GB/s" << std::endl;
+    
+    // Copying and comparing long-lived keys. measure() reports units per nanosecond, scaled here to M operations/s
+    std::vector<SharedString8> shared(keys.begin(), keys.end()), interned;
+    for(auto&& x : keys) interned.push_back(SharedString8::intern(x));
+    std::cout << "Copy 100000 keys: SharedString " << measure(keys.size(), [&] {
+        
+        std::vector<SharedString8> v(shared);
+        sink += v[zero].getLength();
+        
+    }) * 1e3 << " M/s, String " << measure(keys.size(), [&] {
+        
+        std::vector<String8> v(keys);
+        sink += v[zero].getLength();
+        
+    }) * 1e3 << " M/s" << std::endl;
+    std::vector<SharedString8> probe, probeInterned;
+    for(std::size_t i = 0; i < keys.size(); ++i) probe.emplace_back(keys[i * 31 % keys.size()]), probeInterned.push_back(SharedString8::intern(probe.back()));
+    std::cout << "Compare 100000 keys: interned " << measure(keys.size(), [&] {
+        
+        for(std::size_t i = zero; i < keys.size(); ++i) sink += interned[i] == probeInterned[i];
+        
+    }) * 1e3 << " M/s, SharedString " << measure(keys.size(), [&] {
+        
+        for(std::size_t i = zero; i < keys.size(); ++i) sink += shared[i] == probe[i];
+        
+    }) * 1e3 << " M/s, String " << measure(keys.size(), [&] {
+        
+        for(std::size_t i = zero; i < keys.size(); ++i) sink += keys[i] == keys[i * 31 % keys.size()];
+        
+    }) * 1e3 << " M/s" << std::endl;
+    
+    // Formatting a log record; measure() counts one unit per record, scaled here to M records/s
+    Formatter8 formatter("[{:>8}] {} {:#x} {}"_sv);
+    String8 record;
+    std::cout << "Format: CORECAT_FORMAT " << measure(1, [&] {
+        
+        sink += CORECAT_FORMAT("[{:>8}] {} {:#x} {}")("worker", zero + 42, 0xBEEF, "completed").getLength();
+        
+    }) * 1e3 << " M/s, _format " << measure(1, [&] {
+        
+        sink += "[{:>8}] {} {:#x} {}"_format("worker", zero + 42, 0xBEEF, "completed").getLength();
+        
+    }) * 1e3 << " M/s, Formatter::format " << measure(1, [&] {
+        
+        sink += formatter("worker", zero + 42, 0xBEEF, "completed").getLength();
+        
+    }) * 1e3 << " M/s, Formatter::formatTo " << measure(1, [&] {
+        
+        record.clear();
+        sink += formatter.formatTo(record, "worker", zero + 42, 0xBEEF, "completed").getLength();
+        
+    }) * 1e3 << " M/s, snprintf " << measure(1, [&] {
+        
+        char buffer[64];
+        sink += std::snprintf(buffer, sizeof(buffer), "[%8s] %zu %#x %s", "worker", zero + 42, 0xBEEF, "completed");
+        
+    }) * 1e3 << " M/s, std::ostringstream " << measure(1, [&] {
+        
+        std::ostringstream stream;
+        stream << '[' << std::setw(8) << "worker" << "] " << zero + 42 << ' ' << std::showbase << std::hex << 0xBEEF << ' ' << "completed";
+        sink += stream.str().size();
+        
+    }) * 1e3 << " M/s" << std::endl;
+    
+    // Shortest round-trip formatting of doubles spread over the exponent range, against the 17 digits of "%.17g"
+    std::vector<double> doubles(4096);
+    for(std::size_t i = 0; i < doubles.size(); ++i) doubles[i] = double(i * 2654435761u % 1000003) * std::pow(10.0, int(i % 64) - 32) / 7;
+    std::size_t doubleIndex = 0;
+    Formatter8 doubleFormatter("{}"_sv);
+    std::cout << "Double: toString " << measure(1, [&] {
+        
+        sink += toString8(doubles[doubleIndex++ & 4095]).getLength();
+        
+    }) * 1e3 << " M/s, Formatter::formatTo " << measure(1, [&] {
+        
+        record.clear();
+        sink += doubleFormatter.formatTo(record, doubles[doubleIndex++ & 4095]).getLength();
+        
+    }) * 1e3 << " M/s, snprintf " << measure(1, [&] {
+        
+        char buffer[32];
+        sink += std::snprintf(buffer, sizeof(buffer), "%.17g", doubles[doubleIndex++ & 4095]);
+        
+    }) * 1e3 << " M/s" << std::endl;
+    
+    // Parsing back integers of all lengths and the doubles above, against the C library
+    std::vector<String8> integerTexts(4096), doubleTexts(4096);
+    for(std::size_t i = 0; i < integerTexts.size(); ++i) {
+        
+        integerTexts[i] = toString8(std::int64_t(i * 0x9E3779B97F4A7C15 >> (i % 64)) / (i % 2 ? 1 : -1));
+        doubleTexts[i] = toString8(doubles[i]);
+        
+    }
+    std::size_t parseIndex = 0;
+    std::cout << "Parse: parseInteger " << measure(1, [&] {
+        
+        sink += std::size_t(parseInteger<std::int64_t>(integerTexts[parseIndex++ & 4095]).value);
+        
+    }) * 1e3 << " M/s, strtoll " << measure(1, [&] {
+        
+        sink += std::size_t(std::strtoll(integerTexts[parseIndex++ & 4095].getData(), nullptr, 10));
+        
+    }) * 1e3 << " M/s, parseFloat " << measure(1, [&] {
+        
+        sink += std::size_t(parseFloat<double>(doubleTexts[parseIndex++ & 4095]).value > 1);
+        
+    }) * 1e3 << " M/s, strtod " << measure(1, [&] {
+        
+        sink += std::size_t(std::strtod(doubleTexts[parseIndex++ & 4095].getData(), nullptr) > 1);
+        
+    }) * 1e3 << " M/s" << std::endl;
+    
+    // Integer to text for every width and length, and power-of-two bases against snprintf
+    measureInteger<std::uint8_t>("uint8", sink);
+    measureInteger<std::int8_t>("int8", sink);
+    measureInteger<std::uint16_t>("uint16", sink);
+    measureInteger<std::int16_t>("int16", sink);
+    measureInteger<std::uint32_t>("uint32", sink);
+    measureInteger<std::int32_t>("int32", sink);
+    measureInteger<std::uint64_t>("uint64", sink);
+    measureInteger<std::int64_t>("int64", sink);
+    std::vector<std::uint64_t> hexValues(1024);
+    for(std::size_t i = 0; i < hexValues.size(); ++i) hexValues[i] = i * 0x9E3779B97F4A7C15 >> (i % 64);
+    std::cout << "Hex: toStringBase " << measure(hexValues.size(), [&] {
+        
+        for(auto x : hexValues) sink += toStringBase<UTF8Charset<>>(x, 16).getLength();
+        
+    }) * 1e3 << " M/s, snprintf " << measure(hexValues.size(), [&] {
+        
+        char buffer[32];
+        for(auto x : hexValues) sink += std::snprintf(buffer, sizeof(buffer), "%llx", static_cast<unsigned long long>(x));
+        
+    }) * 1e3 << " M/s" << std::endl;
+    
+    // Escaping log messages for JSON, mostly clean text with the odd quote or newline, against a loop over each
+    // character; then whole records through JsonWriter
+    std::vector<String8> messages;
+    std::mt19937 messageRandom(7);
+    std::size_t messageTotal = 0;
+    for(std::size_t i = 0; i < 1024; ++i) {
+        
+        std::string str = "GET /api/v1/items/" + std::to_string(messageRandom()) + " from worker-" + std::to_string(i % 16) + ": ";
+        std::size_t length = 40 + messageRandom() % 200;
+        while(str.size() < length) str += messageRandom() % 8 ? "request served in time " : "said \"ok\"\n";
+        messages.emplace_back(str.c_str());
+        messageTotal += str.size();
+        
+    }
+    std::cout << "Escape JSON: {:j} " << measure(messageTotal, [&] {
+        
+        String8 str;
+        for(auto&& x : messages) CORECAT_FORMAT("{:j}").formatTo(str, x);
+        sink += str.getLength();
+        
+    }) << " GB/s, per character " << measure(messageTotal, [&] {
+        
+        String8 str;
+        for(auto&& x : messages) {
+            
+            for(char c : x) {
+                
+                if(c == '"') str += "\\\"";
+                else if(c == '\\') str += "\\\\";
+                else if(c == '\n') str += "\\n";
+                else if(static_cast<unsigned char>(c) < 0x20) {
+                    
+                    char buffer[8];
+                    std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+                    str += buffer;
+                    
+                } else str += c;
+                
+            }
+            
+        }
+        sink += str.getLength();
+        
+    }) << " GB/s" << std::endl;
+    CountOutputStream jsonStream;
+    std::cout << "JsonWriter: " << measure(messages.size(), [&] {
+        
+        JsonWriter writer(jsonStream);
+        for(std::size_t i = 0; i < messages.size(); ++i)
+            writer.beginObject().key("time").value(std::uint64_t(1700000000000 + i)).key("level").value("info").key("message").value(messages[i]).endObject();
+            
+    }) * 1e3 << " M records/s" << std::endl;
+    sink += jsonStream.size;
+    
+    std::cout << "Checksum: " << sink << std::endl;
+    
+    return 0;
+    
+}
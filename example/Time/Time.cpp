@@ -0,0 +1,115 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2016-2018 The Cats Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <cstdio>
+#include <ctime>
+
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#include "Cats/Corecat/Text.hpp"
+#include "Cats/Corecat/Time.hpp"
+
+
+using namespace Cats::Corecat;
+
+
+#define PRINT(x) do { std::cout << #x << "\n    -> " << (x) << std::endl; } while(0)
+
+// Nanoseconds per call of f(i) over count calls, taking the best of a few rounds
+template <typename F>
+double measure(std::size_t count, F&& f) {
+    
+    using Clock = std::chrono::steady_clock;
+    double best = 0;
+    for(int round = 0; round < 5; ++round) {
+        
+        auto startTime = Clock::now();
+        for(std::size_t i = 0; i < count; ++i) f(i);
+        double t = std::chrono::duration<double, std::nano>(Clock::now() - startTime).count() / count;
+        if(!round || t < best) best = t;
+        
+    }
+    return best;
+    
+}
+
+int main() {
+    
+    std::cout << std::boolalpha;
+    
+    WallClock::time_point t(WallClock::duration(1700000000123456789));
+    PRINT("{}"_format(t)); // 2023-11-14T22:13:20.123456789Z
+    PRINT("{:.3}"_format(t)); // 2023-11-14T22:13:20.123Z
+    PRINT(TimestampFormatter(0, 8 * 60)(t)); // 2023-11-15T06:13:20+08:00
+    PRINT(parseTimestamp("2023-11-15T06:13:20.5+08:00"_sv).value == t - std::chrono::nanoseconds(123456789 - 500000000)); // true
+    PRINT(bool(parseTimestamp("2023-02-29T00:00:00Z"_sv))); // false
+    std::cout << std::endl;
+    
+    // Timestamps a few microseconds apart, as in a log, and then scattered over the years
+    constexpr std::size_t COUNT = 1000000;
+    std::vector<WallClock::time_point> near(COUNT), far(COUNT);
+    for(std::size_t i = 0; i < COUNT; ++i) {
+        
+        near[i] = WallClock::time_point(WallClock::duration(1700000000000000000 + std::int64_t(i) * 3217));
+        far[i] = WallClock::time_point(WallClock::duration(std::int64_t(i * 0x9E3779B97F4A7C15 >> 2)));
+        
+    }
+    std::size_t sink = 0;
+    char buffer[64];
+    TimestampFormatter formatter;
+    auto formatC = [&](WallClock::time_point x) {
+        
+        std::int64_t n = x.time_since_epoch().count();
+        std::time_t second = std::time_t(n / 1000000000);
+        std::tm tm = *std::localtime(&second);
+        std::size_t length = std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S", &tm);
+        return length + std::snprintf(buffer + length, sizeof(buffer) - length, ".%09dZ", int(n % 1000000000));
+        
+    };
+    std::cout << "Format nearby: TimestampFormatter " << measure(COUNT, [&](std::size_t i) { sink += formatter.format(near[i], buffer) - buffer; })
+        << " ns, localtime + strftime " << measure(COUNT, [&](std::size_t i) { sink += formatC(near[i]); }) << " ns" << std::endl;
+    std::cout << "Format scattered: TimestampFormatter " << measure(COUNT, [&](std::size_t i) { sink += formatter.format(far[i], buffer) - buffer; })
+        << " ns, localtime + strftime " << measure(COUNT, [&](std::size_t i) { sink += formatC(far[i]); }) << " ns" << std::endl;
+        
+    std::vector<String8> text(4096);
+    for(std::size_t i = 0; i < text.size(); ++i) text[i] = formatter(far[i * 241]);
+    std::cout << "Parse: parseTimestamp " << measure(COUNT, [&](std::size_t i) {
+        
+        sink += std::size_t(parseTimestamp(text[i & 4095]).value.time_since_epoch().count());
+        
+    }) << " ns, sscanf " << measure(COUNT, [&](std::size_t i) {
+        
+        int y, mo, d, h, mi, s, f;
+        sink += std::size_t(std::sscanf(text[i & 4095].getData(), "%d-%d-%dT%d:%d:%d.%dZ", &y, &mo, &d, &h, &mi, &s, &f));
+        
+    }) << " ns" << std::endl;
+    std::cout << "Checksum: " << sink << std::endl;
+    
+    return 0;
+    
+}
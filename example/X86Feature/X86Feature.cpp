@@ -58,6 +58,9 @@ int main() {
     PRINT(X86Feature::SSE4_2);
     PRINT(X86Feature::AVX);
     PRINT(X86Feature::AVX2);
+    PRINT(X86Feature::BMI1);
+    PRINT(X86Feature::BMI2);
+    PRINT(X86Feature::SHA);
     
     return 0;
     
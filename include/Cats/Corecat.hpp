@@ -30,6 +30,7 @@
 
 #include "Corecat/Concurrent.hpp"
 #include "Corecat/Data.hpp"
+#include "Corecat/Log.hpp"
 #include "Corecat/System.hpp"
 #include "Corecat/Text.hpp"
 #include "Corecat/Time.hpp"
@@ -49,10 +49,11 @@ protected:
 #define CORECAT_COROUTINE \
     if(_exception) _exception.rethrow(); \
     switch(_coroutineState) \
+        case 0: \
         if(false) { \
             _BREAK_COROUTINE: \
             break; \
-        } else case 0:
+        } else
 
 #define CORECAT_AWAIT_IMPL(expr, n) \
     do { \
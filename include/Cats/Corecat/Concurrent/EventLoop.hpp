@@ -0,0 +1,182 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2016-2018 The Cats Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef CATS_CORECAT_CONCURRENT_EVENTLOOP_HPP
+#define CATS_CORECAT_CONCURRENT_EVENTLOOP_HPP
+
+
+#include <cerrno>
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Promise.hpp"
+#include "../System/OS.hpp"
+#include "../Util/Exception.hpp"
+
+#if defined(CORECAT_OS_LINUX)
+#   include <unistd.h>
+#   include <sys/epoll.h>
+#else
+#   error EventLoop requires epoll
+#endif
+
+
+namespace Cats {
+namespace Corecat {
+inline namespace Concurrent {
+
+// Single-threaded readiness loop. Descriptors are registered edge-triggered on first use and stay registered until
+// remove(), which must be called before the descriptor is closed. An edge that arrives while nobody waits is kept,
+// so the next wait resolves at once; callers retry the operation and wait again on EAGAIN.
+class EventLoop {
+    
+private:
+    
+    struct Watch {
+        
+        std::vector<Promise<>> reader;
+        std::vector<Promise<>> writer;
+        bool readable = false;
+        bool writable = false;
+        
+    };
+    
+private:
+    
+    int fd;
+    std::vector<epoll_event> event;
+    std::unordered_map<int, Watch> watch;
+    std::vector<Promise<>> ready;
+    std::size_t pending = 0;
+    
+private:
+    
+    Watch& getWatch(int f) {
+        
+        auto it = watch.find(f);
+        if(it == watch.end()) {
+            
+            epoll_event e = {};
+            e.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+            e.data.fd = f;
+            if(::epoll_ctl(fd, EPOLL_CTL_ADD, f, &e))
+                throw SystemException("::epoll_ctl failed");
+            it = watch.emplace(f, Watch()).first;
+            
+        }
+        return it->second;
+        
+    }
+    
+    Promise<> wait(std::vector<Promise<>>& waiter, bool& flag) {
+        
+        Promise<> promise;
+        if(flag) flag = false, ready.push_back(promise);
+        else waiter.push_back(promise);
+        ++pending;
+        return promise;
+        
+    }
+    
+public:
+    
+    // maxEvent bounds how many events one epoll_wait call collects
+    EventLoop(std::size_t maxEvent = 256) : fd(::epoll_create1(EPOLL_CLOEXEC)), event(maxEvent ? maxEvent : 1) {
+        
+        if(fd < 0)
+            throw SystemException("::epoll_create1 failed");
+            
+    }
+    EventLoop(const EventLoop& src) = delete;
+    ~EventLoop() { ::close(fd); }
+    
+    EventLoop& operator =(const EventLoop& src) = delete;
+    
+    Promise<> waitReadable(int f) { auto& w = getWatch(f); return wait(w.reader, w.readable); }
+    Promise<> waitWritable(int f) { auto& w = getWatch(f); return wait(w.writer, w.writable); }
+    // Unregisters f and rejects everything still waiting on it
+    void remove(int f) {
+        
+        auto it = watch.find(f);
+        if(it == watch.end()) return;
+        ::epoll_ctl(fd, EPOLL_CTL_DEL, f, nullptr);
+        auto w = std::move(it->second);
+        watch.erase(it);
+        pending -= w.reader.size() + w.writer.size();
+        ExceptionPtr e(IOException("Descriptor removed"));
+        for(auto&& x : w.reader) x.reject(e);
+        for(auto&& x : w.writer) x.reject(e);
+        
+    }
+    
+    std::size_t getPending() const noexcept { return pending; }
+    
+    // Collects one batch of events (without blocking if some waits are already satisfied) and resolves their promises;
+    // returns how many were resolved. timeout is in milliseconds, -1 blocks until an event arrives
+    std::size_t poll(int timeout = -1) {
+        
+        std::vector<Promise<>> list;
+        std::swap(list, ready);
+        int n = ::epoll_wait(fd, event.data(), int(event.size()), list.empty() ? timeout : 0);
+        if(n < 0 && errno != EINTR)
+            throw SystemException("::epoll_wait failed");
+        for(int i = 0; i < n; ++i) {
+            
+            auto it = watch.find(event[i].data.fd);
+            if(it == watch.end()) continue;
+            auto& w = it->second;
+            auto e = event[i].events;
+            if(e & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+                
+                if(w.reader.empty()) w.readable = true;
+                else list.insert(list.end(), w.reader.begin(), w.reader.end()), w.reader.clear();
+                
+            }
+            if(e & (EPOLLOUT | EPOLLHUP | EPOLLERR)) {
+                
+                if(w.writer.empty()) w.writable = true;
+                else list.insert(list.end(), w.writer.begin(), w.writer.end()), w.writer.clear();
+                
+            }
+            
+        }
+        pending -= list.size();
+        for(auto&& x : list) x.resolve();
+        return list.size();
+        
+    }
+    void run() { while(pending) poll(); }
+    
+};
+
+}
+}
+}
+
+
+#endif
@@ -30,7 +30,9 @@
 
 #include "Data/Allocator.hpp"
 #include "Data/Array.hpp"
+#include "Data/AsyncFile.hpp"
 #include "Data/DataView.hpp"
+#include "Data/Digest.hpp"
 #include "Data/Stream.hpp"
 
 
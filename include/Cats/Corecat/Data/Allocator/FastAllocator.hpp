@@ -31,6 +31,8 @@
 #include <cassert>
 #include <cstdlib>
 
+#include <utility>
+
 #include "DefaultAllocator.hpp"
 
 
@@ -54,8 +56,8 @@ private:
     
 private:
     
-    Block* firstBlock;
-    Block* lastBlock;
+    Block* firstBlock = nullptr;
+    Block* lastBlock = nullptr;
     
 private:
     
@@ -74,8 +76,24 @@ public:
     
     FastAllocator() = default;
     FastAllocator(const FastAllocator& src) = delete;
+    FastAllocator(FastAllocator&& src) : A(std::move(src)), firstBlock(src.firstBlock), lastBlock(src.lastBlock) {
+        
+        src.firstBlock = src.lastBlock = nullptr;
+        
+    }
     ~FastAllocator() { clear(); }
     
+    FastAllocator& operator =(const FastAllocator& src) = delete;
+    FastAllocator& operator =(FastAllocator&& src) {
+        
+        clear();
+        A::operator =(std::move(src));
+        firstBlock = src.firstBlock, lastBlock = src.lastBlock;
+        src.firstBlock = src.lastBlock = nullptr;
+        return *this;
+        
+    }
+    
     void* allocate(std::size_t size) {
         
         assert(size);
@@ -0,0 +1,696 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2016-2018 The Cats Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef CATS_CORECAT_DATA_ASYNCFILE_HPP
+#define CATS_CORECAT_DATA_ASYNCFILE_HPP
+
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "Array.hpp"
+#include "../Concurrent/Promise.hpp"
+#include "../Concurrent/ThreadPoolExecutor.hpp"
+#include "../System/OS.hpp"
+#include "../Text/String.hpp"
+#include "../Util/Byte.hpp"
+#include "../Util/Exception.hpp"
+
+#if defined(CORECAT_OS_WINDOWS)
+#   include "../Win32/Handle.hpp"
+#elif defined(CORECAT_OS_LINUX) || defined(CORECAT_OS_MACOS)
+#   include <fcntl.h>
+#   include <unistd.h>
+#   include <sys/stat.h>
+#   include <sys/uio.h>
+#   if defined(CORECAT_OS_LINUX) && defined(__has_include)
+#       if __has_include(<linux/io_uring.h>)
+#           include <sys/mman.h>
+#           include <sys/syscall.h>
+#           include <linux/io_uring.h>
+#           if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter) && defined(__NR_io_uring_register)
+#               define CORECAT_DATA_ASYNCFILE_IO_URING
+#           endif
+#       endif
+#   endif
+#else
+#   error Unknown OS
+#endif
+
+
+namespace Cats {
+namespace Corecat {
+inline namespace Data {
+
+class AsyncFile;
+
+#if defined(CORECAT_DATA_ASYNCFILE_IO_URING)
+namespace Impl {
+
+// Minimal io_uring binding through raw system calls, so that liburing is not required.
+// Only one thread may submit to and reap from a ring at a time.
+class IOUring {
+    
+private:
+    
+    int fd = -1;
+    
+    void* sqRing = MAP_FAILED;
+    void* cqRing = MAP_FAILED;
+    std::size_t sqRingSize = 0;
+    std::size_t cqRingSize = 0;
+    io_uring_sqe* sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+    std::size_t sqesSize = 0;
+    
+    unsigned* sqHead;
+    unsigned* sqTail;
+    unsigned sqMask;
+    unsigned* sqArray;
+    unsigned sqEntries;
+    
+    unsigned* cqHead;
+    unsigned* cqTail;
+    unsigned cqMask;
+    io_uring_cqe* cqes;
+    unsigned cqEntries;
+    
+    unsigned sqLocalTail = 0;
+    unsigned toSubmit = 0;
+    
+private:
+    
+    template <typename T>
+    static T* at(void* base, std::uint32_t offset) noexcept { return reinterpret_cast<T*>(static_cast<char*>(base) + offset); }
+    
+    void release() noexcept {
+        
+        if(sqes != MAP_FAILED) ::munmap(sqes, sqesSize);
+        if(cqRing != MAP_FAILED && cqRing != sqRing) ::munmap(cqRing, cqRingSize);
+        if(sqRing != MAP_FAILED) ::munmap(sqRing, sqRingSize);
+        if(fd >= 0) ::close(fd);
+        fd = -1, sqRing = cqRing = MAP_FAILED, sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+        
+    }
+    
+public:
+    
+    IOUring() = default;
+    IOUring(const IOUring& src) = delete;
+    ~IOUring() { release(); }
+    
+    IOUring& operator =(const IOUring& src) = delete;
+    
+    bool init(unsigned entries) noexcept {
+        
+        io_uring_params p = {};
+        fd = int(::syscall(__NR_io_uring_setup, entries, &p));
+        if(fd < 0) return false;
+        
+        sqRingSize = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+        cqRingSize = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+        bool singleMap = false;
+#if defined(IORING_FEAT_SINGLE_MMAP)
+        if(p.features & IORING_FEAT_SINGLE_MMAP) {
+            
+            singleMap = true;
+            sqRingSize = cqRingSize = std::max(sqRingSize, cqRingSize);
+            
+        }
+#endif
+        sqRing = ::mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        if(sqRing == MAP_FAILED) { release(); return false; }
+        if(singleMap) cqRing = sqRing;
+        else {
+            
+            cqRing = ::mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+            if(cqRing == MAP_FAILED) { release(); return false; }
+            
+        }
+        sqesSize = p.sq_entries * sizeof(io_uring_sqe);
+        sqes = static_cast<io_uring_sqe*>(::mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+        if(sqes == MAP_FAILED) { release(); return false; }
+        
+        sqHead = at<unsigned>(sqRing, p.sq_off.head);
+        sqTail = at<unsigned>(sqRing, p.sq_off.tail);
+        sqMask = *at<unsigned>(sqRing, p.sq_off.ring_mask);
+        sqArray = at<unsigned>(sqRing, p.sq_off.array);
+        sqEntries = p.sq_entries;
+        cqHead = at<unsigned>(cqRing, p.cq_off.head);
+        cqTail = at<unsigned>(cqRing, p.cq_off.tail);
+        cqMask = *at<unsigned>(cqRing, p.cq_off.ring_mask);
+        cqes = at<io_uring_cqe>(cqRing, p.cq_off.cqes);
+        cqEntries = p.cq_entries;
+        sqLocalTail = *sqTail;
+        return true;
+        
+    }
+    
+    unsigned getCompletionEntries() const noexcept { return cqEntries; }
+    
+    // Returns nullptr when the submission queue is full; call enter() to make room.
+    io_uring_sqe* getSQE() noexcept {
+        
+        unsigned head = __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+        if(sqLocalTail - head >= sqEntries) return nullptr;
+        unsigned index = sqLocalTail & sqMask;
+        io_uring_sqe* sqe = sqes + index;
+        *sqe = {};
+        sqArray[index] = index;
+        ++sqLocalTail, ++toSubmit;
+        return sqe;
+        
+    }
+    
+    void enter(unsigned minComplete) {
+        
+        __atomic_store_n(sqTail, sqLocalTail, __ATOMIC_RELEASE);
+        while(toSubmit || minComplete) {
+            
+            unsigned flags = minComplete ? IORING_ENTER_GETEVENTS : 0;
+            long ret = ::syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0);
+            if(ret < 0) {
+                
+                if(errno == EINTR) continue;
+                // The completion queue is full, so let the caller reap before submitting more
+                if(errno == EAGAIN || errno == EBUSY) break;
+                throw SystemException("::io_uring_enter failed");
+                
+            }
+            toSubmit -= unsigned(ret);
+            minComplete = 0;
+            
+        }
+        
+    }
+    
+    // Calls f(userData, result) for every completion in the queue and returns the number reaped.
+    template <typename F>
+    std::size_t reap(F&& f) {
+        
+        unsigned head = *cqHead;
+        unsigned tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+        std::size_t count = tail - head;
+        for(; head != tail; ++head) {
+            
+            auto& cqe = cqes[head & cqMask];
+            f(cqe.user_data, cqe.res);
+            
+        }
+        __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+        return count;
+        
+    }
+    
+    bool registerBuffers(const iovec* iov, unsigned count) noexcept {
+        
+        return ::syscall(__NR_io_uring_register, fd, IORING_REGISTER_BUFFERS, iov, count) == 0;
+        
+    }
+    void unregisterBuffers() noexcept { ::syscall(__NR_io_uring_register, fd, IORING_UNREGISTER_BUFFERS, nullptr, 0); }
+    
+};
+
+}
+#endif
+
+// Drives asynchronous file operations.
+// Operations are queued by AsyncFile and handed to the kernel in one batch by submit() (or wait());
+// completions are reaped in batches by poll() and wait(), which resolve the returned promises on the
+// calling thread. io_uring is used when available, otherwise operations run on a ThreadPoolExecutor.
+// Either way an operation is continued after a short transfer, so it resolves with fewer bytes than
+// requested only at the end of the file.
+class AsyncFileContext {
+    
+private:
+    
+    friend AsyncFile;
+    
+#if defined(CORECAT_OS_WINDOWS)
+    using NativeHandle = HANDLE;
+#else
+    using NativeHandle = int;
+#endif
+    
+    enum class OperationType { READ, WRITE, READ_FIXED, WRITE_FIXED };
+    
+    struct Request {
+        
+        Promise<std::size_t> promise;
+        OperationType type;
+        NativeHandle handle;
+        char* buffer;
+        std::size_t count;
+        std::uint64_t offset;
+        std::size_t bufferIndex;
+        // Bytes transferred by earlier completions of the operation
+        std::size_t done;
+#if defined(CORECAT_OS_LINUX) || defined(CORECAT_OS_MACOS)
+        iovec iov;
+#endif
+    
+    };
+    
+    struct Completion {
+        
+        std::size_t index;
+        std::int64_t result;
+        
+    };
+    
+private:
+
+#if defined(CORECAT_DATA_ASYNCFILE_IO_URING)
+    Impl::IOUring ring;
+#endif
+    bool useRing = false;
+    std::unique_ptr<ThreadPoolExecutor> executor;
+    
+    std::vector<Request> requests;
+    std::vector<std::size_t> freeList;
+    std::vector<ArrayView<Byte>> buffers;
+    
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::vector<Completion> completed;
+    std::vector<Completion> batch;
+    std::vector<std::size_t> partial;
+    
+private:
+    
+    static std::int64_t execute(OperationType type, NativeHandle handle, void* buffer, std::size_t count, std::uint64_t offset) noexcept {
+        
+        std::size_t done = 0;
+        while(done < count) {
+#if defined(CORECAT_OS_WINDOWS)
+            OVERLAPPED overlapped = {};
+            overlapped.Offset = DWORD(offset + done);
+            overlapped.OffsetHigh = DWORD((offset + done) >> 32);
+            DWORD size = DWORD(std::min<std::size_t>(count - done, 0x40000000)), transferred = 0;
+            BOOL ret = (type == OperationType::READ || type == OperationType::READ_FIXED)
+                ? ::ReadFile(handle, static_cast<char*>(buffer) + done, size, &transferred, &overlapped)
+                : ::WriteFile(handle, static_cast<char*>(buffer) + done, size, &transferred, &overlapped);
+            if(!ret) {
+                
+                if(::GetLastError() == ERROR_HANDLE_EOF) break;
+                return -std::int64_t(::GetLastError());
+                
+            }
+            std::int64_t n = transferred;
+#else
+            ssize_t n = (type == OperationType::READ || type == OperationType::READ_FIXED)
+                ? ::pread(handle, static_cast<char*>(buffer) + done, count - done, off_t(offset + done))
+                : ::pwrite(handle, static_cast<char*>(buffer) + done, count - done, off_t(offset + done));
+            if(n < 0) {
+                
+                if(errno == EINTR) continue;
+                return -std::int64_t(errno);
+                
+            }
+#endif
+            if(!n) break;
+            done += std::size_t(n);
+            
+        }
+        return std::int64_t(done);
+        
+    }
+    
+    std::size_t acquire() {
+        
+        while(freeList.empty()) {
+            
+            submit();
+            waitImpl(1);
+            
+        }
+        auto index = freeList.back();
+        freeList.pop_back();
+        return index;
+        
+    }
+    
+#if defined(CORECAT_DATA_ASYNCFILE_IO_URING)
+    // Queues what is left of an operation, at most 1 GiB at a time, like the Windows fallback
+    void prepare(std::size_t index) {
+        
+        auto& request = requests[index];
+        io_uring_sqe* sqe;
+        while(!(sqe = ring.getSQE())) ring.enter(0);
+        auto buffer = request.buffer + request.done;
+        auto count = std::min<std::size_t>(request.count - request.done, 0x40000000);
+        sqe->fd = request.handle;
+        sqe->off = request.offset + request.done;
+        sqe->user_data = index;
+        switch(request.type) {
+        case OperationType::READ:
+        case OperationType::WRITE:
+            request.iov.iov_base = buffer;
+            request.iov.iov_len = count;
+            sqe->opcode = request.type == OperationType::READ ? IORING_OP_READV : IORING_OP_WRITEV;
+            sqe->addr = reinterpret_cast<std::uintptr_t>(&request.iov);
+            sqe->len = 1;
+            break;
+        case OperationType::READ_FIXED:
+        case OperationType::WRITE_FIXED:
+            sqe->opcode = request.type == OperationType::READ_FIXED ? IORING_OP_READ_FIXED : IORING_OP_WRITE_FIXED;
+            sqe->addr = reinterpret_cast<std::uintptr_t>(buffer);
+            sqe->len = unsigned(count);
+            sqe->buf_index = std::uint16_t(request.bufferIndex);
+            break;
+        }
+        
+    }
+#endif
+    
+    Promise<std::size_t> enqueue(OperationType type, NativeHandle handle, void* buffer, std::size_t count, std::uint64_t offset, std::size_t bufferIndex = 0) {
+        
+        auto index = acquire();
+        auto& request = requests[index];
+        request.promise = Promise<std::size_t>();
+        auto promise = request.promise;
+#if defined(CORECAT_DATA_ASYNCFILE_IO_URING)
+        if(useRing) {
+            
+            request.type = type, request.handle = handle, request.buffer = static_cast<char*>(buffer), request.count = count;
+            request.offset = offset, request.bufferIndex = bufferIndex, request.done = 0;
+            prepare(index);
+            return promise;
+            
+        }
+#endif
+        (void)bufferIndex;
+        executor->execute([=] {
+            
+            auto result = execute(type, handle, buffer, count, offset);
+            std::lock_guard<std::mutex> lock(mutex);
+            completed.push_back({index, result});
+            condition.notify_one();
+            
+        });
+        return promise;
+        
+    }
+    
+    std::size_t dispatch() {
+        
+        std::size_t count = batch.size();
+        // Take every promise out and free its slot before running any continuation, so that continuations may enqueue
+        // new operations into the slots without touching the promises still to be settled
+        std::vector<std::pair<Promise<std::size_t>, std::int64_t>> settled;
+        settled.reserve(count);
+        for(auto&& x : batch) settled.emplace_back(std::move(requests[x.index].promise), x.result), freeList.push_back(x.index);
+        batch.clear();
+        for(auto&& x : settled) {
+            
+            if(x.second >= 0) x.first.resolve(std::size_t(x.second));
+            else x.first.reject(IOException("Asynchronous file operation failed"));
+            
+        }
+        return count;
+        
+    }
+    
+    std::size_t reap() {
+        
+#if defined(CORECAT_DATA_ASYNCFILE_IO_URING)
+        if(useRing) {
+            
+            // A short transfer that did not reach the end of the file is resubmitted for the rest
+            ring.reap([&](std::uint64_t index, std::int32_t result) {
+                
+                auto& request = requests[std::size_t(index)];
+                if(result > 0 && (request.done += std::size_t(result)) < request.count) partial.push_back(std::size_t(index));
+                else batch.push_back({std::size_t(index), result < 0 ? result : std::int64_t(request.done)});
+                
+            });
+            if(!partial.empty()) {
+                
+                for(auto&& x : partial) prepare(x);
+                partial.clear();
+                ring.enter(0);
+                
+            }
+            
+        } else
+#endif
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            std::swap(batch, completed);
+        }
+        return dispatch();
+        
+    }
+    
+    std::size_t waitImpl(std::size_t count) {
+        
+        std::size_t done = 0;
+        while(done < count && getPending()) {
+            
+#if defined(CORECAT_DATA_ASYNCFILE_IO_URING)
+            if(useRing) ring.enter(1);
+            else
+#endif
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                condition.wait(lock, [&] { return !completed.empty(); });
+            }
+            done += reap();
+            
+        }
+        return done;
+        
+    }
+    
+public:
+    
+    AsyncFileContext(std::size_t entries = 256, bool tryIOUring = true) {
+        
+#if defined(CORECAT_DATA_ASYNCFILE_IO_URING)
+        if(tryIOUring) useRing = ring.init(unsigned(entries));
+        std::size_t slot = useRing ? ring.getCompletionEntries() : entries * 2;
+#else
+        (void)tryIOUring;
+        std::size_t slot = entries * 2;
+#endif
+        if(!useRing) executor.reset(new ThreadPoolExecutor);
+        requests.resize(slot);
+        freeList.reserve(slot);
+        for(std::size_t i = slot; i; --i) freeList.push_back(i - 1);
+        
+    }
+    AsyncFileContext(const AsyncFileContext& src) = delete;
+    ~AsyncFileContext() {
+        
+        try { run(); } catch(...) {}
+        
+    }
+    
+    AsyncFileContext& operator =(const AsyncFileContext& src) = delete;
+    
+    bool isIOUring() const noexcept { return useRing; }
+    std::size_t getPending() const noexcept { return requests.size() - freeList.size(); }
+    
+    // Registered buffers are pinned by the kernel once, avoiding per-operation page mapping.
+    void registerBuffers(ArrayView<const ArrayView<Byte>> buffers_) {
+        
+        if(!buffers.empty()) throw InvalidArgumentException("Buffers are already registered");
+#if defined(CORECAT_DATA_ASYNCFILE_IO_URING)
+        if(useRing) {
+            
+            std::vector<iovec> iov;
+            for(auto&& x : buffers_) iov.push_back({x.getData(), x.getSize()});
+            if(!ring.registerBuffers(iov.data(), unsigned(iov.size())))
+                throw SystemException("::io_uring_register failed");
+                
+        }
+#endif
+        buffers.assign(buffers_.begin(), buffers_.end());
+        
+    }
+    void unregisterBuffers() {
+        
+        if(getPending()) throw InvalidArgumentException("Operations are still pending");
+#if defined(CORECAT_DATA_ASYNCFILE_IO_URING)
+        if(useRing && !buffers.empty()) ring.unregisterBuffers();
+#endif
+        buffers.clear();
+        
+    }
+    ArrayView<Byte> getBuffer(std::size_t index) const {
+        
+        if(index >= buffers.size()) throw InvalidArgumentException("Invalid buffer index");
+        return buffers[index];
+        
+    }
+    
+    // Hands every queued operation to the kernel with a single system call.
+    void submit() {
+        
+#if defined(CORECAT_DATA_ASYNCFILE_IO_URING)
+        if(useRing) ring.enter(0);
+#endif
+    
+    }
+    // Resolves the promises of all finished operations without blocking.
+    std::size_t poll() { return reap(); }
+    // Submits queued operations and blocks until at least count of them have finished.
+    std::size_t wait(std::size_t count = 1) {
+        
+        submit();
+        return waitImpl(count);
+        
+    }
+    // Blocks until no operation is pending.
+    void run() { while(getPending()) wait(getPending()); }
+    
+};
+
+class AsyncFile {
+    
+public:
+    
+    enum class Mode { READ, WRITE, READ_WRITE };
+    
+private:
+    
+    using OperationType = AsyncFileContext::OperationType;
+    
+private:
+    
+    AsyncFileContext* context;
+#if defined(CORECAT_OS_WINDOWS)
+    Handle handle;
+#else
+    int fd = -1;
+#endif
+
+private:
+    
+    AsyncFileContext::NativeHandle getNativeHandle() const noexcept {
+#if defined(CORECAT_OS_WINDOWS)
+        return handle;
+#else
+        return fd;
+#endif
+    }
+    
+    void* getFixedBuffer(std::size_t bufferIndex, std::size_t bufferOffset, std::size_t count) const {
+        
+        auto buffer = context->getBuffer(bufferIndex);
+        if(bufferOffset > buffer.getSize() || count > buffer.getSize() - bufferOffset)
+            throw InvalidArgumentException("Range exceeds registered buffer");
+        return buffer.getData() + bufferOffset;
+        
+    }
+    
+public:
+    
+    AsyncFile(AsyncFileContext& context_, const String8& path, Mode mode = Mode::READ) : context(&context_) {
+#if defined(CORECAT_OS_WINDOWS)
+        DWORD access = mode == Mode::READ ? GENERIC_READ : mode == Mode::WRITE ? GENERIC_WRITE : GENERIC_READ | GENERIC_WRITE;
+        DWORD disposition = mode == Mode::READ ? OPEN_EXISTING : mode == Mode::WRITE ? CREATE_ALWAYS : OPEN_ALWAYS;
+        HANDLE h = ::CreateFileW(WString(path).getData(), access, FILE_SHARE_READ, nullptr, disposition, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if(h == INVALID_HANDLE_VALUE) throw IOException("::CreateFileW failed");
+        handle = h;
+#else
+        int flags = mode == Mode::READ ? O_RDONLY : mode == Mode::WRITE ? O_WRONLY | O_CREAT | O_TRUNC : O_RDWR | O_CREAT;
+        do
+            fd = ::open(path.getData(), flags | O_CLOEXEC, 0666);
+        while(fd < 0 && errno == EINTR);
+        if(fd < 0) throw IOException("::open failed");
+#endif
+    }
+    AsyncFile(const AsyncFile& src) = delete;
+#if defined(CORECAT_OS_WINDOWS)
+    AsyncFile(AsyncFile&& src) : context(src.context), handle(std::move(src.handle)) {}
+#else
+    AsyncFile(AsyncFile&& src) : context(src.context), fd(src.fd) { src.fd = -1; }
+#endif
+    ~AsyncFile() { close(); }
+    
+    AsyncFile& operator =(const AsyncFile& src) = delete;
+    
+    // Any operation still pending on this file must finish before it is closed.
+    void close() noexcept {
+#if defined(CORECAT_OS_WINDOWS)
+        if(handle) handle.close();
+#else
+        if(fd >= 0) ::close(fd), fd = -1;
+#endif
+    }
+    
+    std::uint64_t getSize() const {
+#if defined(CORECAT_OS_WINDOWS)
+        LARGE_INTEGER size;
+        if(!::GetFileSizeEx(handle, &size))
+            throw IOException("::GetFileSizeEx failed");
+        return size.QuadPart;
+#else
+        struct stat st;
+        if(::fstat(fd, &st))
+            throw IOException("::fstat failed");
+        return std::uint64_t(st.st_size);
+#endif
+    }
+    
+    // The buffer must stay valid until the returned promise is settled.
+    Promise<std::size_t> read(void* buffer, std::size_t count, std::uint64_t offset) {
+        
+        return context->enqueue(OperationType::READ, getNativeHandle(), buffer, count, offset);
+        
+    }
+    Promise<std::size_t> write(const void* buffer, std::size_t count, std::uint64_t offset) {
+        
+        return context->enqueue(OperationType::WRITE, getNativeHandle(), const_cast<void*>(buffer), count, offset);
+        
+    }
+    // Transfers between the file and a buffer registered with AsyncFileContext::registerBuffers.
+    Promise<std::size_t> readFixed(std::size_t bufferIndex, std::size_t bufferOffset, std::size_t count, std::uint64_t offset) {
+        
+        return context->enqueue(OperationType::READ_FIXED, getNativeHandle(), getFixedBuffer(bufferIndex, bufferOffset, count), count, offset, bufferIndex);
+        
+    }
+    Promise<std::size_t> writeFixed(std::size_t bufferIndex, std::size_t bufferOffset, std::size_t count, std::uint64_t offset) {
+        
+        return context->enqueue(OperationType::WRITE_FIXED, getNativeHandle(), getFixedBuffer(bufferIndex, bufferOffset, count), count, offset, bufferIndex);
+        
+    }
+    
+};
+
+}
+}
+}
+
+
+#endif
@@ -30,6 +30,7 @@
 
 #include "DataView/DataView.hpp"
 
+#include "DataView/MappedDataView.hpp"
 #include "DataView/MemoryDataView.hpp"
 
 
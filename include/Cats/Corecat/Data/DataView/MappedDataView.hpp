@@ -0,0 +1,176 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2016-2018 The Cats Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef CATS_CORECAT_DATA_DATAVIEW_MAPPEDDATAVIEW_HPP
+#define CATS_CORECAT_DATA_DATAVIEW_MAPPEDDATAVIEW_HPP
+
+
+#include <cerrno>
+
+#include <algorithm>
+
+#include "DataView.hpp"
+#include "../../System/OS.hpp"
+#include "../../Text/String.hpp"
+#include "../../Util/Exception.hpp"
+
+#if defined(CORECAT_OS_WINDOWS)
+#   include "../../Win32/Handle.hpp"
+#else
+#   include <fcntl.h>
+#   include <unistd.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#endif
+
+
+namespace Cats {
+namespace Corecat {
+inline namespace Data {
+
+// A whole file mapped into memory. getData() exposes the mapping directly, so a file can be hashed or parsed
+// without copying it through a stream; the size is fixed at open time
+template <typename T>
+class MappedDataView : public DataView<T> {
+    
+private:
+    
+    T* data = nullptr;
+    std::size_t size = 0;
+    bool writable;
+    
+private:
+    
+    void unmap() noexcept {
+        
+        if(!data) return;
+#if defined(CORECAT_OS_WINDOWS)
+        ::UnmapViewOfFile(data);
+#else
+        ::munmap(data, size * sizeof(T));
+#endif
+        data = nullptr, size = 0;
+        
+    }
+    
+public:
+    
+    MappedDataView(const String8& path, bool writable_ = false) : writable(writable_) {
+        
+#if defined(CORECAT_OS_WINDOWS)
+        Handle file = ::CreateFileW(WString(path).getData(), writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ,
+            FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if(!file) throw IOException("::CreateFileW failed");
+        LARGE_INTEGER fileSize;
+        if(!::GetFileSizeEx(file, &fileSize))
+            throw IOException("::GetFileSizeEx failed");
+        size = std::size_t(fileSize.QuadPart) / sizeof(T);
+        if(!size) return;
+        Handle mapping = ::CreateFileMappingW(file, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY, 0, 0, nullptr);
+        if(!mapping) throw IOException("::CreateFileMappingW failed");
+        data = static_cast<T*>(::MapViewOfFile(mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, size * sizeof(T)));
+        if(!data) throw IOException("::MapViewOfFile failed");
+#else
+        int fd;
+        do
+            fd = ::open(path.getData(), (writable ? O_RDWR : O_RDONLY) | O_CLOEXEC);
+        while(fd < 0 && errno == EINTR);
+        if(fd < 0) throw IOException("::open failed");
+        struct stat st;
+        if(::fstat(fd, &st)) {
+            
+            ::close(fd);
+            throw IOException("::fstat failed");
+            
+        }
+        size = std::size_t(st.st_size) / sizeof(T);
+        void* p = nullptr;
+        if(size) p = ::mmap(nullptr, size * sizeof(T), writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if(p == MAP_FAILED) throw IOException("::mmap failed");
+        data = static_cast<T*>(p);
+#endif
+    
+    }
+    MappedDataView(const MappedDataView& src) = delete;
+    MappedDataView(MappedDataView&& src) : data(src.data), size(src.size), writable(src.writable) { src.data = nullptr, src.size = 0; }
+    ~MappedDataView() override { unmap(); }
+    
+    MappedDataView& operator =(const MappedDataView& src) = delete;
+    MappedDataView& operator =(MappedDataView&& src) {
+        
+        unmap();
+        data = src.data, size = src.size, writable = src.writable;
+        src.data = nullptr, src.size = 0;
+        return *this;
+        
+    }
+    
+    T* getData() noexcept { return data; }
+    const T* getData() const noexcept { return data; }
+    
+    bool isReadable() override { return true; }
+    bool isWritable() override { return writable; }
+    bool isResizable() override { return false; }
+    void read(T* buffer, std::size_t count, std::uint64_t offset) override {
+        
+        if(offset + count > getSize())
+            throw InvalidArgumentException("End of data");
+        std::copy(data + offset, data + offset + count, buffer);
+        
+    }
+    void write(const T* buffer, std::size_t count, std::uint64_t offset) override {
+        
+        if(!writable)
+            throw InvalidArgumentException("DataView is not writable");
+        if(offset + count > getSize())
+            throw InvalidArgumentException("End of data");
+        std::copy(buffer, buffer + count, data + offset);
+        
+    }
+    void flush() override {
+        
+        if(!data || !writable) return;
+#if defined(CORECAT_OS_WINDOWS)
+        if(!::FlushViewOfFile(data, 0))
+            throw IOException("::FlushViewOfFile failed");
+#else
+        if(::msync(data, size * sizeof(T), MS_SYNC))
+            throw IOException("::msync failed");
+#endif
+    
+    }
+    std::uint64_t getSize() override { return size; }
+    void setSize(std::uint64_t /*size*/) override { throw InvalidArgumentException("DataView is not resizable"); }
+    
+};
+
+}
+}
+}
+
+
+#endif
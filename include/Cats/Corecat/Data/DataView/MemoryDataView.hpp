@@ -73,7 +73,7 @@ public:
     }
     void flush() override {}
     std::uint64_t getSize() override { return size; }
-    void setSize(std::uint64_t size) override { throw InvalidArgumentException("DataView is not resizable"); }
+    void setSize(std::uint64_t /*size*/) override { throw InvalidArgumentException("DataView is not resizable"); }
     
 };
 
@@ -28,6 +28,11 @@
 #define CATS_CORECAT_DATA_DIGEST_HPP
 
 
+#include "Digest/BLAKE3.hpp"
+#include "Digest/CRC32C.hpp"
+#include "Digest/Digest.hpp"
+#include "Digest/SHA1.hpp"
+#include "Digest/SHA256.hpp"
 
 
 #endif
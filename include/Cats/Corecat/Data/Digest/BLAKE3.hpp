@@ -0,0 +1,410 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2016-2018 The Cats Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef CATS_CORECAT_DATA_DIGEST_BLAKE3_HPP
+#define CATS_CORECAT_DATA_DIGEST_BLAKE3_HPP
+
+
+#include <cstdint>
+#include <cstring>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "Digest.hpp"
+#include "../../Concurrent/ThreadPoolExecutor.hpp"
+#include "../../System/Architecture.hpp"
+#include "../../System/Compiler.hpp"
+#include "../../Util/Endian.hpp"
+
+#if defined(CORECAT_ARCHITECTURE_X86) || defined(CORECAT_ARCHITECTURE_X86_64)
+#   include <immintrin.h>
+#   include "../../X86/X86Feature.hpp"
+#endif
+
+
+namespace Cats {
+namespace Corecat {
+inline namespace Data {
+
+namespace Impl {
+
+// See https://github.com/BLAKE3-team/BLAKE3-specs
+struct BLAKE3Constant {
+    
+    static constexpr std::size_t BLOCK_LENGTH = 64;
+    static constexpr std::size_t CHUNK_LENGTH = 1024;
+    static constexpr std::uint32_t CHUNK_START = 1;
+    static constexpr std::uint32_t CHUNK_END = 2;
+    static constexpr std::uint32_t PARENT = 4;
+    static constexpr std::uint32_t ROOT = 8;
+    
+};
+
+constexpr std::uint32_t BLAKE3_IV[8] = {0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A, 0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19};
+constexpr unsigned char BLAKE3_SCHEDULE[7][16] = {
+    {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15},
+    {2, 6, 3, 10, 7, 0, 4, 13, 1, 11, 12, 5, 9, 14, 15, 8},
+    {3, 4, 10, 12, 13, 2, 7, 14, 6, 5, 9, 0, 11, 15, 8, 1},
+    {10, 7, 12, 9, 14, 3, 13, 15, 4, 0, 11, 2, 5, 8, 1, 6},
+    {12, 13, 9, 11, 15, 10, 14, 8, 7, 2, 5, 3, 0, 1, 6, 4},
+    {9, 14, 11, 5, 8, 12, 15, 1, 13, 3, 0, 10, 2, 6, 4, 7},
+    {11, 15, 5, 0, 1, 9, 8, 6, 14, 10, 2, 12, 3, 4, 7, 13},
+};
+
+using BLAKE3CV = std::array<std::uint32_t, 8>;
+
+inline void mixBLAKE3(std::uint32_t* v, std::size_t a, std::size_t b, std::size_t c, std::size_t d, std::uint32_t x, std::uint32_t y) noexcept {
+    
+    v[a] += v[b] + x, v[d] ^= v[a], v[d] = (v[d] >> 16) | (v[d] << 16);
+    v[c] += v[d], v[b] ^= v[c], v[b] = (v[b] >> 12) | (v[b] << 20);
+    v[a] += v[b] + y, v[d] ^= v[a], v[d] = (v[d] >> 8) | (v[d] << 24);
+    v[c] += v[d], v[b] ^= v[c], v[b] = (v[b] >> 7) | (v[b] << 25);
+    
+}
+// Compresses one 64-byte block into cv; the full 16-word output is only needed for extended output
+inline void compressBLAKE3(BLAKE3CV& cv, const unsigned char* block, std::uint64_t counter, std::uint32_t length, std::uint32_t flag) noexcept {
+    
+    std::uint32_t m[16], v[16];
+    for(std::size_t i = 0; i < 16; ++i) std::memcpy(m + i, block + i * 4, 4), m[i] = convertLittleToNative(m[i]);
+    std::copy(cv.begin(), cv.end(), v);
+    std::copy(BLAKE3_IV, BLAKE3_IV + 4, v + 8);
+    v[12] = std::uint32_t(counter), v[13] = std::uint32_t(counter >> 32), v[14] = length, v[15] = flag;
+    for(auto& s : BLAKE3_SCHEDULE) {
+        
+        mixBLAKE3(v, 0, 4, 8, 12, m[s[0]], m[s[1]]);
+        mixBLAKE3(v, 1, 5, 9, 13, m[s[2]], m[s[3]]);
+        mixBLAKE3(v, 2, 6, 10, 14, m[s[4]], m[s[5]]);
+        mixBLAKE3(v, 3, 7, 11, 15, m[s[6]], m[s[7]]);
+        mixBLAKE3(v, 0, 5, 10, 15, m[s[8]], m[s[9]]);
+        mixBLAKE3(v, 1, 6, 11, 12, m[s[10]], m[s[11]]);
+        mixBLAKE3(v, 2, 7, 8, 13, m[s[12]], m[s[13]]);
+        mixBLAKE3(v, 3, 4, 9, 14, m[s[14]], m[s[15]]);
+        
+    }
+    for(std::size_t i = 0; i < 8; ++i) cv[i] = v[i] ^ v[i + 8];
+    
+}
+// Hashes a chunk of at most 1024 bytes; flag is added to the last block (ROOT for a single-chunk message)
+inline BLAKE3CV hashChunkBLAKE3(const unsigned char* p, std::size_t size, std::uint64_t counter, std::uint32_t flag = 0) noexcept {
+    
+    using C = BLAKE3Constant;
+    
+    BLAKE3CV cv;
+    std::copy(BLAKE3_IV, BLAKE3_IV + 8, cv.begin());
+    std::uint32_t start = C::CHUNK_START;
+    for(; size > C::BLOCK_LENGTH; size -= C::BLOCK_LENGTH, p += C::BLOCK_LENGTH, start = 0)
+        compressBLAKE3(cv, p, counter, C::BLOCK_LENGTH, start);
+    unsigned char block[C::BLOCK_LENGTH] = {};
+    if(size) std::memcpy(block, p, size);
+    compressBLAKE3(cv, block, counter, std::uint32_t(size), start | C::CHUNK_END | flag);
+    return cv;
+    
+}
+inline BLAKE3CV hashParentBLAKE3(const BLAKE3CV& left, const BLAKE3CV& right, std::uint32_t flag = 0) noexcept {
+    
+    unsigned char block[64];
+    for(std::size_t i = 0; i < 8; ++i) {
+        
+        auto l = convertNativeToLittle(left[i]), r = convertNativeToLittle(right[i]);
+        std::memcpy(block + i * 4, &l, 4);
+        std::memcpy(block + 32 + i * 4, &r, 4);
+        
+    }
+    BLAKE3CV cv;
+    std::copy(BLAKE3_IV, BLAKE3_IV + 8, cv.begin());
+    compressBLAKE3(cv, block, 0, 64, BLAKE3Constant::PARENT | flag);
+    return cv;
+    
+}
+
+#if defined(CORECAT_ARCHITECTURE_X86) || defined(CORECAT_ARCHITECTURE_X86_64)
+CORECAT_TARGET("avx2") inline __m256i rotateRightBLAKE3x8(__m256i x, int n) noexcept {
+    
+    return _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - n));
+    
+}
+CORECAT_TARGET("avx2") inline void mixBLAKE3x8(__m256i* v, std::size_t a, std::size_t b, std::size_t c, std::size_t d, __m256i x, __m256i y) noexcept {
+    
+    const __m256i ROTATE16 = _mm256_setr_epi8(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13, 2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13);
+    const __m256i ROTATE8 = _mm256_setr_epi8(1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12, 1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12);
+    v[a] = _mm256_add_epi32(_mm256_add_epi32(v[a], v[b]), x), v[d] = _mm256_shuffle_epi8(_mm256_xor_si256(v[d], v[a]), ROTATE16);
+    v[c] = _mm256_add_epi32(v[c], v[d]), v[b] = rotateRightBLAKE3x8(_mm256_xor_si256(v[b], v[c]), 12);
+    v[a] = _mm256_add_epi32(_mm256_add_epi32(v[a], v[b]), y), v[d] = _mm256_shuffle_epi8(_mm256_xor_si256(v[d], v[a]), ROTATE8);
+    v[c] = _mm256_add_epi32(v[c], v[d]), v[b] = rotateRightBLAKE3x8(_mm256_xor_si256(v[b], v[c]), 7);
+    
+}
+// Eight consecutive whole chunks at once, one per 32-bit lane
+CORECAT_TARGET("avx2") inline void hashChunkBLAKE3x8AVX2(const unsigned char* p, std::uint64_t counter, BLAKE3CV* cv) noexcept {
+    
+    using C = BLAKE3Constant;
+    
+    const __m256i INDEX = _mm256_setr_epi32(0, 256, 512, 768, 1024, 1280, 1536, 1792);
+    __m256i h[8];
+    for(std::size_t i = 0; i < 8; ++i) h[i] = _mm256_set1_epi32(int(BLAKE3_IV[i]));
+    std::uint32_t low[8], high[8];
+    for(std::size_t j = 0; j < 8; ++j) low[j] = std::uint32_t(counter + j), high[j] = std::uint32_t((counter + j) >> 32);
+    __m256i counterLow = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(low));
+    __m256i counterHigh = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(high));
+    for(std::size_t b = 0; b < 16; ++b) {
+        
+        __m256i m[16], v[16];
+        for(std::size_t i = 0; i < 16; ++i)
+            m[i] = _mm256_i32gather_epi32(reinterpret_cast<const int*>(p + b * C::BLOCK_LENGTH + i * 4), INDEX, 4);
+        for(std::size_t i = 0; i < 8; ++i) v[i] = h[i];
+        for(std::size_t i = 0; i < 4; ++i) v[i + 8] = _mm256_set1_epi32(int(BLAKE3_IV[i]));
+        v[12] = counterLow, v[13] = counterHigh, v[14] = _mm256_set1_epi32(int(C::BLOCK_LENGTH));
+        v[15] = _mm256_set1_epi32(int((b == 0 ? C::CHUNK_START : 0) | (b == 15 ? C::CHUNK_END : 0)));
+        for(auto& s : BLAKE3_SCHEDULE) {
+            
+            mixBLAKE3x8(v, 0, 4, 8, 12, m[s[0]], m[s[1]]);
+            mixBLAKE3x8(v, 1, 5, 9, 13, m[s[2]], m[s[3]]);
+            mixBLAKE3x8(v, 2, 6, 10, 14, m[s[4]], m[s[5]]);
+            mixBLAKE3x8(v, 3, 7, 11, 15, m[s[6]], m[s[7]]);
+            mixBLAKE3x8(v, 0, 5, 10, 15, m[s[8]], m[s[9]]);
+            mixBLAKE3x8(v, 1, 6, 11, 12, m[s[10]], m[s[11]]);
+            mixBLAKE3x8(v, 2, 7, 8, 13, m[s[12]], m[s[13]]);
+            mixBLAKE3x8(v, 3, 4, 9, 14, m[s[14]], m[s[15]]);
+            
+        }
+        for(std::size_t i = 0; i < 8; ++i) h[i] = _mm256_xor_si256(v[i], v[i + 8]);
+        
+    }
+    alignas(32) std::uint32_t out[8][8];
+    for(std::size_t i = 0; i < 8; ++i) _mm256_store_si256(reinterpret_cast<__m256i*>(out[i]), h[i]);
+    for(std::size_t j = 0; j < 8; ++j)
+        for(std::size_t i = 0; i < 8; ++i) cv[j][i] = out[i][j];
+        
+}
+#endif
+
+// Chaining values of count whole chunks starting at chunk number counter
+inline void hashChunkBLAKE3(const unsigned char* p, std::size_t count, std::uint64_t counter, BLAKE3CV* cv) noexcept {
+    
+    using C = BLAKE3Constant;
+    
+#if defined(CORECAT_ARCHITECTURE_X86) || defined(CORECAT_ARCHITECTURE_X86_64)
+    if(X86Feature::AVX2)
+        for(; count >= 8; count -= 8, p += C::CHUNK_LENGTH * 8, counter += 8, cv += 8) hashChunkBLAKE3x8AVX2(p, counter, cv);
+#endif
+    for(; count; --count, p += C::CHUNK_LENGTH, ++counter, ++cv) *cv = hashChunkBLAKE3(p, C::CHUNK_LENGTH, counter);
+    
+}
+
+// Reduces the chaining values of count consecutive subtrees to their parent, splitting at the largest power of two
+// below count as the tree layout requires; every subtree but the last must hold the same power-of-two chunk count
+inline BLAKE3CV mergeBLAKE3(const BLAKE3CV* cv, std::size_t count, std::uint32_t flag = 0) noexcept {
+    
+    if(count == 1) return *cv;
+    std::size_t left = 1;
+    while(left * 2 < count) left *= 2;
+    return hashParentBLAKE3(mergeBLAKE3(cv, left), mergeBLAKE3(cv + left, count - left), flag);
+    
+}
+
+// Chaining values of the chunks in [p, p + size), the last of which may be partial
+inline std::vector<BLAKE3CV> hashSubtreeBLAKE3(const unsigned char* p, std::size_t size, std::uint64_t counter) {
+    
+    using C = BLAKE3Constant;
+    
+    std::size_t full = size / C::CHUNK_LENGTH, rest = size % C::CHUNK_LENGTH;
+    std::vector<BLAKE3CV> cv(full + (rest ? 1 : 0));
+    hashChunkBLAKE3(p, full, counter, cv.data());
+    if(rest) cv[full] = hashChunkBLAKE3(p + full * C::CHUNK_LENGTH, rest, counter + full);
+    return cv;
+    
+}
+
+}
+
+// BLAKE3 in its default hashing mode with a 32-byte output. Chunks are hashed eight at a time with AVX2 when possible;
+// hash() can additionally spread a large buffer over a ThreadPoolExecutor
+class BLAKE3 final : public Digest<std::array<Byte, 32>> {
+    
+private:
+    
+    using C = Impl::BLAKE3Constant;
+    using CV = Impl::BLAKE3CV;
+    
+    // Each task reduces this many chunks (512 KiB) to one chaining value
+    static constexpr std::size_t TASK_CHUNK = 512;
+    
+private:
+    
+    CV stack[54];
+    std::size_t stackSize;
+    std::uint64_t chunkCounter;
+    unsigned char chunk[C::CHUNK_LENGTH];
+    std::size_t chunkSize;
+    
+private:
+    
+    // The chunk count after cv is even once for every subtree that cv completes
+    void pushChunk(CV cv, std::uint64_t total) {
+        
+        for(; !(total & 1); total >>= 1) cv = Impl::hashParentBLAKE3(stack[--stackSize], cv);
+        stack[stackSize++] = cv;
+        
+    }
+    
+    static Type output(const CV& cv) {
+        
+        Type ret;
+        for(std::size_t i = 0; i < 8; ++i) {
+            
+            auto x = convertNativeToLittle(cv[i]);
+            std::memcpy(ret.data() + i * 4, &x, 4);
+            
+        }
+        return ret;
+        
+    }
+    
+public:
+    
+    BLAKE3() { reset(); }
+    
+    void update(ArrayView<const Byte> data) override {
+        
+        auto p = reinterpret_cast<const unsigned char*>(data.getData());
+        auto size = data.getSize();
+        while(size) {
+            
+            // A full chunk is only hashed once more input shows it is not the last one
+            if(chunkSize == C::CHUNK_LENGTH) {
+                
+                pushChunk(Impl::hashChunkBLAKE3(chunk, C::CHUNK_LENGTH, chunkCounter), chunkCounter + 1);
+                ++chunkCounter, chunkSize = 0;
+                
+            }
+            if(!chunkSize && size > C::CHUNK_LENGTH) {
+                
+                CV cv[64];
+                std::size_t count = std::min<std::size_t>((size - 1) / C::CHUNK_LENGTH, 64);
+                Impl::hashChunkBLAKE3(p, count, chunkCounter, cv);
+                for(std::size_t i = 0; i < count; ++i) pushChunk(cv[i], ++chunkCounter);
+                p += count * C::CHUNK_LENGTH, size -= count * C::CHUNK_LENGTH;
+                continue;
+                
+            }
+            std::size_t x = std::min(size, C::CHUNK_LENGTH - chunkSize);
+            std::memcpy(chunk + chunkSize, p, x);
+            chunkSize += x, p += x, size -= x;
+            
+        }
+        
+    }
+    Type finish() override {
+        
+        CV cv;
+        if(!stackSize) cv = Impl::hashChunkBLAKE3(chunk, chunkSize, chunkCounter, C::ROOT);
+        else {
+            
+            cv = Impl::hashChunkBLAKE3(chunk, chunkSize, chunkCounter);
+            for(std::size_t i = stackSize - 1; i; --i) cv = Impl::hashParentBLAKE3(stack[i], cv);
+            cv = Impl::hashParentBLAKE3(stack[0], cv, C::ROOT);
+            
+        }
+        reset();
+        return output(cv);
+        
+    }
+    void reset() override { stackSize = 0, chunkCounter = 0, chunkSize = 0; }
+    
+    // One-shot hash. With an executor the input is cut into 512 KiB subtrees that are hashed in parallel, and only the
+    // few parent nodes above them are left to the calling thread
+    static Type hash(ArrayView<const Byte> data, ThreadPoolExecutor* executor = nullptr) {
+        
+        auto p = reinterpret_cast<const unsigned char*>(data.getData());
+        auto size = data.getSize();
+        if(size <= C::CHUNK_LENGTH) return output(Impl::hashChunkBLAKE3(p, size, 0, C::ROOT));
+        
+        constexpr std::size_t TASK_SIZE = TASK_CHUNK * C::CHUNK_LENGTH;
+        std::size_t taskCount = (size + TASK_SIZE - 1) / TASK_SIZE;
+        if(!executor || taskCount == 1) {
+            
+            auto cv = Impl::hashSubtreeBLAKE3(p, size, 0);
+            return output(Impl::mergeBLAKE3(cv.data(), cv.size(), C::ROOT));
+            
+        }
+        
+        // Kept alive by the tasks, which may start only after the last subtree is done
+        struct Shared {
+            
+            std::vector<CV> cv;
+            std::atomic<std::size_t> next = {0};
+            std::size_t done = 0;
+            std::exception_ptr error;
+            std::mutex mutex;
+            std::condition_variable condition;
+                
+        };
+        auto shared = std::make_shared<Shared>();
+        shared->cv.resize(taskCount);
+        // Hashes subtrees until none is left unclaimed. The calling thread runs it too, so the hash completes even with
+        // no pool thread free, as when it is called from one.
+        auto work = [shared, p, size, taskCount] {
+                
+            for(std::size_t i; (i = shared->next++) < taskCount; ) {
+            
+                std::exception_ptr error;
+                try {
+                    
+                    auto begin = i * TASK_SIZE, end = std::min(begin + TASK_SIZE, size);
+                    auto leaf = Impl::hashSubtreeBLAKE3(p + begin, end - begin, i * TASK_CHUNK);
+                    shared->cv[i] = Impl::mergeBLAKE3(leaf.data(), leaf.size());
+                    
+                } catch(...) { error = std::current_exception(); }
+                std::lock_guard<std::mutex> lock(shared->mutex);
+                if(error) shared->error = error;
+                if(++shared->done == taskCount) shared->condition.notify_all();
+                
+            }
+            
+        };
+        for(std::size_t i = 1; i < taskCount; ++i) executor->execute(work);
+        work();
+        std::unique_lock<std::mutex> lock(shared->mutex);
+        shared->condition.wait(lock, [&] { return shared->done == taskCount; });
+        if(shared->error) std::rethrow_exception(shared->error);
+        return output(Impl::mergeBLAKE3(shared->cv.data(), shared->cv.size(), C::ROOT));
+        
+    }
+    
+};
+
+}
+}
+}
+
+
+#endif
@@ -0,0 +1,237 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2016-2018 The Cats Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef CATS_CORECAT_DATA_DIGEST_CRC32C_HPP
+#define CATS_CORECAT_DATA_DIGEST_CRC32C_HPP
+
+
+#include <cstdint>
+#include <cstring>
+
+#include "Digest.hpp"
+#include "../../System/Architecture.hpp"
+#include "../../System/Compiler.hpp"
+#include "../../Util/Endian.hpp"
+
+#if defined(CORECAT_ARCHITECTURE_X86) || defined(CORECAT_ARCHITECTURE_X86_64)
+#   include <immintrin.h>
+#   include "../../X86/X86Feature.hpp"
+#endif
+
+
+namespace Cats {
+namespace Corecat {
+inline namespace Data {
+
+namespace Impl {
+
+// Tables for the portable slicing-by-8 update, and for shifting a CRC past LONG or SHORT zero bytes, which is how the
+// three interleaved hardware streams are merged (see Mark Adler's crc32c.c)
+struct CRC32CTable {
+    
+    static constexpr std::uint32_t POLYNOMIAL = 0x82F63B78;
+    static constexpr std::size_t LONG = 8192;
+    static constexpr std::size_t SHORT = 256;
+    
+    std::uint32_t slice[8][256];
+    std::uint32_t shiftLong[4][256];
+    std::uint32_t shiftShort[4][256];
+    
+    static std::uint32_t multiply(const std::uint32_t* matrix, std::uint32_t vector) noexcept {
+        
+        std::uint32_t sum = 0;
+        for(; vector; vector >>= 1, ++matrix) if(vector & 1) sum ^= *matrix;
+        return sum;
+        
+    }
+    static void square(std::uint32_t* dst, const std::uint32_t* src) noexcept {
+        
+        for(std::size_t i = 0; i < 32; ++i) dst[i] = multiply(src, src[i]);
+        
+    }
+    static void createShift(std::uint32_t (&table)[4][256], std::size_t length) noexcept {
+        
+        // Operator for one zero bit, squared up to length zero bytes
+        std::uint32_t odd[32], even[32];
+        odd[0] = POLYNOMIAL;
+        for(std::size_t i = 1; i < 32; ++i) odd[i] = std::uint32_t(1) << (i - 1);
+        square(even, odd);
+        square(odd, even);
+        const std::uint32_t* op;
+        while(true) {
+            
+            square(even, odd);
+            length >>= 1;
+            if(!length) { op = even; break; }
+            square(odd, even);
+            length >>= 1;
+            if(!length) { op = odd; break; }
+            
+        }
+        for(std::uint32_t i = 0; i < 256; ++i)
+            for(std::size_t j = 0; j < 4; ++j) table[j][i] = multiply(op, i << (j * 8));
+            
+    }
+    
+    CRC32CTable() noexcept {
+        
+        for(std::uint32_t i = 0; i < 256; ++i) {
+            
+            std::uint32_t x = i;
+            for(std::size_t j = 0; j < 8; ++j) x = (x >> 1) ^ (POLYNOMIAL & (0 - (x & 1)));
+            slice[0][i] = x;
+            
+        }
+        for(std::size_t i = 0; i < 256; ++i)
+            for(std::size_t j = 1; j < 8; ++j) slice[j][i] = (slice[j - 1][i] >> 8) ^ slice[0][slice[j - 1][i] & 0xFF];
+        createShift(shiftLong, LONG);
+        createShift(shiftShort, SHORT);
+        
+    }
+    
+    static const CRC32CTable& get() { static const CRC32CTable table; return table; }
+    
+};
+
+// crc is the raw register, i.e. without the final inversion
+inline std::uint32_t updateCRC32CSoftware(std::uint32_t crc, const unsigned char* p, std::size_t size) noexcept {
+    
+    auto& t = CRC32CTable::get().slice;
+    for(; size && (reinterpret_cast<std::uintptr_t>(p) & 7); --size) crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xFF];
+    for(; size >= 8; size -= 8, p += 8) {
+        
+        std::uint32_t a, b;
+        std::memcpy(&a, p, 4);
+        std::memcpy(&b, p + 4, 4);
+        a = convertNativeToLittle(a) ^ crc;
+        b = convertNativeToLittle(b);
+        crc = t[7][a & 0xFF] ^ t[6][(a >> 8) & 0xFF] ^ t[5][(a >> 16) & 0xFF] ^ t[4][a >> 24]
+            ^ t[3][b & 0xFF] ^ t[2][(b >> 8) & 0xFF] ^ t[1][(b >> 16) & 0xFF] ^ t[0][b >> 24];
+            
+    }
+    for(; size; --size) crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xFF];
+    return crc;
+    
+}
+
+#if defined(CORECAT_ARCHITECTURE_X86) || defined(CORECAT_ARCHITECTURE_X86_64)
+inline std::uint32_t shiftCRC32C(const std::uint32_t (&table)[4][256], std::uint32_t crc) noexcept {
+    
+    return table[0][crc & 0xFF] ^ table[1][(crc >> 8) & 0xFF] ^ table[2][(crc >> 16) & 0xFF] ^ table[3][crc >> 24];
+    
+}
+#   if defined(CORECAT_ARCHITECTURE_X86_64)
+using CRC32CWord = std::uint64_t;
+CORECAT_TARGET("sse4.2") inline std::uint32_t updateCRC32CWord(std::uint32_t crc, const unsigned char* p) noexcept {
+    
+    std::uint64_t x;
+    std::memcpy(&x, p, 8);
+    return std::uint32_t(_mm_crc32_u64(crc, x));
+    
+}
+#   else
+using CRC32CWord = std::uint32_t;
+CORECAT_TARGET("sse4.2") inline std::uint32_t updateCRC32CWord(std::uint32_t crc, const unsigned char* p) noexcept {
+    
+    std::uint32_t x;
+    std::memcpy(&x, p, 4);
+    return _mm_crc32_u32(crc, x);
+    
+}
+#   endif
+// Three independent crc32 chains hide the instruction's 3-cycle latency
+template <std::size_t L>
+CORECAT_TARGET("sse4.2") inline std::uint32_t updateCRC32CInterleave(std::uint32_t crc, const unsigned char*& p, std::size_t& size,
+    const std::uint32_t (&table)[4][256]) noexcept {
+        
+    for(; size >= L * 3; size -= L * 3, p += L * 3) {
+        
+        std::uint32_t crc1 = 0, crc2 = 0;
+        for(auto q = p, end = p + L; q != end; q += sizeof(CRC32CWord)) {
+            
+            crc = updateCRC32CWord(crc, q);
+            crc1 = updateCRC32CWord(crc1, q + L);
+            crc2 = updateCRC32CWord(crc2, q + L * 2);
+            
+        }
+        crc = shiftCRC32C(table, crc) ^ crc1;
+        crc = shiftCRC32C(table, crc) ^ crc2;
+        
+    }
+    return crc;
+    
+}
+CORECAT_TARGET("sse4.2") inline std::uint32_t updateCRC32CSSE42(std::uint32_t crc, const unsigned char* p, std::size_t size) noexcept {
+    
+    for(; size && (reinterpret_cast<std::uintptr_t>(p) & (sizeof(CRC32CWord) - 1)); --size) crc = _mm_crc32_u8(crc, *p++);
+    auto& t = CRC32CTable::get();
+    crc = updateCRC32CInterleave<CRC32CTable::LONG>(crc, p, size, t.shiftLong);
+    crc = updateCRC32CInterleave<CRC32CTable::SHORT>(crc, p, size, t.shiftShort);
+    for(; size >= sizeof(CRC32CWord); size -= sizeof(CRC32CWord), p += sizeof(CRC32CWord)) crc = updateCRC32CWord(crc, p);
+    for(; size; --size) crc = _mm_crc32_u8(crc, *p++);
+    return crc;
+    
+}
+#endif
+
+inline std::uint32_t updateCRC32C(std::uint32_t crc, const unsigned char* p, std::size_t size) noexcept {
+    
+#if defined(CORECAT_ARCHITECTURE_X86) || defined(CORECAT_ARCHITECTURE_X86_64)
+    if(X86Feature::SSE4_2) return updateCRC32CSSE42(crc, p, size);
+#endif
+    return updateCRC32CSoftware(crc, p, size);
+    
+}
+
+}
+
+// CRC-32C (Castagnoli), as used by iSCSI, ext4 and SSE4.2
+class CRC32C final : public Digest<std::uint32_t> {
+    
+private:
+    
+    std::uint32_t crc = 0xFFFFFFFF;
+    
+public:
+    
+    CRC32C() = default;
+    
+    void update(ArrayView<const Byte> data) override {
+        
+        crc = Impl::updateCRC32C(crc, reinterpret_cast<const unsigned char*>(data.getData()), data.getSize());
+        
+    }
+    std::uint32_t finish() override { auto ret = ~crc; crc = 0xFFFFFFFF; return ret; }
+    void reset() override { crc = 0xFFFFFFFF; }
+    
+};
+
+}
+}
+}
+
+
+#endif
@@ -28,6 +28,100 @@
 #define CATS_CORECAT_DATA_DIGEST_DIGEST_HPP
 
 
+#include <cstdint>
+#include <cstring>
+
+#include "../Array.hpp"
+#include "../../Util/Byte.hpp"
+
+
+namespace Cats {
+namespace Corecat {
+inline namespace Data {
+
+// Incremental message digest. finish() returns the digest of everything passed to update() since construction or the
+// last finish() / reset(), and leaves the digest ready for a new message
+template <typename T>
+class Digest {
+    
+public:
+    
+    using Type = T;
+    
+public:
+    
+    Digest() = default;
+    Digest(const Digest& src) = default;
+    virtual ~Digest() = default;
+    
+    Digest& operator =(const Digest& src) = default;
+    
+    virtual void update(ArrayView<const Byte> data) = 0;
+    virtual T finish() = 0;
+    virtual void reset() = 0;
+    
+};
+
+namespace Impl {
+
+// Cuts the input of a Merkle-Damgard hash (SHA-1, SHA-256) into 64-byte blocks and appends its padding and
+// big-endian bit length; F is called as f(const unsigned char* block, std::size_t count)
+class DigestBlockBuffer {
+    
+private:
+    
+    unsigned char data[64];
+    std::size_t size = 0;
+    std::uint64_t length = 0;
+    
+public:
+    
+    template <typename F>
+    void update(const unsigned char* p, std::size_t count, F&& f) {
+        
+        length += count;
+        if(size) {
+            
+            std::size_t x = count < 64 - size ? count : 64 - size;
+            std::memcpy(data + size, p, x);
+            size += x, p += x, count -= x;
+            if(size < 64) return;
+            f(data, 1);
+            size = 0;
+            
+        }
+        if(count >= 64) f(p, count / 64), p += count / 64 * 64, count %= 64;
+        std::memcpy(data + size, p, count);
+        size += count;
+        
+    }
+    template <typename F>
+    void finish(F&& f) {
+        
+        std::uint64_t bit = length * 8;
+        data[size++] = 0x80;
+        if(size > 56) {
+            
+            std::memset(data + size, 0, 64 - size);
+            f(data, 1);
+            size = 0;
+            
+        }
+        std::memset(data + size, 0, 56 - size);
+        for(std::size_t i = 0; i < 8; ++i) data[56 + i] = static_cast<unsigned char>(bit >> (56 - i * 8));
+        f(data, 1);
+        reset();
+        
+    }
+    void reset() noexcept { size = 0, length = 0; }
+    
+};
+
+}
+
+}
+}
+}
 
 
 #endif
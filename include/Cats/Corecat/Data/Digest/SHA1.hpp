@@ -0,0 +1,181 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2016-2018 The Cats Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef CATS_CORECAT_DATA_DIGEST_SHA1_HPP
+#define CATS_CORECAT_DATA_DIGEST_SHA1_HPP
+
+
+#include <cstdint>
+
+#include <algorithm>
+#include <array>
+#include <utility>
+
+#include "Digest.hpp"
+#include "SHA256.hpp"
+#include "../../System/Architecture.hpp"
+#include "../../System/Compiler.hpp"
+
+#if defined(CORECAT_ARCHITECTURE_X86) || defined(CORECAT_ARCHITECTURE_X86_64)
+#   include <immintrin.h>
+#   include "../../X86/X86Feature.hpp"
+#endif
+
+
+namespace Cats {
+namespace Corecat {
+inline namespace Data {
+
+namespace Impl {
+
+constexpr std::uint32_t SHA1_H[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+
+inline std::uint32_t rotateLeft32(std::uint32_t x, int n) noexcept { return (x << n) | (x >> (32 - n)); }
+
+inline void transformSHA1Software(std::uint32_t* state, const unsigned char* p, std::size_t count) noexcept {
+    
+    for(; count; --count, p += 64) {
+        
+        std::uint32_t w[80];
+        for(std::size_t i = 0; i < 16; ++i) w[i] = loadBigEndian32(p + i * 4);
+        for(std::size_t i = 16; i < 80; ++i) w[i] = rotateLeft32(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+        auto a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+        for(std::size_t i = 0; i < 80; ++i) {
+            
+            std::uint32_t f, k;
+            if(i < 20) f = (b & c) | (~b & d), k = 0x5A827999;
+            else if(i < 40) f = b ^ c ^ d, k = 0x6ED9EBA1;
+            else if(i < 60) f = (b & c) | (b & d) | (c & d), k = 0x8F1BBCDC;
+            else f = b ^ c ^ d, k = 0xCA62C1D6;
+            auto t = rotateLeft32(a, 5) + f + e + k + w[i];
+            e = d, d = c, c = rotateLeft32(b, 30), b = a, a = t;
+            
+        }
+        state[0] += a, state[1] += b, state[2] += c, state[3] += d, state[4] += e;
+        
+    }
+    
+}
+
+#if defined(CORECAT_ARCHITECTURE_X86) || defined(CORECAT_ARCHITECTURE_X86_64)
+// Rounds 4 * I to 4 * I + 3; e[0] and e[1] take turns carrying E, and m[] holds the message words four steps ahead
+template <std::size_t I>
+CORECAT_TARGET("sha,sse4.1") inline void roundSHA1SHA(__m128i& abcd, __m128i (&e)[2], __m128i (&m)[4]) noexcept {
+    
+    auto& x = e[I & 1];
+    if(I == 0) x = _mm_add_epi32(x, m[0]);
+    else x = _mm_sha1nexte_epu32(x, m[I & 3]);
+    e[(I + 1) & 1] = abcd;
+    if(I >= 3 && I <= 18) m[(I + 1) & 3] = _mm_sha1msg2_epu32(m[(I + 1) & 3], m[I & 3]);
+    abcd = _mm_sha1rnds4_epu32(abcd, x, I / 5);
+    if(I >= 1 && I <= 16) m[(I - 1) & 3] = _mm_sha1msg1_epu32(m[(I - 1) & 3], m[I & 3]);
+    if(I >= 2 && I <= 17) m[(I - 2) & 3] = _mm_xor_si128(m[(I - 2) & 3], m[I & 3]);
+    
+}
+template <std::size_t... I>
+CORECAT_TARGET("sha,sse4.1") inline void roundSHA1SHA(__m128i& abcd, __m128i (&e)[2], __m128i (&m)[4], std::index_sequence<I...>) noexcept {
+    
+    int expand[] = {(roundSHA1SHA<I>(abcd, e, m), 0)...};
+    (void)expand;
+    
+}
+CORECAT_TARGET("sha,sse4.1") inline void transformSHA1SHA(std::uint32_t* state, const unsigned char* p, std::size_t count) noexcept {
+    
+    const __m128i MASK = _mm_set_epi64x(0x0001020304050607ULL, 0x08090A0B0C0D0E0FULL);
+    __m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0x1B);
+    __m128i e0 = _mm_set_epi32(int(state[4]), 0, 0, 0);
+    for(; count; --count, p += 64) {
+        
+        __m128i saveABCD = abcd, saveE = e0;
+        __m128i m[4], e[2] = {e0, _mm_setzero_si128()};
+        for(std::size_t i = 0; i < 4; ++i) m[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i * 16)), MASK);
+        roundSHA1SHA(abcd, e, m, std::make_index_sequence<20>());
+        e0 = _mm_sha1nexte_epu32(e[0], saveE);
+        abcd = _mm_add_epi32(abcd, saveABCD);
+        
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state), _mm_shuffle_epi32(abcd, 0x1B));
+    state[4] = std::uint32_t(_mm_extract_epi32(e0, 3));
+    
+}
+#endif
+
+inline void transformSHA1(std::uint32_t* state, const unsigned char* p, std::size_t count) noexcept {
+    
+#if defined(CORECAT_ARCHITECTURE_X86) || defined(CORECAT_ARCHITECTURE_X86_64)
+    if(X86Feature::SHA && X86Feature::SSE4_1) return transformSHA1SHA(state, p, count);
+#endif
+    transformSHA1Software(state, p, count);
+    
+}
+
+}
+
+// Only for interoperating with existing formats: SHA-1 is no longer collision resistant
+class SHA1 final : public Digest<std::array<Byte, 20>> {
+    
+private:
+    
+    std::uint32_t state[5];
+    Impl::DigestBlockBuffer buffer;
+    
+public:
+    
+    SHA1() { reset(); }
+    
+    void update(ArrayView<const Byte> data) override {
+        
+        buffer.update(reinterpret_cast<const unsigned char*>(data.getData()), data.getSize(),
+            [&](const unsigned char* p, std::size_t count) { Impl::transformSHA1(state, p, count); });
+            
+    }
+    Type finish() override {
+        
+        buffer.finish([&](const unsigned char* p, std::size_t count) { Impl::transformSHA1(state, p, count); });
+        Type ret;
+        for(std::size_t i = 0; i < 5; ++i) Impl::storeBigEndian32(reinterpret_cast<unsigned char*>(ret.data()) + i * 4, state[i]);
+        reset();
+        return ret;
+        
+    }
+    void reset() override { std::copy(Impl::SHA1_H, Impl::SHA1_H + 5, state), buffer.reset(); }
+    
+    static Type hash(ArrayView<const Byte> data) {
+        
+        SHA1 sha;
+        sha.update(data);
+        return sha.finish();
+        
+    }
+    
+};
+
+}
+}
+}
+
+
+#endif
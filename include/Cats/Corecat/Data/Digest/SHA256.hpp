@@ -0,0 +1,294 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2016-2018 The Cats Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef CATS_CORECAT_DATA_DIGEST_SHA256_HPP
+#define CATS_CORECAT_DATA_DIGEST_SHA256_HPP
+
+
+#include <cstdint>
+#include <cstring>
+
+#include <algorithm>
+#include <array>
+
+#include "Digest.hpp"
+#include "../../System/Architecture.hpp"
+#include "../../System/Compiler.hpp"
+
+#if defined(CORECAT_ARCHITECTURE_X86) || defined(CORECAT_ARCHITECTURE_X86_64)
+#   include <immintrin.h>
+#   include "../../X86/X86Feature.hpp"
+#endif
+
+
+namespace Cats {
+namespace Corecat {
+inline namespace Data {
+
+namespace Impl {
+
+alignas(16) constexpr std::uint32_t SHA256_K[64] = {
+    0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5, 0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+    0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3, 0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+    0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC, 0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+    0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7, 0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+    0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13, 0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+    0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3, 0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+    0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5, 0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+    0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208, 0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2,
+};
+constexpr std::uint32_t SHA256_H[8] = {0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A, 0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19};
+
+inline std::uint32_t loadBigEndian32(const unsigned char* p) noexcept {
+    
+    return (std::uint32_t(p[0]) << 24) | (std::uint32_t(p[1]) << 16) | (std::uint32_t(p[2]) << 8) | std::uint32_t(p[3]);
+    
+}
+inline void storeBigEndian32(unsigned char* p, std::uint32_t x) noexcept {
+    
+    p[0] = static_cast<unsigned char>(x >> 24), p[1] = static_cast<unsigned char>(x >> 16);
+    p[2] = static_cast<unsigned char>(x >> 8), p[3] = static_cast<unsigned char>(x);
+    
+}
+inline std::uint32_t rotateRight32(std::uint32_t x, int n) noexcept { return (x >> n) | (x << (32 - n)); }
+
+inline void transformSHA256Software(std::uint32_t* state, const unsigned char* p, std::size_t count) noexcept {
+    
+    for(; count; --count, p += 64) {
+        
+        std::uint32_t w[64];
+        for(std::size_t i = 0; i < 16; ++i) w[i] = loadBigEndian32(p + i * 4);
+        for(std::size_t i = 16; i < 64; ++i) {
+            
+            auto s0 = rotateRight32(w[i - 15], 7) ^ rotateRight32(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            auto s1 = rotateRight32(w[i - 2], 17) ^ rotateRight32(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+            
+        }
+        auto a = state[0], b = state[1], c = state[2], d = state[3], e = state[4], f = state[5], g = state[6], h = state[7];
+        for(std::size_t i = 0; i < 64; ++i) {
+            
+            auto t1 = h + (rotateRight32(e, 6) ^ rotateRight32(e, 11) ^ rotateRight32(e, 25)) + ((e & f) ^ (~e & g)) + SHA256_K[i] + w[i];
+            auto t2 = (rotateRight32(a, 2) ^ rotateRight32(a, 13) ^ rotateRight32(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+            h = g, g = f, f = e, e = d + t1, d = c, c = b, b = a, a = t1 + t2;
+            
+        }
+        state[0] += a, state[1] += b, state[2] += c, state[3] += d, state[4] += e, state[5] += f, state[6] += g, state[7] += h;
+        
+    }
+    
+}
+
+#if defined(CORECAT_ARCHITECTURE_X86) || defined(CORECAT_ARCHITECTURE_X86_64)
+// Four rounds per step; message words 16..63 are expanded with sha256msg1/sha256msg2 three steps ahead
+CORECAT_TARGET("sha,sse4.1") inline void transformSHA256SHA(std::uint32_t* state, const unsigned char* p, std::size_t count) noexcept {
+    
+    const __m128i MASK = _mm_set_epi64x(0x0C0D0E0F08090A0BULL, 0x0405060700010203ULL);
+    __m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0xB1);
+    __m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state + 4)), 0x1B);
+    __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0);
+    for(; count; --count, p += 64) {
+        
+        __m128i save0 = state0, save1 = state1;
+        __m128i m[4];
+        for(std::size_t i = 0; i < 16; ++i) {
+            
+            if(i < 4) m[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i * 16)), MASK);
+            __m128i msg = _mm_add_epi32(m[i & 3], _mm_load_si128(reinterpret_cast<const __m128i*>(SHA256_K + i * 4)));
+            state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+            if(i >= 3 && i < 15) {
+                
+                auto& next = m[(i + 1) & 3];
+                next = _mm_sha256msg2_epu32(_mm_add_epi32(next, _mm_alignr_epi8(m[i & 3], m[(i - 1) & 3], 4)), m[i & 3]);
+                
+            }
+            state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(msg, 0x0E));
+            if(i >= 1 && i < 13) m[(i - 1) & 3] = _mm_sha256msg1_epu32(m[(i - 1) & 3], m[i & 3]);
+            
+        }
+        state0 = _mm_add_epi32(state0, save0);
+        state1 = _mm_add_epi32(state1, save1);
+        
+    }
+    tmp = _mm_shuffle_epi32(state0, 0x1B);
+    state1 = _mm_shuffle_epi32(state1, 0xB1);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state), _mm_blend_epi16(tmp, state1, 0xF0));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state + 4), _mm_alignr_epi8(state1, tmp, 8));
+    
+}
+
+CORECAT_TARGET("avx2") inline __m256i rotateRight32x8(__m256i x, int n) noexcept {
+    
+    return _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - n));
+    
+}
+// One block for each of eight independent messages; lane j of state[i] is word i of message j
+CORECAT_TARGET("avx2") inline void transformSHA256x8AVX2(std::uint32_t (&state)[8][8], const unsigned char* const (&p)[8]) noexcept {
+    
+    __m256i w[16], s[8];
+    for(std::size_t i = 0; i < 8; ++i) s[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state[i]));
+    auto a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7];
+    for(std::size_t i = 0; i < 64; ++i) {
+        
+        __m256i x;
+        if(i < 16) {
+            
+            x = _mm256_setr_epi32(int(loadBigEndian32(p[0] + i * 4)), int(loadBigEndian32(p[1] + i * 4)), int(loadBigEndian32(p[2] + i * 4)),
+                int(loadBigEndian32(p[3] + i * 4)), int(loadBigEndian32(p[4] + i * 4)), int(loadBigEndian32(p[5] + i * 4)),
+                int(loadBigEndian32(p[6] + i * 4)), int(loadBigEndian32(p[7] + i * 4)));
+                
+        } else {
+            
+            auto w15 = w[(i - 15) & 15], w2 = w[(i - 2) & 15];
+            auto s0 = _mm256_xor_si256(_mm256_xor_si256(rotateRight32x8(w15, 7), rotateRight32x8(w15, 18)), _mm256_srli_epi32(w15, 3));
+            auto s1 = _mm256_xor_si256(_mm256_xor_si256(rotateRight32x8(w2, 17), rotateRight32x8(w2, 19)), _mm256_srli_epi32(w2, 10));
+            x = _mm256_add_epi32(_mm256_add_epi32(w[i & 15], s0), _mm256_add_epi32(w[(i - 7) & 15], s1));
+            
+        }
+        w[i & 15] = x;
+        auto S1 = _mm256_xor_si256(_mm256_xor_si256(rotateRight32x8(e, 6), rotateRight32x8(e, 11)), rotateRight32x8(e, 25));
+        auto ch = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+        auto t1 = _mm256_add_epi32(_mm256_add_epi32(_mm256_add_epi32(h, S1), _mm256_add_epi32(ch, x)), _mm256_set1_epi32(int(SHA256_K[i])));
+        auto S0 = _mm256_xor_si256(_mm256_xor_si256(rotateRight32x8(a, 2), rotateRight32x8(a, 13)), rotateRight32x8(a, 22));
+        auto maj = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(c, _mm256_or_si256(a, b)));
+        h = g, g = f, f = e, e = _mm256_add_epi32(d, t1), d = c, c = b, b = a, a = _mm256_add_epi32(t1, _mm256_add_epi32(S0, maj));
+        
+    }
+    __m256i r[] = {a, b, c, d, e, f, g, h};
+    for(std::size_t i = 0; i < 8; ++i) _mm256_storeu_si256(reinterpret_cast<__m256i*>(state[i]), _mm256_add_epi32(s[i], r[i]));
+    
+}
+// Runs eight messages through transformSHA256x8AVX2 together. Whole blocks are read in place and the padded tail of
+// each message comes from its own 128-byte buffer; lanes that run out of blocks keep their state
+inline void hashSHA256x8AVX2(const ArrayView<const Byte> (&data)[8], std::array<Byte, 32> (&digest)[8]) noexcept {
+    
+    alignas(32) std::uint32_t state[8][8];
+    unsigned char tail[8][128] = {};
+    static const unsigned char zero[64] = {};
+    std::size_t full[8], total[8], maxTotal = 0;
+    for(std::size_t j = 0; j < 8; ++j) {
+        
+        auto size = data[j].getSize();
+        auto rest = size % 64;
+        full[j] = size / 64;
+        total[j] = full[j] + (rest + 9 > 64 ? 2 : 1);
+        maxTotal = std::max(maxTotal, total[j]);
+        if(rest) std::memcpy(tail[j], data[j].getData() + full[j] * 64, rest);
+        tail[j][rest] = 0x80;
+        std::uint64_t bit = std::uint64_t(size) * 8;
+        for(std::size_t i = 0; i < 8; ++i) tail[j][(total[j] - full[j]) * 64 - 1 - i] = static_cast<unsigned char>(bit >> (i * 8));
+        for(std::size_t i = 0; i < 8; ++i) state[i][j] = SHA256_H[i];
+        
+    }
+    for(std::size_t t = 0; t < maxTotal; ++t) {
+        
+        const unsigned char* p[8];
+        std::uint32_t save[8][8];
+        std::memcpy(save, state, sizeof(state));
+        for(std::size_t j = 0; j < 8; ++j) {
+            
+            if(t < full[j]) p[j] = reinterpret_cast<const unsigned char*>(data[j].getData()) + t * 64;
+            else if(t < total[j]) p[j] = tail[j] + (t - full[j]) * 64;
+            else p[j] = zero;
+            
+        }
+        transformSHA256x8AVX2(state, p);
+        for(std::size_t j = 0; j < 8; ++j)
+            if(t >= total[j]) for(std::size_t i = 0; i < 8; ++i) state[i][j] = save[i][j];
+            
+    }
+    for(std::size_t j = 0; j < 8; ++j)
+        for(std::size_t i = 0; i < 8; ++i) storeBigEndian32(reinterpret_cast<unsigned char*>(digest[j].data()) + i * 4, state[i][j]);
+        
+}
+#endif
+
+inline void transformSHA256(std::uint32_t* state, const unsigned char* p, std::size_t count) noexcept {
+    
+#if defined(CORECAT_ARCHITECTURE_X86) || defined(CORECAT_ARCHITECTURE_X86_64)
+    if(X86Feature::SHA && X86Feature::SSE4_1) return transformSHA256SHA(state, p, count);
+#endif
+    transformSHA256Software(state, p, count);
+    
+}
+
+}
+
+class SHA256 final : public Digest<std::array<Byte, 32>> {
+    
+private:
+    
+    std::uint32_t state[8];
+    Impl::DigestBlockBuffer buffer;
+    
+public:
+    
+    SHA256() { reset(); }
+    
+    void update(ArrayView<const Byte> data) override {
+        
+        buffer.update(reinterpret_cast<const unsigned char*>(data.getData()), data.getSize(),
+            [&](const unsigned char* p, std::size_t count) { Impl::transformSHA256(state, p, count); });
+            
+    }
+    Type finish() override {
+        
+        buffer.finish([&](const unsigned char* p, std::size_t count) { Impl::transformSHA256(state, p, count); });
+        Type ret;
+        for(std::size_t i = 0; i < 8; ++i) Impl::storeBigEndian32(reinterpret_cast<unsigned char*>(ret.data()) + i * 4, state[i]);
+        reset();
+        return ret;
+        
+    }
+    void reset() override { std::copy(Impl::SHA256_H, Impl::SHA256_H + 8, state), buffer.reset(); }
+    
+    static Type hash(ArrayView<const Byte> data) {
+        
+        SHA256 sha;
+        sha.update(data);
+        return sha.finish();
+        
+    }
+    // Hashes eight independent messages. Without the SHA extensions they share one AVX2 pass, which pays off when the
+    // lengths are similar; with them, hashing one after another is about as fast and does not care about lengths
+    static void hash(const ArrayView<const Byte> (&data)[8], Type (&digest)[8]) {
+        
+#if defined(CORECAT_ARCHITECTURE_X86) || defined(CORECAT_ARCHITECTURE_X86_64)
+        if(!X86Feature::SHA && X86Feature::AVX2) return Impl::hashSHA256x8AVX2(data, digest);
+#endif
+        for(std::size_t j = 0; j < 8; ++j) digest[j] = hash(data[j]);
+        
+    }
+    
+};
+
+}
+}
+}
+
+
+#endif
@@ -31,12 +31,16 @@
 #include "Stream/InputStream.hpp"
 #include "Stream/OutputStream.hpp"
 
+#include "Stream/BinaryReader.hpp"
+#include "Stream/BinaryWriter.hpp"
 #include "Stream/BufferedInputStream.hpp"
 #include "Stream/BufferedOutputStream.hpp"
 #include "Stream/CastInputStream.hpp"
 #include "Stream/CastOutputStream.hpp"
 #include "Stream/DataViewInputStream.hpp"
 #include "Stream/DataViewOutputStream.hpp"
+#include "Stream/DigestInputStream.hpp"
+#include "Stream/DigestOutputStream.hpp"
 #include "Stream/WrapperInputStream.hpp"
 #include "Stream/WrapperOutputStream.hpp"
 
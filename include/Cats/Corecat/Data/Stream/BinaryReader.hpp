@@ -0,0 +1,219 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2016-2018 The Cats Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef CATS_CORECAT_DATA_STREAM_BINARYREADER_HPP
+#define CATS_CORECAT_DATA_STREAM_BINARYREADER_HPP
+
+
+#include <cstdint>
+#include <cstring>
+
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+
+#include "InputStream.hpp"
+#include "../../System/Architecture.hpp"
+#include "../../System/Compiler.hpp"
+#include "../../Text/String.hpp"
+#include "../../Util/Bit.hpp"
+#include "../../Util/Endian.hpp"
+#include "../../Util/Exception.hpp"
+
+#if defined(CORECAT_ARCHITECTURE_X86) || defined(CORECAT_ARCHITECTURE_X86_64)
+#   include <immintrin.h>
+#   include "../../X86/X86FeatureBase.hpp"
+#endif
+
+
+namespace Cats {
+namespace Corecat {
+inline namespace Data {
+
+namespace Impl {
+
+// Packs the low 7 bits of each byte together, the inverse of spreadVarint
+inline std::uint64_t compactVarint(std::uint64_t x) noexcept {
+    
+    x &= 0x7F7F7F7F7F7F7F7F;
+    x = ((x & 0x7F007F007F007F00) >> 1) | (x & 0x007F007F007F007F);
+    x = ((x & 0x3FFF00003FFF0000) >> 2) | (x & 0x00003FFF00003FFF);
+    x = ((x & 0x0FFFFFFF00000000) >> 4) | (x & 0x000000000FFFFFFF);
+    return x;
+    
+}
+#if defined(CORECAT_ARCHITECTURE_X86_64)
+CORECAT_TARGET("bmi2") inline std::uint64_t compactVarintBMI2(std::uint64_t x) noexcept { return _pext_u64(x, 0x7F7F7F7F7F7F7F7F); }
+#endif
+
+}
+
+// Decodes values straight out of an internal buffer, which is refilled from the underlying stream only when it runs dry
+template <Endian E = Endian::LITTLE>
+class BinaryReader {
+    
+private:
+    
+    InputStream<char>* is;
+    std::vector<char> data;
+    std::size_t begin = 0;
+    std::size_t end = 0;
+    
+private:
+    
+    void fill(std::size_t count) {
+        
+        if(end - begin >= count) return;
+        std::memmove(data.data(), data.data() + begin, end - begin);
+        end -= begin, begin = 0;
+        while(end < count) {
+            
+            auto c = is->read(data.data() + end, data.size() - end);
+            if(!c) throw IOException("End of stream");
+            end += c;
+            
+        }
+        
+    }
+    
+    std::uint64_t getVarintSlow() {
+        
+        std::uint64_t x = 0;
+        for(std::size_t shift = 0; shift < 64; shift += 7) {
+            
+            fill(1);
+            auto b = std::uint8_t(data[begin++]);
+            // The 10th byte holds only the top bit
+            if(shift == 63 && b > 1) break;
+            x |= std::uint64_t(b & 0x7F) << shift;
+            if(!(b & 0x80)) return x;
+            
+        }
+        throw IOException("Invalid varint");
+        
+    }
+    
+public:
+    
+    BinaryReader(InputStream<char>& is_, std::size_t bufferSize = 4096) : is(&is_), data(bufferSize < 16 ? 16 : bufferSize) {}
+    BinaryReader(BinaryReader&& src) : is(src.is), data(std::move(src.data)), begin(src.begin), end(src.end) { src.is = nullptr, src.begin = src.end = 0; }
+    
+    BinaryReader& operator =(BinaryReader&& src) {
+        
+        is = src.is, src.is = nullptr;
+        data = std::move(src.data), begin = src.begin, end = src.end, src.begin = src.end = 0;
+        return *this;
+        
+    }
+    
+    template <typename T, Endian F = E>
+    std::enable_if_t<std::is_arithmetic<T>::value, T> get() {
+        
+        using U = typename Util::Impl::EndianUnit<sizeof(T)>::Type;
+        
+        fill(sizeof(T));
+        U u;
+        std::memcpy(&u, data.data() + begin, sizeof(T));
+        begin += sizeof(T);
+        u = convertEndian<F, Endian::NATIVE>(u);
+        T t;
+        std::memcpy(&t, &u, sizeof(T));
+        return t;
+        
+    }
+    
+    std::uint64_t getVarint() {
+        
+        // With 8 bytes buffered the terminator of a short varint is found with one word load
+        if(end - begin >= 8) {
+            
+            std::uint64_t w;
+            std::memcpy(&w, data.data() + begin, 8);
+            w = convertLittleToNative(w);
+            std::uint64_t stop = ~w & 0x8080808080808080;
+            if(stop) {
+                
+                std::size_t length = countTrailingZero(stop) / 8 + 1;
+                w &= ~std::uint64_t(0) >> (64 - length * 8);
+                begin += length;
+#if defined(CORECAT_ARCHITECTURE_X86_64)
+                if(X86FeatureBase::BMI2) return Impl::compactVarintBMI2(w);
+#endif
+                return Impl::compactVarint(w);
+                
+            }
+            
+        }
+        return getVarintSlow();
+        
+    }
+    std::int64_t getZigZag() { auto x = getVarint(); return std::int64_t(x >> 1) ^ -std::int64_t(x & 1); }
+    
+    void getBytes(char* buffer, std::size_t count) {
+        
+        auto c = std::min(count, end - begin);
+        std::memcpy(buffer, data.data() + begin, c);
+        begin += c;
+        if(count > c) is->readAll(buffer + c, count - c);
+        
+    }
+    // Reads a varint length followed by the bytes. The length is untrusted, so the string only grows as the bytes
+    // arrive, and a bogus length ends in "End of stream" rather than a huge allocation.
+    String8 getString() {
+        
+        auto length = getVarint();
+        String8 str;
+        while(length) {
+            
+            fill(1);
+            auto c = std::size_t(std::min<std::uint64_t>(length, end - begin));
+            str.append(data.data() + begin, c);
+            begin += c, length -= c;
+            
+        }
+        return str;
+        
+    }
+    
+    void skip(std::size_t count) {
+        
+        auto c = std::min(count, end - begin);
+        begin += c;
+        if(count > c) is->skip(count - c);
+        
+    }
+    
+};
+
+template <Endian E = Endian::LITTLE>
+inline BinaryReader<E> createBinaryReader(InputStream<char>& is) { return BinaryReader<E>(is); }
+
+}
+}
+}
+
+
+#endif
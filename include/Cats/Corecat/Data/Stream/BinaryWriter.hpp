@@ -0,0 +1,179 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2016-2018 The Cats Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef CATS_CORECAT_DATA_STREAM_BINARYWRITER_HPP
+#define CATS_CORECAT_DATA_STREAM_BINARYWRITER_HPP
+
+
+#include <cstdint>
+#include <cstring>
+
+#include <type_traits>
+#include <vector>
+
+#include "OutputStream.hpp"
+#include "../../System/Architecture.hpp"
+#include "../../System/Compiler.hpp"
+#include "../../Text/String.hpp"
+#include "../../Util/Bit.hpp"
+#include "../../Util/Endian.hpp"
+
+#if defined(CORECAT_ARCHITECTURE_X86) || defined(CORECAT_ARCHITECTURE_X86_64)
+#   include <immintrin.h>
+#   include "../../X86/X86FeatureBase.hpp"
+#endif
+
+
+namespace Cats {
+namespace Corecat {
+inline namespace Data {
+
+namespace Impl {
+
+// Spreads the low 56 bits into the low 7 bits of each byte
+inline std::uint64_t spreadVarint(std::uint64_t x) noexcept {
+    
+    x = ((x << 4) & 0x0FFFFFFF00000000) | (x & 0x000000000FFFFFFF);
+    x = ((x << 2) & 0x3FFF00003FFF0000) | (x & 0x00003FFF00003FFF);
+    x = ((x << 1) & 0x7F007F007F007F00) | (x & 0x007F007F007F007F);
+    return x;
+    
+}
+#if defined(CORECAT_ARCHITECTURE_X86_64)
+CORECAT_TARGET("bmi2") inline std::uint64_t spreadVarintBMI2(std::uint64_t x) noexcept { return _pdep_u64(x, 0x7F7F7F7F7F7F7F7F); }
+#endif
+
+inline std::size_t getVarintLength(std::uint64_t x) noexcept { return (63 - countLeadingZero(x | 1)) / 7 + 1; }
+
+}
+
+// Encodes values straight into an internal buffer, which is handed to the underlying stream only when it is full
+template <Endian E = Endian::LITTLE>
+class BinaryWriter {
+    
+private:
+    
+    OutputStream<char>* os;
+    std::vector<char> data;
+    std::size_t size = 0;
+    
+private:
+    
+    void reserve(std::size_t count) { if(data.size() - size < count) flushBuffer(); }
+    void flushBuffer() { if(size) os->writeAll(data.data(), size), size = 0; }
+    
+public:
+    
+    BinaryWriter(OutputStream<char>& os_, std::size_t bufferSize = 4096) : os(&os_), data(bufferSize < 16 ? 16 : bufferSize) {}
+    BinaryWriter(BinaryWriter&& src) : os(src.os), data(std::move(src.data)), size(src.size) { src.os = nullptr, src.size = 0; }
+    // Whatever is still buffered is written out; a failure here is lost, so call flush() first to see it
+    ~BinaryWriter() { if(os) try { flush(); } catch(...) {} }
+    
+    BinaryWriter& operator =(BinaryWriter&& src) {
+        
+        os = src.os, src.os = nullptr;
+        data = std::move(src.data), size = src.size, src.size = 0;
+        return *this;
+        
+    }
+    
+    template <typename T, Endian F = E>
+    std::enable_if_t<std::is_arithmetic<T>::value> put(T t) {
+        
+        using U = typename Util::Impl::EndianUnit<sizeof(T)>::Type;
+        
+        reserve(sizeof(T));
+        U u;
+        std::memcpy(&u, &t, sizeof(T));
+        u = convertEndian<Endian::NATIVE, F>(u);
+        std::memcpy(data.data() + size, &u, sizeof(T));
+        size += sizeof(T);
+        
+    }
+    
+    // LEB128: 7 bits per byte, least significant group first, high bit set on all but the last byte
+    void putVarint(std::uint64_t x) {
+        
+        reserve(10);
+        auto p = data.data() + size;
+        std::size_t length = Impl::getVarintLength(x);
+        if(length <= 8) {
+            
+            std::uint64_t w;
+#if defined(CORECAT_ARCHITECTURE_X86_64)
+            if(X86FeatureBase::BMI2) w = Impl::spreadVarintBMI2(x);
+            else
+#endif
+            w = Impl::spreadVarint(x);
+            w |= 0x8080808080808080 & ((std::uint64_t(1) << (length - 1) * 8) - 1);
+            w = convertNativeToLittle(w);
+            // The buffer always has room for 8 bytes here
+            std::memcpy(p, &w, 8);
+            
+        } else {
+            
+            for(std::size_t i = 0; i < length - 1; ++i, x >>= 7) p[i] = char(0x80 | (x & 0x7F));
+            p[length - 1] = char(x);
+            
+        }
+        size += length;
+        
+    }
+    void putZigZag(std::int64_t x) { putVarint((std::uint64_t(x) << 1) ^ std::uint64_t(x >> 63)); }
+    
+    void putBytes(const char* buffer, std::size_t count) {
+        
+        if(count <= data.size() - size) std::memcpy(data.data() + size, buffer, count), size += count;
+        else if(count < data.size()) flushBuffer(), std::memcpy(data.data(), buffer, count), size = count;
+        else flushBuffer(), os->writeAll(buffer, count);
+        
+    }
+    // Writes the length as a varint followed by the bytes
+    void putString(StringView8 sv) {
+        
+        putVarint(sv.getLength());
+        putBytes(sv.getData(), sv.getLength());
+        
+    }
+    
+    void flush() {
+        
+        flushBuffer();
+        os->flush();
+        
+    }
+    
+};
+
+template <Endian E = Endian::LITTLE>
+inline BinaryWriter<E> createBinaryWriter(OutputStream<char>& os) { return BinaryWriter<E>(os); }
+
+}
+}
+}
+
+
+#endif
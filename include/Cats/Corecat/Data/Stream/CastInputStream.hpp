@@ -28,51 +28,134 @@
 #define CATS_CORECAT_DATA_STREAM_CASTINPUTSTREAM_HPP
 
 
+#include <cstdint>
 #include <cstring>
 
+#include <algorithm>
+
 #include "InputStream.hpp"
+#include "../../Util/Endian.hpp"
 
 
 namespace Cats {
 namespace Corecat {
 inline namespace Data {
 
-template <typename T, typename U>
+// Reinterprets a stream of U as a stream of T, converting each T from endian E to the native one
+template <typename T, typename U, Endian E = Endian::NATIVE>
 class CastInputStream : public InputStream<T> {
     
+private:
+    
+    static constexpr std::size_t CHUNK_SIZE = 4096 / sizeof(U) ? 4096 / sizeof(U) : 1;
+    
 private:
     
     InputStream<U>* is;
-    std::uint8_t data[sizeof(T)];
+    // Bytes already read from the underlying stream but not returned yet
+    std::uint8_t data[sizeof(T) + sizeof(U)];
     std::size_t size = 0;
     
+private:
+    
+    void take(std::uint8_t* p, std::size_t count) noexcept {
+        
+        std::memcpy(p, data, count);
+        std::memmove(data, data + count, size - count);
+        size -= count;
+        
+    }
+    
+    // Reads as many whole U as fit into count bytes, straight into p when it is suitably aligned
+    std::size_t readBulk(std::uint8_t* p, std::size_t count) {
+        
+        if(reinterpret_cast<std::uintptr_t>(p) % alignof(U) == 0)
+            return is->read(reinterpret_cast<U*>(p), count / sizeof(U)) * sizeof(U);
+        U chunk[CHUNK_SIZE];
+        std::size_t x = is->read(chunk, std::min<std::size_t>(count / sizeof(U), CHUNK_SIZE)) * sizeof(U);
+        std::memcpy(p, chunk, x);
+        return x;
+        
+    }
+    
+    // Reads a single U, keeping the bytes beyond count for later
+    std::size_t readPartial(std::uint8_t* p, std::size_t count) {
+        
+        U u;
+        if(!is->read(&u, 1)) return 0;
+        auto q = reinterpret_cast<const std::uint8_t*>(&u);
+        std::memcpy(p, q, count);
+        std::memcpy(data + size, q + count, sizeof(U) - count);
+        size += sizeof(U) - count;
+        return count;
+        
+    }
+    
 public:
     
     CastInputStream(InputStream<U>& is_) : is(&is_) {}
+    CastInputStream(CastInputStream&& src) : is(src.is), size(src.size) { std::memcpy(data, src.data, size); src.is = nullptr; }
     ~CastInputStream() override = default;
     
+    CastInputStream& operator =(CastInputStream&& src) {
+        
+        is = src.is, src.is = nullptr;
+        std::memcpy(data, src.data, src.size), size = src.size;
+        return *this;
+        
+    }
+    
     std::size_t read(T* buffer, std::size_t count) override {
         
-        std::memcpy(buffer, data, size);
-        std::size_t x = size;
-        while(x < sizeof(T)) {
+        auto p = reinterpret_cast<std::uint8_t*>(buffer);
+        std::size_t total = count * sizeof(T);
+        std::size_t x = std::min(size, total);
+        take(p, x);
+        bool first = true;
+        while(x < total && (first || x < sizeof(T))) {
+            
+            std::size_t rest = total - x, y;
+            if(rest >= sizeof(U)) y = readBulk(p + x, rest);
+            else y = readPartial(p + x, rest);
+            if(!y) break;
+            x += y, first = false;
+            
+        }
+        std::size_t n = x / sizeof(T), remain = x % sizeof(T);
+        if(remain) {
+            
+            std::memmove(data + remain, data, size);
+            std::memcpy(data, p + n * sizeof(T), remain);
+            size += remain;
+            
+        }
+        convertEndian<E, Endian::NATIVE>(buffer, n);
+        return n;
+        
+    }
+    void skip(std::size_t count) override {
+        
+        std::size_t total = count * sizeof(T);
+        std::size_t x = std::min(size, total);
+        std::memmove(data, data + x, size - x);
+        size -= x, total -= x;
+        if(total >= sizeof(U)) is->skip(total / sizeof(U)), total %= sizeof(U);
+        if(total) {
             
-            std::size_t y = is->read(reinterpret_cast<U*>(reinterpret_cast<std::uint8_t*>(buffer) + x), count * sizeof(T) - x) * sizeof(U);
-            if(!y) return 0;
-            x += y;
+            std::uint8_t t[sizeof(U)];
+            readPartial(t, total);
             
         }
-        size = x % sizeof(T);
-        std::memcpy(data, reinterpret_cast<std::uint8_t*>(buffer) + x - size, size);
-        return x / sizeof(T);
         
     }
-    void skip(std::size_t count) override { /* TODO */ }
     
 };
 
-template <typename T, typename U>
-inline CastInputStream<T, U> createCastInputStream(InputStream<U>& is) { return CastInputStream<T, U>(is); }
+template <typename T, typename U, Endian E>
+constexpr std::size_t CastInputStream<T, U, E>::CHUNK_SIZE;
+
+template <typename T, typename U, Endian E = Endian::NATIVE>
+inline CastInputStream<T, U, E> createCastInputStream(InputStream<U>& is) { return CastInputStream<T, U, E>(is); }
 
 }
 }
@@ -0,0 +1,365 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2016-2018 The Cats Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef CATS_CORECAT_DATA_STREAM_DEFLATEOUTPUTSTREAM_HPP
+#define CATS_CORECAT_DATA_STREAM_DEFLATEOUTPUTSTREAM_HPP
+
+
+#include <cstring>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <zlib.h>
+
+#include "OutputStream.hpp"
+#include "../../Concurrent/ThreadPoolExecutor.hpp"
+#include "../../Util/Exception.hpp"
+
+
+namespace Cats {
+namespace Corecat {
+inline namespace Data {
+
+enum class DeflateFormat { RAW, ZLIB, GZIP };
+
+namespace Impl {
+
+inline int getDeflateWindowBits(DeflateFormat format) noexcept {
+    
+    switch(format) {
+    case DeflateFormat::RAW: return -MAX_WBITS;
+    case DeflateFormat::ZLIB: return MAX_WBITS;
+    default: return MAX_WBITS + 16;
+    }
+    
+}
+
+}
+
+// Needs zlib at link time. With an executor, input is cut into blocks which are compressed in parallel, each primed
+// with the last 32 KiB of the previous block and ended with a sync flush, so the output is still a single stream
+class DeflateOutputStream : public OutputStream<char> {
+    
+private:
+    
+    static constexpr std::size_t WINDOW_SIZE = 32768;
+    static constexpr std::size_t BUFFER_SIZE = 65536;
+    
+    struct Block {
+        
+        std::vector<char> input;
+        std::vector<char> dictionary;
+        std::vector<char> output;
+        uLong checksum = 0;
+        bool last = false;
+        std::exception_ptr error;
+        
+        // Set by whichever of the pool task and popBlock() gets to the block first, which then compresses it
+        std::atomic<bool> claimed = {false};
+        bool done = false;
+        std::mutex mutex;
+        std::condition_variable condition;
+        
+    };
+    
+private:
+    
+    OutputStream<char>* os;
+    int level;
+    DeflateFormat format;
+    std::unique_ptr<z_stream> stream;
+    std::vector<char> data;
+    bool finished = false;
+    
+    ThreadPoolExecutor* executor = nullptr;
+    std::size_t blockSize = 0;
+    std::size_t maxPending = 0;
+    std::size_t size = 0;
+    std::deque<std::shared_ptr<Block>> pending;
+    std::vector<char> window;
+    uLong checksum = 0;
+    std::uint64_t totalIn = 0;
+    bool headerWritten = false;
+    
+private:
+    
+    void deflateStream(int flush) {
+        
+        do {
+            
+            stream->next_out = reinterpret_cast<Bytef*>(data.data());
+            stream->avail_out = uInt(data.size());
+            int ret = ::deflate(stream.get(), flush);
+            if(ret == Z_STREAM_ERROR) throw IOException("::deflate failed");
+            std::size_t count = data.size() - stream->avail_out;
+            if(count) os->writeAll(data.data(), count);
+            
+        } while(stream->avail_in || !stream->avail_out);
+        
+    }
+    
+    static void compressBlock(Block& block, int level) {
+        
+        z_stream s = {};
+        if(deflateInit2(&s, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) throw IOException("::deflateInit2 failed");
+        if(!block.dictionary.empty())
+            deflateSetDictionary(&s, reinterpret_cast<const Bytef*>(block.dictionary.data()), uInt(block.dictionary.size()));
+        try { block.output.resize(deflateBound(&s, uLong(block.input.size())) + 16); } catch(...) { deflateEnd(&s); throw; }
+        s.next_in = reinterpret_cast<Bytef*>(block.input.data());
+        s.avail_in = uInt(block.input.size());
+        s.next_out = reinterpret_cast<Bytef*>(block.output.data());
+        s.avail_out = uInt(block.output.size());
+        int ret = ::deflate(&s, block.last ? Z_FINISH : Z_SYNC_FLUSH);
+        block.output.resize(block.output.size() - s.avail_out);
+        deflateEnd(&s);
+        if(ret != (block.last ? Z_STREAM_END : Z_OK)) throw IOException("::deflate failed");
+        
+    }
+    // Checksums and compresses a block, keeping any exception for popBlock() to rethrow
+    static void runBlock(Block& block, int level, DeflateFormat format) noexcept {
+        
+        try {
+            
+            auto input = reinterpret_cast<const Bytef*>(block.input.data());
+            if(format == DeflateFormat::ZLIB) block.checksum = adler32(adler32(0, nullptr, 0), input, uInt(block.input.size()));
+            else if(format == DeflateFormat::GZIP) block.checksum = crc32(crc32(0, nullptr, 0), input, uInt(block.input.size()));
+            compressBlock(block, level);
+            
+        } catch(...) { block.error = std::current_exception(); }
+        
+    }
+    
+    void writeHeader() {
+        
+        if(headerWritten) return;
+        headerWritten = true;
+        if(format == DeflateFormat::ZLIB) {
+            
+            int l = level < 0 ? 6 : level;
+            unsigned char cmf = 0x78;
+            unsigned char flg = (l < 2 ? 0 : l < 6 ? 1 : l == 6 ? 2 : 3) << 6;
+            flg += 31 - (cmf * 256 + flg) % 31;
+            char header[] = {char(cmf), char(flg)};
+            os->writeAll(header, sizeof(header));
+            checksum = adler32(0, nullptr, 0);
+            
+        } else if(format == DeflateFormat::GZIP) {
+            
+            char header[] = {'\x1F', '\x8B', 8, 0, 0, 0, 0, 0, char(level == 9 ? 2 : level == 1 ? 4 : 0), '\xFF'};
+            os->writeAll(header, sizeof(header));
+            checksum = crc32(0, nullptr, 0);
+            
+        }
+        
+    }
+    void writeTrailer() {
+        
+        if(format == DeflateFormat::ZLIB) {
+            
+            char trailer[] = {char(checksum >> 24), char(checksum >> 16), char(checksum >> 8), char(checksum)};
+            os->writeAll(trailer, sizeof(trailer));
+            
+        } else if(format == DeflateFormat::GZIP) {
+            
+            auto s = std::uint32_t(totalIn);
+            char trailer[] = {char(checksum), char(checksum >> 8), char(checksum >> 16), char(checksum >> 24),
+                char(s), char(s >> 8), char(s >> 16), char(s >> 24)};
+            os->writeAll(trailer, sizeof(trailer));
+            
+        }
+        
+    }
+    
+    void popBlock() {
+        
+        auto block = std::move(pending.front());
+        pending.pop_front();
+        // A block the pool has not started yet is compressed here rather than waited for, so that this cannot hang when
+        // no pool thread is free
+        if(!block->claimed.exchange(true)) runBlock(*block, level, format);
+        else {
+            
+            std::unique_lock<std::mutex> lock(block->mutex);
+            block->condition.wait(lock, [&] { return block->done; });
+            
+        }
+        if(block->error) std::rethrow_exception(block->error);
+        writeHeader();
+        if(format == DeflateFormat::ZLIB) checksum = adler32_combine(checksum, block->checksum, z_off_t(block->input.size()));
+        else if(format == DeflateFormat::GZIP) checksum = crc32_combine(checksum, block->checksum, z_off_t(block->input.size()));
+        totalIn += block->input.size();
+        os->writeAll(block->output.data(), block->output.size());
+        
+    }
+    void pushBlock(bool last) {
+        
+        auto block = std::make_shared<Block>();
+        block->input.assign(data.data(), data.data() + size);
+        block->dictionary = window;
+        block->last = last;
+        if(size >= WINDOW_SIZE) window.assign(data.data() + size - WINDOW_SIZE, data.data() + size);
+        else {
+            
+            window.insert(window.end(), data.data(), data.data() + size);
+            if(window.size() > WINDOW_SIZE) window.erase(window.begin(), window.end() - WINDOW_SIZE);
+            
+        }
+        size = 0;
+        if(pending.size() >= maxPending) popBlock();
+        pending.push_back(block);
+        int l = level;
+        DeflateFormat f = format;
+        executor->execute([block, l, f] {
+            
+            if(block->claimed.exchange(true)) return;
+            runBlock(*block, l, f);
+            {
+                std::lock_guard<std::mutex> lock(block->mutex);
+                block->done = true;
+            }
+            block->condition.notify_all();
+            
+        });
+        
+    }
+    
+public:
+    
+    DeflateOutputStream(OutputStream<char>& os_, int level_ = Z_DEFAULT_COMPRESSION, DeflateFormat format_ = DeflateFormat::ZLIB) :
+        os(&os_), level(level_), format(format_), stream(new z_stream()), data(BUFFER_SIZE) {
+            
+        if(deflateInit2(stream.get(), level, Z_DEFLATED, Impl::getDeflateWindowBits(format), 8, Z_DEFAULT_STRATEGY) != Z_OK)
+            throw InvalidArgumentException("::deflateInit2 failed");
+            
+    }
+    DeflateOutputStream(OutputStream<char>& os_, ThreadPoolExecutor& executor_, int level_ = Z_DEFAULT_COMPRESSION,
+        DeflateFormat format_ = DeflateFormat::ZLIB, std::size_t blockSize_ = 131072) :
+        os(&os_), level(level_), format(format_), data(blockSize_ < WINDOW_SIZE ? WINDOW_SIZE : blockSize_),
+        executor(&executor_), blockSize(data.size()), maxPending(std::thread::hardware_concurrency() * 2 + 2) {
+            
+        if(level < Z_DEFAULT_COMPRESSION || level > Z_BEST_COMPRESSION) throw InvalidArgumentException("Invalid level");
+        
+    }
+    DeflateOutputStream(const DeflateOutputStream& src) = delete;
+    DeflateOutputStream(DeflateOutputStream&& src) :
+        os(src.os), level(src.level), format(src.format), stream(std::move(src.stream)), data(std::move(src.data)), finished(src.finished),
+        executor(src.executor), blockSize(src.blockSize), maxPending(src.maxPending), size(src.size), pending(std::move(src.pending)),
+        window(std::move(src.window)), checksum(src.checksum), totalIn(src.totalIn), headerWritten(src.headerWritten) { src.os = nullptr; }
+    // Finishes the stream if finish() was not called; a failure here is lost, so call finish() first to see it
+    ~DeflateOutputStream() override {
+        
+        if(os) try { finish(); } catch(...) {}
+        if(stream) deflateEnd(stream.get());
+        
+    }
+    
+    DeflateOutputStream& operator =(const DeflateOutputStream& src) = delete;
+    
+    std::size_t write(const char* buffer, std::size_t count) override {
+        
+        if(finished) throw IOException("Stream is finished");
+        if(executor) {
+            
+            for(std::size_t i = 0; i < count; ) {
+                
+                std::size_t x = std::min(count - i, blockSize - size);
+                std::memcpy(data.data() + size, buffer + i, x);
+                size += x, i += x;
+                if(size == blockSize) pushBlock(false);
+                
+            }
+            
+        } else {
+            
+            // avail_in is only a uInt
+            for(std::size_t i = 0; i < count; ) {
+                
+                std::size_t x = std::min<std::size_t>(count - i, std::numeric_limits<uInt>::max());
+                stream->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(buffer + i));
+                stream->avail_in = uInt(x);
+                deflateStream(Z_NO_FLUSH);
+                i += x;
+                
+            }
+            
+        }
+        return count;
+        
+    }
+    // Emits everything written so far on a byte boundary, at a small cost in ratio
+    void flush() override {
+        
+        if(!finished) {
+            
+            if(executor) {
+                
+                if(size) pushBlock(false);
+                while(!pending.empty()) popBlock();
+                
+            } else deflateStream(Z_SYNC_FLUSH);
+            
+        }
+        os->flush();
+        
+    }
+    // Ends the compressed stream; called by the destructor if not called before
+    void finish() {
+        
+        if(finished) return;
+        if(executor) {
+            
+            pushBlock(true);
+            while(!pending.empty()) popBlock();
+            writeTrailer();
+            
+        } else deflateStream(Z_FINISH);
+        finished = true;
+        os->flush();
+        
+    }
+    
+};
+
+inline DeflateOutputStream createDeflateOutputStream(OutputStream<char>& os, int level = Z_DEFAULT_COMPRESSION,
+    DeflateFormat format = DeflateFormat::ZLIB) { return DeflateOutputStream(os, level, format); }
+inline DeflateOutputStream createDeflateOutputStream(OutputStream<char>& os, ThreadPoolExecutor& executor,
+    int level = Z_DEFAULT_COMPRESSION, DeflateFormat format = DeflateFormat::ZLIB) { return DeflateOutputStream(os, executor, level, format); }
+    
+}
+}
+}
+
+
+#endif
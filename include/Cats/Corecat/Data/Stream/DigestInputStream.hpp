@@ -0,0 +1,96 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2016-2018 The Cats Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef CATS_CORECAT_DATA_STREAM_DIGESTINPUTSTREAM_HPP
+#define CATS_CORECAT_DATA_STREAM_DIGESTINPUTSTREAM_HPP
+
+
+#include "DigestOutputStream.hpp"
+#include "InputStream.hpp"
+#include "../../Concurrent/ThreadPoolExecutor.hpp"
+
+
+namespace Cats {
+namespace Corecat {
+inline namespace Data {
+
+// Hashes everything read from the wrapped stream; skipped bytes are read and hashed too, so finish() always covers
+// the whole stream consumed since construction or the previous finish()
+template <typename D>
+class DigestInputStream : public InputStream<char> {
+    
+private:
+    
+    InputStream<char>* is;
+    Impl::DigestFeeder<D> feeder;
+    
+public:
+    
+    DigestInputStream(InputStream<char>& is_, ThreadPoolExecutor* executor = nullptr) : is(&is_), feeder(executor) {}
+    DigestInputStream(DigestInputStream&& src) : is(src.is), feeder(std::move(src.feeder)) { src.is = nullptr; }
+    ~DigestInputStream() override = default;
+    
+    DigestInputStream& operator =(DigestInputStream&& src) {
+        
+        is = src.is, src.is = nullptr;
+        feeder = std::move(src.feeder);
+        return *this;
+        
+    }
+    
+    std::size_t read(char* buffer, std::size_t count) override {
+        
+        count = is->read(buffer, count);
+        feeder.update(buffer, count);
+        return count;
+        
+    }
+    void skip(std::size_t count) override {
+        
+        char buffer[4096];
+        while(count) {
+            
+            auto c = read(buffer, count < sizeof(buffer) ? count : sizeof(buffer));
+            if(!c) break;
+            count -= c;
+            
+        }
+        
+    }
+    
+    typename D::Type finish() { return feeder.finish(); }
+    
+};
+
+template <typename D>
+inline DigestInputStream<D> createDigestInputStream(InputStream<char>& is, ThreadPoolExecutor* executor = nullptr) { return DigestInputStream<D>(is, executor); }
+
+}
+}
+}
+
+
+#endif
@@ -0,0 +1,217 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2016-2018 The Cats Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef CATS_CORECAT_DATA_STREAM_DIGESTOUTPUTSTREAM_HPP
+#define CATS_CORECAT_DATA_STREAM_DIGESTOUTPUTSTREAM_HPP
+
+
+#include <cstring>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "OutputStream.hpp"
+#include "../../Concurrent/ThreadPoolExecutor.hpp"
+#include "../../Util/Byte.hpp"
+
+
+namespace Cats {
+namespace Corecat {
+inline namespace Data {
+
+namespace Impl {
+
+// Collects bytes into 64 KiB chunks before handing them to D. With an executor each full chunk is hashed on the pool
+// while the next one fills up, so hashing overlaps the I/O instead of adding to it
+template <typename D>
+class DigestFeeder {
+    
+private:
+    
+    static constexpr std::size_t CHUNK_SIZE = 65536;
+    
+    // A chunk handed to the pool, hashed by whichever of the pool task and wait() claims it first
+    struct Job {
+        
+        const char* data;
+        std::size_t size;
+        std::atomic<bool> claimed = {false};
+        bool done = false;
+        std::mutex mutex;
+        std::condition_variable condition;
+        
+    };
+    
+    struct State {
+        
+        D digest;
+        std::vector<char> data[2] = {std::vector<char>(CHUNK_SIZE), std::vector<char>(CHUNK_SIZE)};
+        std::size_t current = 0;
+        std::size_t size = 0;
+        std::shared_ptr<Job> job;
+        
+    };
+    
+private:
+    
+    ThreadPoolExecutor* executor;
+    std::unique_ptr<State> state;
+    
+private:
+    
+    // Hashes the chunk here if the pool has not started on it, so that this cannot hang when no pool thread is free
+    void wait() {
+        
+        auto& job = state->job;
+        if(!job) return;
+        if(!job->claimed.exchange(true)) state->digest.update({reinterpret_cast<const Byte*>(job->data), job->size});
+        else {
+            
+            std::unique_lock<std::mutex> lock(job->mutex);
+            job->condition.wait(lock, [&] { return job->done; });
+            
+        }
+        job.reset();
+        
+    }
+    void submit() {
+        
+        auto s = state.get();
+        if(!executor) s->digest.update({reinterpret_cast<const Byte*>(s->data[s->current].data()), s->size});
+        else {
+            
+            wait();
+            auto job = std::make_shared<Job>();
+            job->data = s->data[s->current].data(), job->size = s->size;
+            s->job = job;
+            // A task that loses the claim touches only the job, since the feeder may be gone by then
+            executor->execute([s, job] {
+                
+                if(job->claimed.exchange(true)) return;
+                s->digest.update({reinterpret_cast<const Byte*>(job->data), job->size});
+                {
+                    std::lock_guard<std::mutex> lock(job->mutex);
+                    job->done = true;
+                }
+                job->condition.notify_all();
+                
+            });
+            s->current ^= 1;
+            
+        }
+        s->size = 0;
+        
+    }
+    
+public:
+    
+    DigestFeeder(ThreadPoolExecutor* executor_) : executor(executor_), state(new State) {}
+    DigestFeeder(DigestFeeder&& src) = default;
+    ~DigestFeeder() { if(state) wait(); }
+    
+    DigestFeeder& operator =(DigestFeeder&& src) { if(state) wait(); executor = src.executor, state = std::move(src.state); return *this; }
+    
+    void update(const char* p, std::size_t count) {
+        
+        auto s = state.get();
+        if(!executor && !s->size && count >= CHUNK_SIZE) {
+            
+            s->digest.update({reinterpret_cast<const Byte*>(p), count});
+            return;
+            
+        }
+        while(count) {
+            
+            std::size_t x = std::min(count, CHUNK_SIZE - s->size);
+            std::memcpy(s->data[s->current].data() + s->size, p, x);
+            s->size += x, p += x, count -= x;
+            if(s->size == CHUNK_SIZE) submit();
+            
+        }
+        
+    }
+    typename D::Type finish() {
+        
+        if(state->size) submit();
+        wait();
+        return state->digest.finish();
+        
+    }
+    
+};
+
+}
+
+// Passes everything through to the wrapped stream and hashes it on the way; finish() returns the digest of all bytes
+// written since construction or the previous finish()
+template <typename D>
+class DigestOutputStream : public OutputStream<char> {
+    
+private:
+    
+    OutputStream<char>* os;
+    Impl::DigestFeeder<D> feeder;
+    
+public:
+    
+    DigestOutputStream(OutputStream<char>& os_, ThreadPoolExecutor* executor = nullptr) : os(&os_), feeder(executor) {}
+    DigestOutputStream(DigestOutputStream&& src) : os(src.os), feeder(std::move(src.feeder)) { src.os = nullptr; }
+    ~DigestOutputStream() override = default;
+    
+    DigestOutputStream& operator =(DigestOutputStream&& src) {
+        
+        os = src.os, src.os = nullptr;
+        feeder = std::move(src.feeder);
+        return *this;
+        
+    }
+    
+    std::size_t write(const char* buffer, std::size_t count) override {
+        
+        count = os->write(buffer, count);
+        feeder.update(buffer, count);
+        return count;
+        
+    }
+    void flush() override { os->flush(); }
+    
+    typename D::Type finish() { return feeder.finish(); }
+    
+};
+
+template <typename D>
+inline DigestOutputStream<D> createDigestOutputStream(OutputStream<char>& os, ThreadPoolExecutor* executor = nullptr) { return DigestOutputStream<D>(os, executor); }
+
+}
+}
+}
+
+
+#endif
@@ -0,0 +1,153 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2016-2018 The Cats Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef CATS_CORECAT_DATA_STREAM_FDINPUTSTREAM_HPP
+#define CATS_CORECAT_DATA_STREAM_FDINPUTSTREAM_HPP
+
+
+#include <cerrno>
+
+#include "InputStream.hpp"
+#include "../../Concurrent/Promise.hpp"
+#include "../../System/OS.hpp"
+#include "../../Util/Exception.hpp"
+
+#if defined(CORECAT_OS_LINUX) || defined(CORECAT_OS_MACOS)
+#   include <poll.h>
+#   include <unistd.h>
+#else
+#   error Unknown OS
+#endif
+
+
+namespace Cats {
+namespace Corecat {
+inline namespace Data {
+
+// Works on blocking and non-blocking descriptors alike: read() waits for data when the descriptor would block,
+// readAsync() waits on a Loop such as EventLoop instead
+class FdInputStream : public InputStream<char> {
+    
+private:
+    
+    int fd;
+    bool owned;
+    
+private:
+    
+    template <typename Loop>
+    static void readAsyncImpl(Loop& loop, int fd, char* buffer, std::size_t count, const Promise<std::size_t>& promise) {
+        
+        ssize_t n;
+        do
+            n = ::read(fd, buffer, count);
+        while(n < 0 && errno == EINTR);
+        if(n >= 0) promise.resolve(std::size_t(n));
+        else if(errno == EAGAIN || errno == EWOULDBLOCK) {
+            
+            auto& l = loop;
+            loop.waitReadable(fd)
+                .then([&l, fd, buffer, count, promise] { readAsyncImpl(l, fd, buffer, count, promise); })
+                .fail([promise](const ExceptionPtr& e) { promise.reject(e); });
+                
+        } else promise.reject(IOException("::read failed"));
+        
+    }
+    
+public:
+    
+    FdInputStream(int fd_, bool owned_ = true) : fd(fd_), owned(owned_) {}
+    FdInputStream(const FdInputStream& src) = delete;
+    FdInputStream(FdInputStream&& src) : fd(src.fd), owned(src.owned) { src.fd = -1; }
+    ~FdInputStream() override { close(); }
+    
+    FdInputStream& operator =(const FdInputStream& src) = delete;
+    FdInputStream& operator =(FdInputStream&& src) {
+        
+        close();
+        fd = src.fd, src.fd = -1, owned = src.owned;
+        return *this;
+        
+    }
+    
+    std::size_t read(char* buffer, std::size_t count) override {
+        
+        while(true) {
+            
+            ssize_t n = ::read(fd, buffer, count);
+            if(n >= 0) return std::size_t(n);
+            if(errno == EAGAIN || errno == EWOULDBLOCK) {
+                
+                pollfd p = {fd, POLLIN, 0};
+                ::poll(&p, 1, -1);
+                
+            } else if(errno != EINTR)
+                throw IOException("::read failed");
+                
+        }
+        
+    }
+    void skip(std::size_t count) override {
+        
+        char buffer[4096];
+        while(count) {
+            
+            auto n = read(buffer, count < sizeof(buffer) ? count : sizeof(buffer));
+            if(!n) break;
+            count -= n;
+            
+        }
+        
+    }
+    
+    // Resolves with the number of bytes read, 0 at end of stream; buffer must outlive the promise
+    template <typename Loop>
+    Promise<std::size_t> readAsync(Loop& loop, char* buffer, std::size_t count) {
+        
+        Promise<std::size_t> promise;
+        readAsyncImpl(loop, fd, buffer, count, promise);
+        return promise;
+        
+    }
+    
+    int getFd() const noexcept { return fd; }
+    void close() {
+        
+        if(fd >= 0 && owned) ::close(fd);
+        fd = -1;
+        
+    }
+    
+};
+
+inline FdInputStream createFdInputStream(int fd, bool owned = true) { return FdInputStream(fd, owned); }
+
+}
+}
+}
+
+
+#endif
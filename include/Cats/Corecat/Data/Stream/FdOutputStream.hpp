@@ -0,0 +1,142 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2016-2018 The Cats Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef CATS_CORECAT_DATA_STREAM_FDOUTPUTSTREAM_HPP
+#define CATS_CORECAT_DATA_STREAM_FDOUTPUTSTREAM_HPP
+
+
+#include <cerrno>
+
+#include "OutputStream.hpp"
+#include "../../Concurrent/Promise.hpp"
+#include "../../System/OS.hpp"
+#include "../../Util/Exception.hpp"
+
+#if defined(CORECAT_OS_LINUX) || defined(CORECAT_OS_MACOS)
+#   include <poll.h>
+#   include <unistd.h>
+#else
+#   error Unknown OS
+#endif
+
+
+namespace Cats {
+namespace Corecat {
+inline namespace Data {
+
+// Works on blocking and non-blocking descriptors alike: write() waits for room when the descriptor would block,
+// writeAsync() waits on a Loop such as EventLoop instead
+class FdOutputStream : public OutputStream<char> {
+    
+private:
+    
+    int fd;
+    bool owned;
+    
+private:
+    
+    template <typename Loop>
+    static void writeAsyncImpl(Loop& loop, int fd, const char* buffer, std::size_t count, const Promise<std::size_t>& promise) {
+        
+        ssize_t n;
+        do
+            n = ::write(fd, buffer, count);
+        while(n < 0 && errno == EINTR);
+        if(n >= 0) promise.resolve(std::size_t(n));
+        else if(errno == EAGAIN || errno == EWOULDBLOCK) {
+            
+            auto& l = loop;
+            loop.waitWritable(fd)
+                .then([&l, fd, buffer, count, promise] { writeAsyncImpl(l, fd, buffer, count, promise); })
+                .fail([promise](const ExceptionPtr& e) { promise.reject(e); });
+                
+        } else promise.reject(IOException("::write failed"));
+        
+    }
+    
+public:
+    
+    FdOutputStream(int fd_, bool owned_ = true) : fd(fd_), owned(owned_) {}
+    FdOutputStream(const FdOutputStream& src) = delete;
+    FdOutputStream(FdOutputStream&& src) : fd(src.fd), owned(src.owned) { src.fd = -1; }
+    ~FdOutputStream() override { close(); }
+    
+    FdOutputStream& operator =(const FdOutputStream& src) = delete;
+    FdOutputStream& operator =(FdOutputStream&& src) {
+        
+        close();
+        fd = src.fd, src.fd = -1, owned = src.owned;
+        return *this;
+        
+    }
+    
+    std::size_t write(const char* buffer, std::size_t count) override {
+        
+        while(true) {
+            
+            ssize_t n = ::write(fd, buffer, count);
+            if(n >= 0) return std::size_t(n);
+            if(errno == EAGAIN || errno == EWOULDBLOCK) {
+                
+                pollfd p = {fd, POLLOUT, 0};
+                ::poll(&p, 1, -1);
+                
+            } else if(errno != EINTR)
+                throw IOException("::write failed");
+                
+        }
+        
+    }
+    void flush() override {}
+    
+    // Resolves with the number of bytes written, which may be less than count; buffer must outlive the promise
+    template <typename Loop>
+    Promise<std::size_t> writeAsync(Loop& loop, const char* buffer, std::size_t count) {
+        
+        Promise<std::size_t> promise;
+        writeAsyncImpl(loop, fd, buffer, count, promise);
+        return promise;
+        
+    }
+    
+    int getFd() const noexcept { return fd; }
+    void close() {
+        
+        if(fd >= 0 && owned) ::close(fd);
+        fd = -1;
+        
+    }
+    
+};
+
+inline FdOutputStream createFdOutputStream(int fd, bool owned = true) { return FdOutputStream(fd, owned); }
+
+}
+}
+}
+
+
+#endif
@@ -0,0 +1,126 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2016-2018 The Cats Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef CATS_CORECAT_DATA_STREAM_INFLATEINPUTSTREAM_HPP
+#define CATS_CORECAT_DATA_STREAM_INFLATEINPUTSTREAM_HPP
+
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include <zlib.h>
+
+#include "DeflateOutputStream.hpp"
+#include "InputStream.hpp"
+#include "../../Util/Exception.hpp"
+
+
+namespace Cats {
+namespace Corecat {
+inline namespace Data {
+
+// Needs zlib at link time. Decoding is inherently sequential, so streams written in block mode decode the same way
+class InflateInputStream : public InputStream<char> {
+    
+private:
+    
+    InputStream<char>* is;
+    std::unique_ptr<z_stream> stream;
+    std::vector<char> data;
+    bool ended = false;
+    
+public:
+    
+    InflateInputStream(InputStream<char>& is_, DeflateFormat format = DeflateFormat::ZLIB) : is(&is_), stream(new z_stream()), data(65536) {
+        
+        if(inflateInit2(stream.get(), Impl::getDeflateWindowBits(format)) != Z_OK)
+            throw InvalidArgumentException("::inflateInit2 failed");
+            
+    }
+    InflateInputStream(const InflateInputStream& src) = delete;
+    InflateInputStream(InflateInputStream&& src) : is(src.is), stream(std::move(src.stream)), data(std::move(src.data)), ended(src.ended) { src.is = nullptr; }
+    ~InflateInputStream() override { if(stream) inflateEnd(stream.get()); }
+    
+    InflateInputStream& operator =(const InflateInputStream& src) = delete;
+    InflateInputStream& operator =(InflateInputStream&& src) {
+        
+        if(stream) inflateEnd(stream.get());
+        is = src.is, src.is = nullptr;
+        stream = std::move(src.stream), data = std::move(src.data), ended = src.ended;
+        return *this;
+        
+    }
+    
+    std::size_t read(char* buffer, std::size_t count) override {
+        
+        if(ended || !count) return 0;
+        // avail_out is only a uInt, and a short read is allowed
+        count = std::min<std::size_t>(count, std::numeric_limits<uInt>::max());
+        stream->next_out = reinterpret_cast<Bytef*>(buffer);
+        stream->avail_out = uInt(count);
+        while(stream->avail_out == count) {
+            
+            if(!stream->avail_in) {
+                
+                auto c = is->read(data.data(), data.size());
+                if(!c) throw IOException("Unexpected end of deflate stream");
+                stream->next_in = reinterpret_cast<Bytef*>(data.data());
+                stream->avail_in = uInt(c);
+                
+            }
+            int ret = ::inflate(stream.get(), Z_NO_FLUSH);
+            if(ret == Z_STREAM_END) { ended = true; break; }
+            if(ret != Z_OK && ret != Z_BUF_ERROR) throw IOException("::inflate failed");
+            
+        }
+        return count - stream->avail_out;
+        
+    }
+    void skip(std::size_t count) override {
+        
+        char buffer[4096];
+        while(count) {
+            
+            auto c = read(buffer, std::min(count, sizeof(buffer)));
+            if(!c) break;
+            count -= c;
+            
+        }
+        
+    }
+    
+};
+
+inline InflateInputStream createInflateInputStream(InputStream<char>& is, DeflateFormat format = DeflateFormat::ZLIB) { return InflateInputStream(is, format); }
+
+}
+}
+}
+
+
+#endif
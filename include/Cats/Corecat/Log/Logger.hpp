@@ -0,0 +1,500 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2016-2018 The Cats Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef CATS_CORECAT_LOG_LOGGER_HPP
+#define CATS_CORECAT_LOG_LOGGER_HPP
+
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../Data/Stream/BufferedOutputStream.hpp"
+#include "../Data/Stream/OutputStream.hpp"
+#include "../Text/Formatter.hpp"
+#include "../Text/String.hpp"
+#include "../Util/Bit.hpp"
+
+
+namespace Cats {
+namespace Corecat {
+inline namespace Log {
+
+// Prefixed, since ERROR and DEBUG are often macros
+enum class LogLevel { LOG_TRACE, LOG_DEBUG, LOG_INFO, LOG_WARNING, LOG_ERROR, LOG_FATAL };
+
+inline StringView8 getLogLevelName(LogLevel level) noexcept {
+    
+    static const char* const NAME[] = {"TRACE", "DEBUG", "INFO", "WARNING", "ERROR", "FATAL"};
+    return NAME[int(level)];
+    
+}
+
+
+namespace Impl {
+
+// Records and the arguments in them are aligned to this
+constexpr std::size_t LOG_ALIGN = alignof(std::max_align_t);
+
+constexpr std::size_t alignLog(std::size_t x, std::size_t align = LOG_ALIGN) noexcept { return (x + align - 1) & ~(align - 1); }
+
+// A record starts with this header, followed by its arguments from offset LOG_HEADER; one without write only pads the
+// rest of the ring
+struct LogRecordHeader {
+    
+    void (*write)(String8& line, char* data);
+    std::uint32_t size;
+    LogLevel level;
+    
+};
+
+constexpr std::size_t LOG_HEADER = alignLog(sizeof(LogRecordHeader));
+
+// A ring of records with a single producer, the thread that owns it, and a single consumer, the logger thread. Each
+// side keeps a copy of the other's position and reads the shared one only when the ring looks full or empty.
+class LogRing {
+    
+private:
+    
+    std::unique_ptr<char[]> data;
+    std::size_t capacity;
+    std::atomic<bool> closed = {false};
+    std::atomic<bool> detached = {false};
+    
+    // Producer side
+    char padding0[64];
+    std::atomic<std::size_t> tail = {0};
+    std::size_t cachedHead = 0;
+    std::size_t reserved = 0;
+    
+    // Consumer side
+    char padding1[64];
+    std::atomic<std::size_t> head = {0};
+    std::size_t cachedTail = 0;
+    char padding2[64];
+    
+public:
+    
+    // capacity must be a power of 2. The memory is touched here, so that log() does not take its page faults
+    LogRing(std::size_t capacity_) : data(new char[capacity_]), capacity(capacity_) { std::memset(data.get(), 0, capacity); }
+    LogRing(const LogRing& src) = delete;
+    
+    LogRing& operator =(const LogRing& src) = delete;
+    
+    // Space for a record of size bytes, a multiple of LOG_ALIGN up to half the capacity, or nullptr while the consumer
+    // has not freed enough. A record that would run past the end goes to the start instead.
+    char* reserve(std::size_t size) noexcept {
+        
+        std::size_t pos = tail.load(std::memory_order_relaxed), offset = pos & (capacity - 1);
+        std::size_t pad = offset + size > capacity ? capacity - offset : 0;
+        if(pos + pad + size - cachedHead > capacity) {
+            
+            cachedHead = head.load(std::memory_order_acquire);
+            if(pos + pad + size - cachedHead > capacity) return nullptr;
+            
+        }
+        if(pad) {
+            
+            auto header = reinterpret_cast<LogRecordHeader*>(data.get() + offset);
+            header->write = nullptr, header->size = std::uint32_t(pad);
+            offset = 0;
+            
+        }
+        reserved = pos + pad + size;
+        return data.get() + offset;
+        
+    }
+    // Publishes the record returned by the last reserve()
+    void commit() noexcept { tail.store(reserved, std::memory_order_release); }
+    // Whether more than half the ring is in use, as seen by the producer
+    bool isHalfFull() noexcept {
+        
+        return reserved - cachedHead > capacity / 2 && reserved - (cachedHead = head.load(std::memory_order_acquire)) > capacity / 2;
+        
+    }
+    
+    // Calls f(header, arguments) for the records published so far, freeing each after it; false if there were none
+    template <typename F>
+    bool consume(F&& f) {
+        
+        std::size_t pos = head.load(std::memory_order_relaxed);
+        if(pos == cachedTail && (cachedTail = tail.load(std::memory_order_acquire)) == pos) return false;
+        while(pos != cachedTail) {
+            
+            auto header = reinterpret_cast<LogRecordHeader*>(data.get() + (pos & (capacity - 1)));
+            if(header->write) f(*header, reinterpret_cast<char*>(header) + LOG_HEADER);
+            pos += header->size;
+            head.store(pos, std::memory_order_release);
+            
+        }
+        return true;
+        
+    }
+    bool isEmpty() const noexcept { return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire); }
+    
+    // The producer thread has exited; the consumer drops the ring once it is empty
+    void close() noexcept { closed.store(true, std::memory_order_release); }
+    bool isClosed() const noexcept { return closed.load(std::memory_order_acquire); }
+    // The logger is gone; the producer drops the ring when it next looks for one
+    void detach() noexcept { detached.store(true, std::memory_order_release); }
+    bool isDetached() const noexcept { return detached.load(std::memory_order_acquire); }
+    
+};
+
+// How an argument of type T is kept in a record: copied in place, and read back as a const reference
+template <typename T, typename = void>
+struct LogArgument {
+    
+    static_assert(alignof(T) <= LOG_ALIGN, "Over-aligned log argument");
+    
+    static constexpr std::size_t ALIGN = alignof(T);
+    
+    static std::size_t getSize(const T&) noexcept { return sizeof(T); }
+    static void store(char* p, const T& t) { new(p) T(t); }
+    static std::size_t getStoredSize(const char*) noexcept { return sizeof(T); }
+    static const T& load(char* p) noexcept { return *reinterpret_cast<const T*>(p); }
+    static void destroy(char* p) noexcept { reinterpret_cast<T*>(p)->~T(); }
+    
+};
+// Strings are copied as their length and units, since the original may be gone by the time the record is written
+struct LogStringArgument {
+    
+    static constexpr std::size_t ALIGN = alignof(std::size_t);
+    
+    static std::size_t getSize(StringView8 str) noexcept { return sizeof(std::size_t) + str.getLength(); }
+    static void store(char* p, StringView8 str) noexcept {
+        
+        std::size_t length = str.getLength();
+        std::memcpy(p, &length, sizeof(length));
+        std::memcpy(p + sizeof(length), str.getData(), length);
+        
+    }
+    static std::size_t getStoredSize(const char* p) noexcept {
+        
+        std::size_t length;
+        std::memcpy(&length, p, sizeof(length));
+        return sizeof(length) + length;
+        
+    }
+    static StringView8 load(char* p) noexcept { return {p + sizeof(std::size_t), getStoredSize(p) - sizeof(std::size_t)}; }
+    static void destroy(char*) noexcept {}
+    
+};
+template <>
+struct LogArgument<const char*> : LogStringArgument {};
+template <>
+struct LogArgument<char*> : LogStringArgument {};
+template <>
+struct LogArgument<StringView8> : LogStringArgument {};
+template <>
+struct LogArgument<String8> : LogStringArgument {};
+
+// Lays out the arguments of one log() call site, formatted later with the stateless formatter F
+template <typename F, typename... T>
+struct LogRecord {
+    
+    using Expand = int[];
+    
+    static std::size_t getSize(const T&... t) noexcept {
+        
+        std::size_t size = LOG_HEADER;
+        (void)Expand{0, (size = alignLog(size, LogArgument<T>::ALIGN) + LogArgument<T>::getSize(t), 0)...};
+        return alignLog(size);
+        
+    }
+    static void store(char* p, std::size_t size, LogLevel level, const T&... t) {
+        
+        std::size_t offset = LOG_HEADER;
+        (void)Expand{0, (offset = alignLog(offset, LogArgument<T>::ALIGN), LogArgument<T>::store(p + offset, t), offset += LogArgument<T>::getSize(t), 0)...};
+        auto header = reinterpret_cast<LogRecordHeader*>(p);
+        header->write = &write, header->size = std::uint32_t(size), header->level = level;
+        
+    }
+    
+    template <std::size_t... I>
+    static void format(String8& line, char* const* p, std::index_sequence<I...>) { F().formatTo(line, LogArgument<T>::load(p[I])...); }
+    template <std::size_t... I>
+    static void destroy(char* const* p, std::index_sequence<I...>) noexcept { (void)Expand{0, (LogArgument<T>::destroy(p[I]), 0)...}; }
+    static void write(String8& line, char* data) {
+        
+        char* p[sizeof...(T) + 1];
+        std::size_t offset = 0, i = 0;
+        (void)Expand{0, (offset = alignLog(offset, LogArgument<T>::ALIGN), p[i++] = data + offset, offset += LogArgument<T>::getStoredSize(data + offset), 0)...};
+        (void)i;
+        try { format(line, p, std::index_sequence_for<T...>()); } catch(...) { destroy(p, std::index_sequence_for<T...>()); throw; }
+        destroy(p, std::index_sequence_for<T...>());
+        
+    }
+    
+};
+
+// The rings of the calling thread, one per logger it has used
+struct LogThreadState {
+    
+    std::uint64_t lastId = 0;
+    LogRing* last = nullptr;
+    std::vector<std::pair<std::uint64_t, std::shared_ptr<LogRing>>> ring;
+    
+    ~LogThreadState() { for(auto&& x : ring) x.second->close(); }
+    
+};
+
+inline LogThreadState& getLogThreadState() noexcept {
+    
+    static thread_local LogThreadState state;
+    return state;
+    
+}
+
+}
+
+
+// An asynchronous logger. log() copies the arguments into a ring owned by the calling thread and returns; a thread of
+// the logger's own formats the records into lines of "[LEVEL] message" and writes them to the stream through a
+// BufferedOutputStream, flushed whenever the rings run empty. The stream is only touched by that thread, which looks
+// at the rings every 10 ms when idle and is woken sooner only by a ring passing half full or by flush(), so log()
+// makes no system call on its own.
+//
+// Records from one thread keep their order; records from different threads are not ordered with each other. A full
+// ring makes log() wait for the logger thread, and a record larger than half a ring is dropped.
+class Logger {
+    
+private:
+    
+    static std::uint64_t getNextId() noexcept {
+        
+        static std::atomic<std::uint64_t> nextId = {1};
+        return nextId.fetch_add(1, std::memory_order_relaxed);
+        
+    }
+    
+    std::uint64_t id = getNextId();
+    std::size_t ringSize;
+    std::atomic<LogLevel> level;
+    BufferedOutputStream<char> stream;
+    
+    std::mutex ringMutex;
+    std::vector<std::shared_ptr<Impl::LogRing>> ring;
+    
+    std::mutex waitMutex;
+    std::condition_variable condition;
+    std::condition_variable flushCondition;
+    std::atomic<bool> sleeping = {false};
+    std::atomic<bool> stopping = {false};
+    std::atomic<std::uint64_t> flushRequest = {0};
+    std::atomic<std::uint64_t> flushDone = {0};
+    std::thread thread;
+    
+private:
+    
+    Impl::LogRing& getRing() {
+        
+        auto& state = Impl::getLogThreadState();
+        if(state.lastId == id) return *state.last;
+        
+        state.ring.erase(std::remove_if(state.ring.begin(), state.ring.end(), [](auto&& x) { return x.second->isDetached(); }), state.ring.end());
+        auto it = std::find_if(state.ring.begin(), state.ring.end(), [&](auto&& x) { return x.first == id; });
+        if(it == state.ring.end()) {
+            
+            auto r = std::make_shared<Impl::LogRing>(ringSize);
+            {
+                std::lock_guard<std::mutex> lock(ringMutex);
+                ring.push_back(r);
+            }
+            state.ring.emplace_back(id, std::move(r));
+            it = state.ring.end() - 1;
+            
+        }
+        state.lastId = id, state.last = it->second.get();
+        return *state.last;
+        
+    }
+    
+    void wake() {
+        
+        if(sleeping.exchange(false)) {
+            
+            std::lock_guard<std::mutex> lock(waitMutex);
+            condition.notify_one();
+            
+        }
+        
+    }
+    
+    bool isIdle() {
+        
+        std::lock_guard<std::mutex> lock(ringMutex);
+        return std::all_of(ring.begin(), ring.end(), [](auto&& x) { return x->isEmpty(); });
+        
+    }
+    
+    void run() {
+        
+        String8 line;
+        bool dirty = false;
+        auto write = [&](const Impl::LogRecordHeader& header, char* data) {
+            
+            try {
+                
+                line.clear();
+                line += '[', line += getLogLevelName(header.level), line += "] ";
+                header.write(line, data);
+                line += '\n';
+                stream.writeAll(line.getData(), line.getLength());
+                dirty = true;
+                
+            } catch(...) {}
+            
+        };
+        while(true) {
+            
+            // Whatever was published before these were read is written out by the end of the pass
+            std::uint64_t request = flushRequest.load(std::memory_order_acquire);
+            bool stop = stopping.load(std::memory_order_acquire);
+            bool busy = false;
+            {
+                std::lock_guard<std::mutex> lock(ringMutex);
+                for(auto it = ring.begin(); it != ring.end(); ) {
+                    
+                    busy |= (*it)->consume(write);
+                    if((*it)->isClosed() && (*it)->isEmpty()) it = ring.erase(it);
+                    else ++it;
+                    
+                }
+            }
+            // A pending flush is answered after every pass, so that a steady stream of records cannot hold it back
+            bool flushing = request != flushDone.load(std::memory_order_relaxed);
+            if(busy && !flushing) continue;
+            
+            if(dirty) {
+                
+                try { stream.flush(); } catch(...) {}
+                dirty = false;
+                
+            }
+            if(flushing) {
+                
+                {
+                    std::lock_guard<std::mutex> lock(waitMutex);
+                    flushDone.store(request, std::memory_order_release);
+                }
+                flushCondition.notify_all();
+                
+            }
+            if(stop) break;
+            if(busy) continue;
+            
+            sleeping.store(true);
+            if(!isIdle() || flushRequest.load() != request || stopping.load()) { sleeping.store(false); continue; }
+            std::unique_lock<std::mutex> lock(waitMutex);
+            condition.wait_for(lock, std::chrono::milliseconds(10), [&] { return !sleeping.load(); });
+            sleeping.store(false);
+            
+        }
+        
+    }
+    
+public:
+    
+    // ringSize is the size in bytes of each thread's ring, rounded up to a power of 2
+    Logger(OutputStream<char>& stream_, LogLevel level_ = LogLevel::LOG_INFO, std::size_t ringSize_ = 262144) :
+        ringSize(std::size_t(1) << (64 - countLeadingZero(std::uint64_t(std::max<std::size_t>(ringSize_, 4096) - 1)))),
+        level(level_), stream(stream_), thread([this] { run(); }) {}
+    Logger(const Logger& src) = delete;
+    ~Logger() {
+        
+        stopping.store(true);
+        wake();
+        thread.join();
+        std::lock_guard<std::mutex> lock(ringMutex);
+        for(auto&& x : ring) x->detach();
+        
+    }
+    
+    Logger& operator =(const Logger& src) = delete;
+    
+    LogLevel getLevel() const noexcept { return level.load(std::memory_order_relaxed); }
+    void setLevel(LogLevel level_) noexcept { level.store(level_, std::memory_order_relaxed); }
+    bool isEnabled(LogLevel level_) const noexcept { return level_ >= level.load(std::memory_order_relaxed); }
+    
+    // Queues a record formatted by format, a stateless formatter such as the one CORECAT_FORMAT creates. Strings are
+    // copied; any other argument is copied as it is, so pointers must stay valid until the record is written.
+    template <typename F, typename... Arg>
+    void log(LogLevel level_, F, Arg&&... arg) {
+        
+        static_assert(std::is_empty<F>::value, "Log format must be a stateless formatter");
+        using R = Impl::LogRecord<F, std::decay_t<Arg>...>;
+        
+        if(!isEnabled(level_)) return;
+        std::size_t size = R::getSize(arg...);
+        if(size > ringSize / 2) return;
+        auto& r = getRing();
+        char* p;
+        while(!(p = r.reserve(size))) wake(), std::this_thread::yield();
+        R::store(p, size, level_, arg...);
+        r.commit();
+        if(r.isHalfFull() && sleeping.load(std::memory_order_relaxed)) wake();
+        
+    }
+    
+    // Waits until everything logged before the call has been written and the stream flushed
+    void flush() {
+        
+        std::uint64_t request = flushRequest.fetch_add(1) + 1;
+        wake();
+        std::unique_lock<std::mutex> lock(waitMutex);
+        flushCondition.wait(lock, [&] { return flushDone.load(std::memory_order_acquire) >= request; });
+        
+    }
+    
+};
+
+}
+}
+}
+
+// Logs through logger when level is enabled, evaluating the arguments only then; format is a string literal parsed
+// during compilation, as with CORECAT_FORMAT
+#define CORECAT_LOG(logger, level, format, ...) do { \
+    auto& corecatLogger = (logger); \
+    auto corecatLevel = (level); \
+    if(corecatLogger.isEnabled(corecatLevel)) corecatLogger.log(corecatLevel, CORECAT_FORMAT(format), ##__VA_ARGS__); \
+} while(0)
+
+
+#endif
@@ -39,5 +39,19 @@
 #   define CORECAT_COMPILER "MSVC"
 #endif
 
+// Enables an instruction set extension for a single function, so that it can be selected at runtime
+#if defined(CORECAT_COMPILER_CLANG) || defined(CORECAT_COMPILER_GCC)
+#   define CORECAT_TARGET(x) __attribute__((target(x)))
+#else
+#   define CORECAT_TARGET(x)
+#endif
+
+// For functions that read past the end of an object on purpose, staying within the same page
+#if defined(CORECAT_COMPILER_CLANG) || defined(CORECAT_COMPILER_GCC)
+#   define CORECAT_NO_SANITIZE_ADDRESS __attribute__((no_sanitize_address))
+#else
+#   define CORECAT_NO_SANITIZE_ADDRESS
+#endif
+
 
 #endif
@@ -0,0 +1,96 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2016-2018 The Cats Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef CATS_CORECAT_SYSTEM_PIPE_HPP
+#define CATS_CORECAT_SYSTEM_PIPE_HPP
+
+
+#include "OS.hpp"
+#include "../Util/Exception.hpp"
+
+#if defined(CORECAT_OS_LINUX) || defined(CORECAT_OS_MACOS)
+#   include <fcntl.h>
+#   include <unistd.h>
+#   include <sys/socket.h>
+#else
+#   error Unknown OS
+#endif
+
+
+namespace Cats {
+namespace Corecat {
+inline namespace System {
+
+inline void setNonBlocking(int fd, bool nonBlocking = true) {
+    
+    int flag = ::fcntl(fd, F_GETFL);
+    if(flag < 0 || ::fcntl(fd, F_SETFL, nonBlocking ? flag | O_NONBLOCK : flag & ~O_NONBLOCK) < 0)
+        throw SystemException("::fcntl failed");
+        
+}
+
+namespace Impl {
+
+inline void setupDescriptorPair(int (&fd)[2], bool nonBlocking) {
+    
+    for(int x : fd) {
+        
+        if(::fcntl(x, F_SETFD, FD_CLOEXEC) < 0 || (nonBlocking && ::fcntl(x, F_SETFL, ::fcntl(x, F_GETFL) | O_NONBLOCK) < 0)) {
+            
+            ::close(fd[0]);
+            ::close(fd[1]);
+            throw SystemException("::fcntl failed");
+            
+        }
+        
+    }
+    
+}
+
+}
+
+// fd[0] is the read end and fd[1] the write end; both are close-on-exec, so hand them to a child through ProcessOption
+inline void createPipe(int (&fd)[2], bool nonBlocking = false) {
+    
+    if(::pipe(fd))
+        throw SystemException("::pipe failed");
+    Impl::setupDescriptorPair(fd, nonBlocking);
+    
+}
+inline void createSocketPair(int (&fd)[2], bool nonBlocking = false) {
+    
+    if(::socketpair(AF_UNIX, SOCK_STREAM, 0, fd))
+        throw SystemException("::socketpair failed");
+    Impl::setupDescriptorPair(fd, nonBlocking);
+    
+}
+
+}
+}
+}
+
+
+#endif
@@ -36,6 +36,7 @@
 #if defined(CORECAT_OS_WINDOWS)
 #   include "../Win32/Handle.hpp"
 #elif defined(CORECAT_OS_LINUX) || defined(CORECAT_OS_MACOS)
+#   include <fcntl.h>
 #   include <unistd.h>
 #   include <sys/ioctl.h>
 #   include <sys/wait.h>
@@ -58,6 +59,10 @@ struct ProcessOption {
     const char* const* argument = nullptr;
     const char* const* environment = nullptr;
     const char* directory = nullptr;
+    // Descriptors to become the child's stdin, stdout and stderr (POSIX only, -1 to inherit)
+    int input = -1;
+    int output = -1;
+    int error = -1;
     
     ProcessOption(const char* file_, const char* const* argument_ = nullptr, const char* const* environment_ = nullptr, const char* directory_ = nullptr) :
         file(file_), argument(argument_), environment(environment_), directory(directory_) {}
@@ -259,6 +264,19 @@ private:
         }
         return environment;
         
+    }
+#else
+private:
+    
+    // Makes fd the child's descriptor target. dup2 does nothing when they are the same, so FD_CLOEXEC has to be
+    // cleared by hand there or the descriptor would be closed by the exec
+    static bool redirect(int fd, int target) noexcept {
+        
+        if(fd < 0) return true;
+        if(fd != target) return ::dup2(fd, target) >= 0;
+        int flag = ::fcntl(fd, F_GETFD);
+        return flag >= 0 && ::fcntl(fd, F_SETFD, flag & ~FD_CLOEXEC) >= 0;
+        
     }
 #endif
     
@@ -351,6 +369,8 @@ public:
                 if(option.environment) environ = const_cast<char**>(option.environment);
                 if(option.directory && ::chdir(option.directory))
                     break;
+                if(!redirect(option.input, 0) || !redirect(option.output, 1) || !redirect(option.error, 2))
+                    break;
                 ::execvp(option.file, const_cast<char* const*>(option.argument));
                 
             } while(false);
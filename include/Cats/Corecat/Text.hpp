@@ -30,7 +30,13 @@
 
 #include "Text/Charset.hpp"
 #include "Text/Formatter.hpp"
+#include "Text/JsonWriter.hpp"
+#include "Text/NumberParser.hpp"
+#include "Text/SharedString.hpp"
 #include "Text/String.hpp"
+#include "Text/StringBuilder.hpp"
+#include "Text/StringSearch.hpp"
+#include "Text/StringSplit.hpp"
 
 
 #endif
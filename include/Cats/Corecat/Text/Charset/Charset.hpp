@@ -29,14 +29,143 @@
 
 
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 
+#include <algorithm>
 #include <type_traits>
 
+#include "../../System/Architecture.hpp"
+#include "../../System/Compiler.hpp"
+#include "../../Util/Bit.hpp"
+
+#if defined(CORECAT_ARCHITECTURE_X86) || defined(CORECAT_ARCHITECTURE_X86_64)
+#   include <immintrin.h>
+#   include "../../X86/X86FeatureBase.hpp"
+#endif
+
 
 namespace Cats {
 namespace Corecat {
 inline namespace Text {
 
+namespace Impl {
+
+// Index of the first unit where a and b differ, or n. Units are compared as bytes, which is the same for equality
+template <typename T>
+inline std::size_t mismatchUnitScalar(const T* a, const T* b, std::size_t n) noexcept {
+    
+    std::size_t i = 0;
+    for(; i < n && a[i] == b[i]; ++i);
+    return i;
+    
+}
+template <typename T>
+inline std::size_t getLengthScalar(const T* str) noexcept {
+    
+    const T* end = str;
+    while(*end != T()) ++end;
+    return end - str;
+    
+}
+
+#if defined(CORECAT_ARCHITECTURE_X86) || defined(CORECAT_ARCHITECTURE_X86_64)
+template <typename T>
+CORECAT_TARGET("sse2") inline std::size_t mismatchUnitSSE2(const T* a, const T* b, std::size_t n) noexcept {
+    
+    constexpr std::size_t W = 16 / sizeof(T);
+    std::size_t i = 0;
+    for(; i + W <= n; i += W) {
+        
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)), y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        std::uint32_t mask = ~_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) & 0xFFFF;
+        if(mask) return i + countTrailingZero(mask) / sizeof(T);
+        
+    }
+    return i + mismatchUnitScalar(a + i, b + i, n - i);
+    
+}
+template <typename T>
+CORECAT_TARGET("avx2") inline std::size_t mismatchUnitAVX2(const T* a, const T* b, std::size_t n) noexcept {
+    
+    constexpr std::size_t W = 32 / sizeof(T);
+    std::size_t i = 0;
+    for(; i + W <= n; i += W) {
+        
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)), y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        std::uint32_t mask = ~std::uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y)));
+        if(mask) return i + countTrailingZero(mask) / sizeof(T);
+        
+    }
+    return i + mismatchUnitScalar(a + i, b + i, n - i);
+    
+}
+CORECAT_TARGET("sse2") inline std::uint32_t compareZeroSSE2(__m128i x, std::integral_constant<std::size_t, 2>) noexcept { return _mm_movemask_epi8(_mm_cmpeq_epi16(x, _mm_setzero_si128())); }
+CORECAT_TARGET("sse2") inline std::uint32_t compareZeroSSE2(__m128i x, std::integral_constant<std::size_t, 4>) noexcept { return _mm_movemask_epi8(_mm_cmpeq_epi32(x, _mm_setzero_si128())); }
+// A terminator search has to stay within the page it started in, so it only does aligned loads and masks off the
+// units before str; str must be aligned to its unit size
+template <typename T>
+CORECAT_TARGET("sse2") CORECAT_NO_SANITIZE_ADDRESS inline std::size_t getLengthSSE2(const T* str) noexcept {
+    
+    auto offset = reinterpret_cast<std::uintptr_t>(str) & 15;
+    auto p = reinterpret_cast<const __m128i*>(reinterpret_cast<const char*>(str) - offset);
+    std::uint32_t mask = compareZeroSSE2(_mm_load_si128(p), std::integral_constant<std::size_t, sizeof(T)>()) >> offset;
+    if(mask) return countTrailingZero(mask) / sizeof(T);
+    while(!(mask = compareZeroSSE2(_mm_load_si128(++p), std::integral_constant<std::size_t, sizeof(T)>())));
+    return (reinterpret_cast<const char*>(p) + countTrailingZero(mask) - reinterpret_cast<const char*>(str)) / sizeof(T);
+    
+}
+#endif
+
+template <typename T>
+inline std::size_t mismatchUnit(const T* a, const T* b, std::size_t n) noexcept {
+    
+#if defined(CORECAT_ARCHITECTURE_X86) || defined(CORECAT_ARCHITECTURE_X86_64)
+    if(X86FeatureBase::AVX2) return mismatchUnitAVX2(a, b, n);
+    if(X86FeatureBase::SSE2) return mismatchUnitSSE2(a, b, n);
+#endif
+    return mismatchUnitScalar(a, b, n);
+    
+}
+
+// Single-byte units go to the C library, whose strlen and memcmp are already vectorised; wider units use the
+// kernels above
+template <typename T, std::size_t N = sizeof(T)>
+struct CharsetKernel {
+    
+    static int compare(const T* a, const T* b, std::size_t n) noexcept {
+        
+        using U = std::make_unsigned_t<T>;
+        std::size_t i = mismatchUnit(a, b, n);
+        if(i == n) return 0;
+        return U(a[i]) < U(b[i]) ? -1 : 1;
+        
+    }
+    static std::size_t getLength(const T* str) noexcept {
+        
+#if defined(CORECAT_ARCHITECTURE_X86) || defined(CORECAT_ARCHITECTURE_X86_64)
+        if(X86FeatureBase::SSE2 && !(reinterpret_cast<std::uintptr_t>(str) % sizeof(T))) return getLengthSSE2(str);
+#endif
+        return getLengthScalar(str);
+        
+    }
+    
+};
+template <typename T>
+struct CharsetKernel<T, 1> {
+    
+    static int compare(const T* a, const T* b, std::size_t n) noexcept {
+        
+        int ret = n ? std::memcmp(a, b, n) : 0;
+        return (ret > 0) - (ret < 0);
+        
+    }
+    static std::size_t getLength(const T* str) noexcept { return std::strlen(reinterpret_cast<const char*>(str)); }
+    
+};
+
+}
+
 template <typename T>
 struct Charset {
     
@@ -47,25 +176,13 @@ struct Charset {
     
     static int compare(const T* begin1, const T* end1, const T* begin2, const T* end2) noexcept {
         
-        using U = std::make_unsigned_t<T>;
-        for(auto p = begin1, q = begin2; ; ++p, ++q) {
-            
-            bool m1 = p == end1, m2 = q == end2;
-            if(m1 || m2) return m2 - m1;
-            T c1 = *p, c2 = *q;
-            if(c1 != c2) return U(c1) < U(c2) ? -1 : 1;
-            
-        }
+        std::size_t len1 = end1 - begin1, len2 = end2 - begin2;
+        int ret = Impl::CharsetKernel<T>::compare(begin1, begin2, std::min(len1, len2));
+        return ret ? ret : (len1 > len2) - (len1 < len2);
         
     }
     
-    static std::size_t getLength(const T* str) noexcept {
-        
-        const T* end = str;
-        while(*end != T()) ++end;
-        return end - str;
-        
-    }
+    static std::size_t getLength(const T* str) noexcept { return Impl::CharsetKernel<T>::getLength(str); }
     
 };
 
@@ -0,0 +1,382 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2016-2018 The Cats Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef CATS_CORECAT_TEXT_CHARSET_TRANSCODER_HPP
+#define CATS_CORECAT_TEXT_CHARSET_TRANSCODER_HPP
+
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <type_traits>
+
+#include "UTF8Charset.hpp"
+#include "UTF16Charset.hpp"
+#include "UTF32Charset.hpp"
+#include "../../System/Architecture.hpp"
+#include "../../System/Compiler.hpp"
+
+#if defined(CORECAT_ARCHITECTURE_X86) || defined(CORECAT_ARCHITECTURE_X86_64)
+#   include <immintrin.h>
+#   include "../../X86/X86FeatureBase.hpp"
+#endif
+
+
+namespace Cats {
+namespace Corecat {
+inline namespace Text {
+
+namespace Impl {
+
+// Writes one code point as UTF-16 or UTF-32 depending on the size of U
+template <typename U>
+inline void putCodePoint(U*& r, char32_t c) noexcept {
+    
+    if(sizeof(U) == 2 && c >= 0x10000) {
+        
+        *r++ = U(0xD800 | ((c - 0x10000) >> 10));
+        *r++ = U(0xDC00 | ((c - 0x10000) & 0x3FF));
+    
+    } else *r++ = U(c);
+    
+}
+// Decodes one sequence that is already known to be well-formed
+inline char32_t decodeValidUTF8(const unsigned char*& p) noexcept {
+    
+    char32_t a = *p;
+    if(a <= 0x7F) { ++p; return a; }
+    else if(a <= 0xDF) { a = ((a & 0x1F) << 6) | (p[1] & 0x3F); p += 2; return a; }
+    else if(a <= 0xEF) { a = ((a & 0x0F) << 12) | ((p[1] & 0x3F) << 6) | (p[2] & 0x3F); p += 3; return a; }
+    else { a = ((a & 0x07) << 18) | ((p[1] & 0x3F) << 12) | ((p[2] & 0x3F) << 6) | (p[3] & 0x3F); p += 4; return a; }
+    
+}
+inline void encodeUTF8(unsigned char*& r, char32_t c) noexcept {
+    
+    if(c <= 0x7F) *r++ = static_cast<unsigned char>(c);
+    else if(c <= 0x7FF) {
+        
+        r[0] = static_cast<unsigned char>(0xC0 | (c >> 6));
+        r[1] = static_cast<unsigned char>(0x80 | (c & 0x3F));
+        r += 2;
+        
+    } else if(c <= 0xFFFF) {
+        
+        r[0] = static_cast<unsigned char>(0xE0 | (c >> 12));
+        r[1] = static_cast<unsigned char>(0x80 | ((c >> 6) & 0x3F));
+        r[2] = static_cast<unsigned char>(0x80 | (c & 0x3F));
+        r += 3;
+        
+    } else {
+        
+        r[0] = static_cast<unsigned char>(0xF0 | (c >> 18));
+        r[1] = static_cast<unsigned char>(0x80 | ((c >> 12) & 0x3F));
+        r[2] = static_cast<unsigned char>(0x80 | ((c >> 6) & 0x3F));
+        r[3] = static_cast<unsigned char>(0x80 | (c & 0x3F));
+        r += 4;
+        
+    }
+    
+}
+// Reads one UTF-16 or UTF-32 code point; returns 0xFFFFFFFF, leaving p alone, if it is not well-formed
+template <typename U>
+inline char32_t decodeUTF16Or32(const U*& p, const U* q) noexcept {
+    
+    char32_t c = static_cast<std::uint32_t>(*p) & (sizeof(U) == 2 ? 0xFFFF : 0xFFFFFFFF);
+    if(c - 0xD800 >= 0x0800) {
+        
+        if(c > 0x10FFFF) return 0xFFFFFFFF;
+        ++p;
+        return c;
+        
+    }
+    if(sizeof(U) != 2 || c > 0xDBFF || q - p < 2) return 0xFFFFFFFF;
+    char32_t l = static_cast<std::uint32_t>(p[1]) & 0xFFFF;
+    if(l - 0xDC00 >= 0x0400) return 0xFFFFFFFF;
+    p += 2;
+    return 0x10000 + (((c & 0x3FF) << 10) | (l & 0x3FF));
+    
+}
+
+// The kernels below convert the longest well-formed prefix of [p, q) and leave p at the first code unit they could
+// not take, which the caller hands to the scalar charset for replacement. Runs of ASCII are moved a vector at a time.
+
+template <typename U>
+inline U* convertUTF8Scalar(const unsigned char*& p, const unsigned char* q, U* r) noexcept {
+    
+    while(p != q) {
+        
+        if(q - p >= 8) {
+            
+            std::uint64_t x;
+            std::memcpy(&x, p, 8);
+            if(!(x & 0x8080808080808080)) {
+                
+                for(std::size_t i = 0; i < 8; ++i) r[i] = U(p[i]);
+                p += 8, r += 8;
+                continue;
+                
+            }
+            
+        }
+        putCodePoint(r, decodeValidUTF8(p));
+        
+    }
+    return r;
+    
+}
+template <typename U>
+inline unsigned char* convertToUTF8Scalar(const U*& p, const U* q, unsigned char* r) noexcept {
+    
+    while(p != q) {
+        
+        char32_t c = decodeUTF16Or32(p, q);
+        if(c == 0xFFFFFFFF) break;
+        encodeUTF8(r, c);
+        
+    }
+    return r;
+    
+}
+
+#if defined(CORECAT_ARCHITECTURE_X86) || defined(CORECAT_ARCHITECTURE_X86_64)
+template <typename U>
+CORECAT_TARGET("sse2") inline U* convertUTF8SSE2(const unsigned char*& p, const unsigned char* q, U* r) noexcept {
+    
+    const __m128i zero = _mm_setzero_si128();
+    while(p != q) {
+        
+        if(q - p >= 16) {
+            
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            if(!_mm_movemask_epi8(x)) {
+                
+                __m128i l = _mm_unpacklo_epi8(x, zero), h = _mm_unpackhi_epi8(x, zero);
+                if(sizeof(U) == 2) {
+                    
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(r), l);
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(r + 8), h);
+                    
+                } else {
+                    
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(r), _mm_unpacklo_epi16(l, zero));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(r + 4), _mm_unpackhi_epi16(l, zero));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(r + 8), _mm_unpacklo_epi16(h, zero));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(r + 12), _mm_unpackhi_epi16(h, zero));
+                    
+                }
+                p += 16, r += 16;
+                continue;
+                
+            }
+            
+        }
+        // Multibyte text rarely has long ASCII runs, so stay scalar until an ASCII byte comes up
+        do putCodePoint(r, decodeValidUTF8(p)); while(p != q && *p >= 0x80);
+        
+    }
+    return r;
+    
+}
+template <typename U>
+CORECAT_TARGET("avx2") inline U* convertUTF8AVX2(const unsigned char*& p, const unsigned char* q, U* r) noexcept {
+    
+    while(p != q) {
+        
+        if(q - p >= 32) {
+            
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            if(!_mm256_movemask_epi8(x)) {
+                
+                __m128i l = _mm256_castsi256_si128(x), h = _mm256_extracti128_si256(x, 1);
+                if(sizeof(U) == 2) {
+                    
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(r), _mm256_cvtepu8_epi16(l));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(r + 16), _mm256_cvtepu8_epi16(h));
+                    
+                } else {
+                    
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(r), _mm256_cvtepu8_epi32(l));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(r + 8), _mm256_cvtepu8_epi32(_mm_srli_si128(l, 8)));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(r + 16), _mm256_cvtepu8_epi32(h));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(r + 24), _mm256_cvtepu8_epi32(_mm_srli_si128(h, 8)));
+                    
+                }
+                p += 32, r += 32;
+                continue;
+                
+            }
+            
+        }
+        do putCodePoint(r, decodeValidUTF8(p)); while(p != q && *p >= 0x80);
+        
+    }
+    return r;
+    
+}
+CORECAT_TARGET("sse2") inline __m128i packASCIISSE2(const __m128i* x, std::integral_constant<std::size_t, 2>) noexcept {
+    
+    return _mm_packus_epi16(x[0], x[1]);
+    
+}
+CORECAT_TARGET("sse2") inline __m128i packASCIISSE2(const __m128i* x, std::integral_constant<std::size_t, 4>) noexcept {
+    
+    return _mm_packus_epi16(_mm_packs_epi32(x[0], x[1]), _mm_packs_epi32(x[2], x[3]));
+    
+}
+template <typename U>
+CORECAT_TARGET("sse2") inline unsigned char* convertToUTF8SSE2(const U*& p, const U* q, unsigned char* r) noexcept {
+    
+    constexpr std::size_t N = 16 / sizeof(U);
+    const __m128i mask = sizeof(U) == 2 ? _mm_set1_epi16(short(0xFF80)) : _mm_set1_epi32(int(0xFFFFFF80));
+    while(p != q) {
+        
+        if(q - p >= 16) {
+            
+            // 16 code units take sizeof(U) vectors
+            __m128i x[sizeof(U)], any = _mm_setzero_si128();
+            for(std::size_t i = 0; i < sizeof(U); ++i)
+                x[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i * N)), any = _mm_or_si128(any, x[i]);
+            if(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(any, mask), _mm_setzero_si128())) == 0xFFFF) {
+                
+                __m128i y = packASCIISSE2(x, std::integral_constant<std::size_t, sizeof(U)>());
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(r), y);
+                p += 16, r += 16;
+                continue;
+                
+            }
+            
+        }
+        char32_t c;
+        do {
+            
+            c = decodeUTF16Or32(p, q);
+            if(c == 0xFFFFFFFF) return r;
+            encodeUTF8(r, c);
+            
+        } while(c >= 0x80 && p != q);
+        
+    }
+    return r;
+    
+}
+#endif
+
+template <typename U>
+inline U* convertUTF8(const unsigned char*& p, const unsigned char* q, U* r) noexcept {
+    
+    auto end = validateUTF8(p, q);
+#if defined(CORECAT_ARCHITECTURE_X86) || defined(CORECAT_ARCHITECTURE_X86_64)
+    if(X86FeatureBase::AVX2) return convertUTF8AVX2(p, end, r);
+    if(X86FeatureBase::SSE2) return convertUTF8SSE2(p, end, r);
+#endif
+    return convertUTF8Scalar(p, end, r);
+    
+}
+template <typename U>
+inline unsigned char* convertToUTF8(const U*& p, const U* q, unsigned char* r) noexcept {
+    
+#if defined(CORECAT_ARCHITECTURE_X86) || defined(CORECAT_ARCHITECTURE_X86_64)
+    if(X86FeatureBase::SSE2) return convertToUTF8SSE2(p, q, r);
+#endif
+    return convertToUTF8Scalar(p, q, r);
+    
+}
+
+}
+
+// Bulk conversion between two charsets, used by String when appending text of another charset. RATIO bounds the
+// output code units per input code unit; a RATIO of 0 means no kernel exists and the code point loop is used instead
+template <typename D, typename C>
+struct Transcoder {
+    
+    static constexpr std::size_t RATIO = 0;
+    
+};
+
+template <typename T, typename U>
+struct Transcoder<UTF8Charset<T>, UTF16Charset<U>> {
+    
+    static constexpr std::size_t RATIO = 1;
+    
+    static U* transcode(const T*& p, const T* q, U* r) noexcept {
+        
+        auto b = reinterpret_cast<const unsigned char*>(p);
+        r = Impl::convertUTF8(b, reinterpret_cast<const unsigned char*>(q), r);
+        p = reinterpret_cast<const T*>(b);
+        return r;
+        
+    }
+    
+};
+template <typename T, typename U>
+struct Transcoder<UTF8Charset<T>, UTF32Charset<U>> {
+    
+    static constexpr std::size_t RATIO = 1;
+    
+    static U* transcode(const T*& p, const T* q, U* r) noexcept {
+        
+        auto b = reinterpret_cast<const unsigned char*>(p);
+        r = Impl::convertUTF8(b, reinterpret_cast<const unsigned char*>(q), r);
+        p = reinterpret_cast<const T*>(b);
+        return r;
+        
+    }
+    
+};
+template <typename T, typename U>
+struct Transcoder<UTF16Charset<T>, UTF8Charset<U>> {
+    
+    static constexpr std::size_t RATIO = 3;
+    
+    static U* transcode(const T*& p, const T* q, U* r) noexcept {
+        
+        auto b = reinterpret_cast<unsigned char*>(r);
+        return r + (Impl::convertToUTF8(p, q, b) - b);
+        
+    }
+    
+};
+template <typename T, typename U>
+struct Transcoder<UTF32Charset<T>, UTF8Charset<U>> {
+    
+    static constexpr std::size_t RATIO = 4;
+    
+    static U* transcode(const T*& p, const T* q, U* r) noexcept {
+        
+        auto b = reinterpret_cast<unsigned char*>(r);
+        return r + (Impl::convertToUTF8(p, q, b) - b);
+        
+    }
+    
+};
+
+}
+}
+}
+
+
+#endif
@@ -28,13 +28,180 @@
 #define CATS_CORECAT_TEXT_CHARSET_UTF8CHARSET_HPP
 
 
+#include <cstdint>
+#include <cstring>
+
 #include "Charset.hpp"
+#include "../../System/Architecture.hpp"
+#include "../../System/Compiler.hpp"
+
+#if defined(CORECAT_ARCHITECTURE_X86) || defined(CORECAT_ARCHITECTURE_X86_64)
+#   include <immintrin.h>
+#   include "../../X86/X86FeatureBase.hpp"
+#endif
 
 
 namespace Cats {
 namespace Corecat {
 inline namespace Text {
 
+namespace Impl {
+
+// Returns the end of the longest prefix of [p, q) made of complete, well-formed sequences (Unicode table 3-7)
+inline const unsigned char* validateUTF8Scalar(const unsigned char* p, const unsigned char* q) noexcept {
+    
+    while(p != q) {
+        
+        if(q - p >= 8) {
+            
+            std::uint64_t x;
+            std::memcpy(&x, p, 8);
+            if(!(x & 0x8080808080808080)) { p += 8; continue; }
+            
+        }
+        unsigned a = *p;
+        if(a <= 0x7F) { ++p; continue; }
+        std::ptrdiff_t n;
+        unsigned low = 0x80, high = 0xBF;
+        if(a >= 0xC2 && a <= 0xDF) n = 2;
+        else if(a >= 0xE0 && a <= 0xEF) n = 3, low = a == 0xE0 ? 0xA0 : 0x80, high = a == 0xED ? 0x9F : 0xBF;
+        else if(a >= 0xF0 && a <= 0xF4) n = 4, low = a == 0xF0 ? 0x90 : 0x80, high = a == 0xF4 ? 0x8F : 0xBF;
+        else return p;
+        if(q - p < n || p[1] < low || p[1] > high) return p;
+        for(std::ptrdiff_t i = 2; i < n; ++i) if((p[i] & 0xC0) != 0x80) return p;
+        p += n;
+        
+    }
+    return p;
+    
+}
+
+#if defined(CORECAT_ARCHITECTURE_X86) || defined(CORECAT_ARCHITECTURE_X86_64)
+// Lookup tables of Keiser and Lemire, "Validating UTF-8 In Less Than One Instruction Per Byte". Each nibble maps to
+// the set of errors it can take part in; a pair of bytes is invalid when all three lookups share a bit
+struct UTF8ValidationTable {
+    
+    static constexpr char TOO_SHORT = 1 << 0, TOO_LONG = 1 << 1, OVERLONG_3 = 1 << 2, TOO_LARGE = 1 << 3,
+        SURROGATE = 1 << 4, OVERLONG_2 = 1 << 5, TOO_LARGE_1000 = 1 << 6, OVERLONG_4 = 1 << 6, TWO_CONTS = char(1 << 7),
+        CARRY = TOO_SHORT | TOO_LONG | TWO_CONTS;
+    static constexpr char BYTE_1_HIGH[16] = {
+        TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+        TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+        TOO_SHORT | OVERLONG_2, TOO_SHORT, TOO_SHORT | OVERLONG_3 | SURROGATE, TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4,
+    };
+    static constexpr char BYTE_1_LOW[16] = {
+        CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4, CARRY | OVERLONG_2, CARRY, CARRY,
+        CARRY | TOO_LARGE, CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE, CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+    };
+    static constexpr char BYTE_2_HIGH[16] = {
+        TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE, TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+        TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+    };
+    
+};
+constexpr char UTF8ValidationTable::BYTE_1_HIGH[16];
+constexpr char UTF8ValidationTable::BYTE_1_LOW[16];
+constexpr char UTF8ValidationTable::BYTE_2_HIGH[16];
+
+// A block is checked together with the last bytes of the one before it. When a block fails, the scalar validator
+// restarts from the sequence boundary at or before the block start and locates the error exactly
+CORECAT_TARGET("ssse3") inline const unsigned char* validateUTF8SSSE3(const unsigned char* p, const unsigned char* q) noexcept {
+    
+    using T = UTF8ValidationTable;
+    
+    const __m128i byte1High = _mm_loadu_si128(reinterpret_cast<const __m128i*>(T::BYTE_1_HIGH));
+    const __m128i byte1Low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(T::BYTE_1_LOW));
+    const __m128i byte2High = _mm_loadu_si128(reinterpret_cast<const __m128i*>(T::BYTE_2_HIGH));
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    // Bytes that are still expecting continuations when they sit at the end of a block
+    const __m128i incomplete = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, char(0xEF), char(0xDF), char(0xBF));
+    auto begin = p;
+    __m128i prev = _mm_setzero_si128(), prevIncomplete = _mm_setzero_si128();
+    for(; q - p >= 16; p += 16) {
+        
+        __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), error;
+        if(!_mm_movemask_epi8(in)) error = prevIncomplete;
+        else {
+            
+            __m128i prev1 = _mm_alignr_epi8(in, prev, 15);
+            __m128i sc = _mm_and_si128(_mm_and_si128(
+                _mm_shuffle_epi8(byte1High, _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble)),
+                _mm_shuffle_epi8(byte1Low, _mm_and_si128(prev1, nibble))),
+                _mm_shuffle_epi8(byte2High, _mm_and_si128(_mm_srli_epi16(in, 4), nibble)));
+            __m128i third = _mm_subs_epu8(_mm_alignr_epi8(in, prev, 14), _mm_set1_epi8(char(0xE0 - 0x80)));
+            __m128i fourth = _mm_subs_epu8(_mm_alignr_epi8(in, prev, 13), _mm_set1_epi8(char(0xF0 - 0x80)));
+            __m128i must23 = _mm_and_si128(_mm_or_si128(third, fourth), _mm_set1_epi8(char(0x80)));
+            error = _mm_xor_si128(must23, sc);
+            
+        }
+        if(_mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128())) != 0xFFFF) break;
+        prev = in, prevIncomplete = _mm_subs_epu8(in, incomplete);
+        
+    }
+    while(p != begin && (p[-1] & 0xC0) == 0x80) --p;
+    if(p != begin && p[-1] >= 0xC0) --p;
+    return validateUTF8Scalar(p, q);
+    
+}
+CORECAT_TARGET("avx2") inline const unsigned char* validateUTF8AVX2(const unsigned char* p, const unsigned char* q) noexcept {
+    
+    using T = UTF8ValidationTable;
+    
+    const __m256i byte1High = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(T::BYTE_1_HIGH)));
+    const __m256i byte1Low = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(T::BYTE_1_LOW)));
+    const __m256i byte2High = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(T::BYTE_2_HIGH)));
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    const __m256i incomplete = _mm256_setr_epi8(
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, char(0xEF), char(0xDF), char(0xBF));
+    auto begin = p;
+    __m256i prev = _mm256_setzero_si256(), prevIncomplete = _mm256_setzero_si256();
+    for(; q - p >= 32; p += 32) {
+        
+        __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)), error;
+        if(!_mm256_movemask_epi8(in)) error = prevIncomplete;
+        else {
+            
+            __m256i shift = _mm256_permute2x128_si256(prev, in, 0x21);
+            __m256i prev1 = _mm256_alignr_epi8(in, shift, 15);
+            __m256i sc = _mm256_and_si256(_mm256_and_si256(
+                _mm256_shuffle_epi8(byte1High, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble)),
+                _mm256_shuffle_epi8(byte1Low, _mm256_and_si256(prev1, nibble))),
+                _mm256_shuffle_epi8(byte2High, _mm256_and_si256(_mm256_srli_epi16(in, 4), nibble)));
+            __m256i third = _mm256_subs_epu8(_mm256_alignr_epi8(in, shift, 14), _mm256_set1_epi8(char(0xE0 - 0x80)));
+            __m256i fourth = _mm256_subs_epu8(_mm256_alignr_epi8(in, shift, 13), _mm256_set1_epi8(char(0xF0 - 0x80)));
+            __m256i must23 = _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8(char(0x80)));
+            error = _mm256_xor_si256(must23, sc);
+            
+        }
+        if(!_mm256_testz_si256(error, error)) break;
+        prev = in, prevIncomplete = _mm256_subs_epu8(in, incomplete);
+        
+    }
+    while(p != begin && (p[-1] & 0xC0) == 0x80) --p;
+    if(p != begin && p[-1] >= 0xC0) --p;
+    return validateUTF8Scalar(p, q);
+    
+}
+#endif
+
+inline const unsigned char* validateUTF8(const unsigned char* p, const unsigned char* q) noexcept {
+    
+#if defined(CORECAT_ARCHITECTURE_X86) || defined(CORECAT_ARCHITECTURE_X86_64)
+    if(X86FeatureBase::AVX2) return validateUTF8AVX2(p, q);
+    if(X86FeatureBase::SSSE3) return validateUTF8SSSE3(p, q);
+#endif
+    return validateUTF8Scalar(p, q);
+    
+}
+
+}
+
 template <typename T = char>
 struct UTF8Charset : public Charset<T> {
     
@@ -47,7 +214,7 @@ struct UTF8Charset : public Charset<T> {
         if(size < 1) return 0xFFFFFFFF;
         char32_t a = static_cast<unsigned char>(*p);
         if(a <= 0x7F) { ++p; return a; }
-        else if(a <= 0xBF) return 0xFFFD;
+        else if(a <= 0xBF) { ++p; return 0xFFFD; }
         else if(a <= 0xDF) {
             
             if(size < 2) return 0xFFFFFFFF;
@@ -63,7 +230,7 @@ struct UTF8Charset : public Charset<T> {
             char32_t b = static_cast<unsigned char>(*p++); if((b & 0xC0) != 0x80) return 0xFFFD;
             char32_t c = static_cast<unsigned char>(*p++); if((c & 0xC0) != 0x80) return 0xFFFD;
             char32_t codepoint = ((a & 0x0F) << 12) | ((b & 0x3F) << 6) | (c & 0x3F);
-            return (codepoint >= 0x0800 || (codepoint - 0xD800 >= 0x0800)) ? codepoint : 0xFFFD;
+            return (codepoint >= 0x0800 && (codepoint - 0xD800 >= 0x0800)) ? codepoint : 0xFFFD;
             
         } else if(a <= 0xF7) {
             
@@ -75,7 +242,14 @@ struct UTF8Charset : public Charset<T> {
             char32_t codepoint = ((a & 0x07) << 18) | ((b & 0x3F) << 12) | ((c & 0x3F) << 6) | (d & 0x3F);
             return (codepoint >= 0x10000 && codepoint <= 0x10FFFF) ? codepoint : 0xFFFD;
             
-        } else return 0xFFFD;
+        } else { ++p; return 0xFFFD; }
+        
+    }
+    // Returns the end of the longest well-formed prefix of [p, q)
+    static const T* validate(const T* p, const T* q) noexcept {
+        
+        auto b = reinterpret_cast<const unsigned char*>(p);
+        return p + (Impl::validateUTF8(b, reinterpret_cast<const unsigned char*>(q)) - b);
         
     }
     static bool encode(T*& p, T* q, char32_t codepoint) {
@@ -92,8 +266,8 @@ struct UTF8Charset : public Charset<T> {
             
             // 110xxxxx 10xxxxxx
             if(size < 2) return false;
-            *p++ = 0xC0 | (T(codepoint) >> 6);
-            *p++ = 0x80 | (codepoint & 0x3F);
+            *p++ = T(0xC0 | (codepoint >> 6));
+            *p++ = T(0x80 | (codepoint & 0x3F));
             return true;
             
         } else if(codepoint <= 0xFFFF) {
@@ -103,9 +277,9 @@ struct UTF8Charset : public Charset<T> {
             if(codepoint - 0xD800 < 0x0800) { *p++ = T(0xEF); *p++ = T(0xBF); *p++ = T(0xBD); }
             else {
                 
-                *p++ = 0xE0 | (T(codepoint) >> 12);
-                *p++ = 0x80 | ((codepoint >> 6) & 0x3F);
-                *p++ = 0x80 | (codepoint & 0x3F);
+                *p++ = T(0xE0 | (codepoint >> 12));
+                *p++ = T(0x80 | ((codepoint >> 6) & 0x3F));
+                *p++ = T(0x80 | (codepoint & 0x3F));
                 
             }
             return true;
@@ -114,10 +288,10 @@ struct UTF8Charset : public Charset<T> {
             
             // 11110xxx 10xxxxxx 10xxxxxx 10xxxxxx
             if(size < 4) return false;
-            *p++ = 0xF0 | (T(codepoint) >> 18);
-            *p++ = 0x80 | ((codepoint >> 12) & 0x3F);
-            *p++ = 0x80 | ((codepoint >> 6) & 0x3F);
-            *p++ = 0x80 | (codepoint & 0x3F);
+            *p++ = T(0xF0 | (codepoint >> 18));
+            *p++ = T(0x80 | ((codepoint >> 12) & 0x3F));
+            *p++ = T(0x80 | ((codepoint >> 6) & 0x3F));
+            *p++ = T(0x80 | (codepoint & 0x3F));
             return true;
             
         } else {
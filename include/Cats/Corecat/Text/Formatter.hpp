@@ -28,9 +28,12 @@
 #define CATS_CORECAT_TEXT_FORMATTER_HPP
 
 
+#include <cmath>
 #include <cstddef>
 
+#include <algorithm>
 #include <array>
+#include <limits>
 #include <memory>
 #include <tuple>
 #include <type_traits>
@@ -38,9 +41,20 @@
 #include <vector>
 
 #include "String.hpp"
+#include "FloatConversion.hpp"
+#include "Charset/DefaultCharset.hpp"
+#include "../Data/Stream/OutputStream.hpp"
+#include "../System/Architecture.hpp"
+#include "../System/Compiler.hpp"
+#include "../Util/Bit.hpp"
 #include "../Util/Exception.hpp"
 #include "../Util/Sequence.hpp"
 
+#if defined(CORECAT_ARCHITECTURE_X86) || defined(CORECAT_ARCHITECTURE_X86_64)
+#   include <immintrin.h>
+#   include "../X86/X86FeatureBase.hpp"
+#endif
+
 
 namespace Cats {
 namespace Corecat {
@@ -83,10 +97,60 @@ inline void toStringBegin4(std::uint16_t x, T*& p) {
     if(x < 100) toStringBegin2(std::uint8_t(x), p);
     else { std::uint8_t a = x / 100, b = x % 100; toStringBegin2(a, p), toStringMiddle2(b, p); }
     
+}
+#if defined(CORECAT_ARCHITECTURE_X86) || defined(CORECAT_ARCHITECTURE_X86_64)
+// The eight digits of x < 10^8 in 16-bit lanes, first one lowest: each half of four digits is copied to four lanes,
+// divided by 1000, 100, 10 and 1 with multiply-high, and the tens of each lane are subtracted (W. Mula)
+CORECAT_TARGET("sse2") inline __m128i toDigitsSSE2(std::uint32_t x) noexcept {
+    
+    __m128i v = _mm_cvtsi32_si128(int(x));
+    __m128i a = _mm_srli_epi64(_mm_mul_epu32(v, _mm_set1_epi32(int(0xD1B71759))), 45);
+    __m128i b = _mm_sub_epi32(v, _mm_mul_epu32(a, _mm_set1_epi32(10000)));
+    __m128i c = _mm_slli_epi64(_mm_unpacklo_epi16(a, b), 2);
+    c = _mm_unpacklo_epi16(c, c), c = _mm_unpacklo_epi32(c, c);
+    c = _mm_mulhi_epu16(c, _mm_setr_epi16(8389, 5243, 13108, -32768, 8389, 5243, 13108, -32768));
+    c = _mm_mulhi_epu16(c, _mm_setr_epi16(1 << 7, 1 << 11, 1 << 13, -32768, 1 << 7, 1 << 11, 1 << 13, -32768));
+    return _mm_sub_epi16(c, _mm_slli_epi64(_mm_mullo_epi16(c, _mm_set1_epi16(10)), 16));
+    
 }
+template <typename T>
+CORECAT_TARGET("sse2") inline void storeDigitsSSE2(__m128i a, T* p) noexcept {
+    
+    a = _mm_add_epi16(a, _mm_set1_epi16('0'));
+    if(sizeof(T) == 1) _mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm_packus_epi16(a, a));
+    else if(sizeof(T) == 2) _mm_storeu_si128(reinterpret_cast<__m128i*>(p), a);
+    else {
+        
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm_unpacklo_epi16(a, _mm_setzero_si128()));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(p) + 1, _mm_unpackhi_epi16(a, _mm_setzero_si128()));
+        
+    }
+    
+}
+template <typename T>
+CORECAT_TARGET("sse2") inline void storeDigitsSSE2(__m128i a, __m128i b, T* p) noexcept {
+    
+    if(sizeof(T) == 1) {
+        
+        __m128i z = _mm_set1_epi16('0');
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm_packus_epi16(_mm_add_epi16(a, z), _mm_add_epi16(b, z)));
+        
+    } else storeDigitsSSE2(a, p), storeDigitsSSE2(b, p + 8);
+    
+}
+#endif
+
 template <typename T>
 inline void toStringMiddle8(std::uint32_t x, T*& p) {
     
+#if defined(CORECAT_ARCHITECTURE_X86) || defined(CORECAT_ARCHITECTURE_X86_64)
+    if(X86FeatureBase::SSE2) {
+        
+        storeDigitsSSE2(toDigitsSSE2(x), p), p += 8;
+        return;
+        
+    }
+#endif
     std::uint16_t a = x / 10000, b = x % 10000;
     toStringMiddle4(a, p), toStringMiddle4(b, p);
     
@@ -102,12 +166,49 @@ template <typename T>
 inline void toStringMiddle16(std::uint64_t x, T*& p) {
     
     std::uint32_t a = x / 100000000, b = x % 100000000;
+#if defined(CORECAT_ARCHITECTURE_X86) || defined(CORECAT_ARCHITECTURE_X86_64)
+    if(X86FeatureBase::SSE2) {
+        
+        storeDigitsSSE2(toDigitsSSE2(a), toDigitsSSE2(b), p), p += 16;
+        return;
+        
+    }
+#endif
     toStringMiddle8(a, p), toStringMiddle8(b, p);
     
 }
 
 }
 
+// The number of decimal digits of x, one for zero, from its bit length: for 32 bits a table entry per bit length
+// carries x past the next multiple of 2^32 exactly when it reaches the power of ten inside that length (D. Lemire)
+template <typename T>
+inline std::enable_if_t<std::is_unsigned<T>::value && sizeof(T) <= 4, int> countDecimalDigit(T x) noexcept {
+    
+    static constexpr std::uint64_t TABLE[] = {
+        4294967296, 4294967296, 4294967296, 8589934582, 8589934592, 8589934592, 12884901788, 12884901888,
+        12884901888, 17179868184, 17179869184, 17179869184, 17179869184, 21474826480, 21474836480, 21474836480,
+        25769703776, 25769803776, 25769803776, 30063771072, 30064771072, 30064771072, 30064771072, 34349738368,
+        34359738368, 34359738368, 38554705664, 38654705664, 38654705664, 41949672960, 42949672960, 42949672960,
+    };
+    return int((x + TABLE[31 - countLeadingZero(std::uint32_t(x | 1))]) >> 32);
+    
+}
+template <typename T>
+inline std::enable_if_t<std::is_unsigned<T>::value && sizeof(T) == 8, int> countDecimalDigit(T t) noexcept {
+    
+    static constexpr std::uint64_t POW10[] = {
+        1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000, 10000000000, 100000000000,
+        1000000000000, 10000000000000, 100000000000000, 1000000000000000, 10000000000000000, 100000000000000000,
+        1000000000000000000, 10000000000000000000u,
+    };
+    // 1233 / 4096 is just above log10(2), so n is the digit count of 2^bits or one less
+    std::uint64_t x = t | 1;
+    int n = (64 - countLeadingZero(x)) * 1233 >> 12;
+    return n + (x >= POW10[n]);
+
+}
+
 template <typename T>
 inline T* u32ToString(std::uint32_t x, T* p) {
     
@@ -153,38 +254,94 @@ inline T* i64ToString(std::int64_t x, T* p) {
 }
 
 
+// Writes the shortest digits that read back as f, a finite positive value, and returns their count; exponent is set
+// to the power of ten of the first digit. digits needs room for 17 units
+template <typename T, typename F>
+inline int toShortestDigits(F f, T* digits, int& exponent) noexcept {
+    
+    auto d = Impl::toShortestDecimal(f);
+    int count = int(u64ToString(d.significand, digits) - digits);
+    exponent = d.exponent + count - 1;
+    return count;
+    
+}
+
+// Rounds f, a finite value that is not negative, to a multiple of 10^u, half to even. The digits are written without
+// trailing zeros, their count is returned, and exponent is set to the power of ten of the first one; zero gives no
+// digits. digits needs room for Impl::FLOAT_DIGIT_MAX units
+template <typename T, typename F>
+inline int toRoundedDigits(F f, int u, T* digits, int& exponent) noexcept {
+    
+    exponent = 0;
+    if(f == 0) return 0;
+    int count = toShortestDigits(f, digits, exponent), n = exponent - u + 1;
+    // The shortest digits can be rounded instead of the exact value, unless more digits are asked for than the type
+    // holds, which subnormals hold fewer of, or the cut falls exactly on a trailing 5
+    if(n > std::numeric_limits<F>::digits10 || f < std::numeric_limits<F>::min()) return Impl::toRoundedDigitsExact(double(f), u, exponent, digits, exponent);
+    if(n >= count) return count;
+    if(n < 0) return 0;
+    if(digits[n] == T('5') && n + 1 == count) return Impl::toRoundedDigitsExact(double(f), u, exponent, digits, exponent);
+    if(digits[n] < T('5')) {
+        
+        count = n;
+        while(count && digits[count - 1] == T('0')) --count;
+        return count;
+        
+    }
+    while(n && digits[n - 1] == T('9')) --n;
+    if(!n) {
+        
+        ++exponent, *digits = T('1');
+        return 1;
+        
+    }
+    ++digits[n - 1];
+    return n;
+    
+}
+
+
+// The integer overloads reserve the longest text of T before writing in place. Counting the digits first is no
+// cheaper: the bsr behind countLeadingZero keeps its destination as an input, which can chain one call to the next
 template <typename C, typename T>
-String<C> toString(T t, std::enable_if_t<std::is_unsigned<T>::value && sizeof(T) <= 4>* = 0) {
+String<C> toString(T t, std::enable_if_t<std::is_integral<T>::value && std::is_unsigned<T>::value && sizeof(T) <= 4>* = 0) {
     
     String<C> s;
+    s.reserve(std::numeric_limits<T>::digits10 + 1 + std::is_signed<T>::value);
     s.setLength(u32ToString(t, s.getData()) - s.getData());
     return s;
     
 }
 template <typename C, typename T>
-String<C> toString(T t, std::enable_if_t<std::is_signed<T>::value && sizeof(T) <= 4>* = 0) {
+String<C> toString(T t, std::enable_if_t<std::is_integral<T>::value && std::is_signed<T>::value && sizeof(T) <= 4>* = 0) {
     
     String<C> s;
+    s.reserve(std::numeric_limits<T>::digits10 + 1 + std::is_signed<T>::value);
     s.setLength(i32ToString(t, s.getData()) - s.getData());
     return s;
     
 }
 template <typename C, typename T>
-String<C> toString(T t, std::enable_if_t<(std::is_unsigned<T>::value && sizeof(T) > 4 && sizeof(T) <= 8)>* = 0) {
+String<C> toString(T t, std::enable_if_t<(std::is_integral<T>::value && std::is_unsigned<T>::value && sizeof(T) > 4 && sizeof(T) <= 8)>* = 0) {
     
     String<C> s;
+    s.reserve(std::numeric_limits<T>::digits10 + 1 + std::is_signed<T>::value);
     s.setLength(u64ToString(t, s.getData()) - s.getData());
     return s;
     
 }
 template <typename C, typename T>
-String<C> toString(T t, std::enable_if_t<(std::is_signed<T>::value && sizeof(T) > 4 && sizeof(T) <= 8)>* = 0) {
+String<C> toString(T t, std::enable_if_t<(std::is_integral<T>::value && std::is_signed<T>::value && sizeof(T) > 4 && sizeof(T) <= 8)>* = 0) {
     
     String<C> s;
+    s.reserve(std::numeric_limits<T>::digits10 + 1 + std::is_signed<T>::value);
     s.setLength(i64ToString(t, s.getData()) - s.getData());
     return s;
     
 }
+// The shortest text that reads back as t, as formatted without a specifier; defined after formatString
+template <typename C, typename T>
+String<C> toString(T t, std::enable_if_t<std::is_floating_point<T>::value>* = 0);
 
 template <typename C>
 String<C> toString(String<C> s) { return s; }
@@ -208,6 +365,32 @@ struct Digit {
 template <typename T, bool CAP>
 using DigitTable = Util::SequenceTable<MapperSequence<Digit<T, CAP>, IndexSequence<int, 0, 36>>>;
 
+// Writes t in the base 1 << SHIFT backwards from e and returns the first digit
+template <unsigned SHIFT, typename T, typename U>
+inline T* writeIntegerPow2(U t, T* e, const T* table) noexcept {
+    
+    do {
+        
+        *--e = table[t & ((U(1) << SHIFT) - 1)];
+        t >>= SHIFT;
+        
+    } while(t);
+    return e;
+    
+}
+
+// Sizes a string for t in the base 1 << SHIFT from its bit length and fills it with shifts and masks
+template <unsigned SHIFT, typename C, typename T>
+inline String<C> toStringPow2(T t, const typename C::CharType* table) {
+    
+    int bits = int(sizeof(T) * 8) - countLeadingZero(T(t | 1));
+    String<C> s;
+    s.setLength(std::size_t(bits + SHIFT - 1) / SHIFT);
+    writeIntegerPow2<SHIFT>(t, s.getData() + s.getLength(), table);
+    return s;
+    
+}
+
 }
 
 template <typename C, typename T>
@@ -218,6 +401,14 @@ inline std::enable_if_t<std::is_unsigned<T>::value, String<C>> toStringBase(T t,
     if(base < 2 || base > 36) throw InvalidArgumentException("Base must be in [2, 36]");
     
     auto table = capital ? Impl::DigitTable<CharType, true>::DATA : Impl::DigitTable<CharType, false>::DATA;
+    switch(base) {
+    case 2: return Impl::toStringPow2<1, C>(t, table);
+    case 4: return Impl::toStringPow2<2, C>(t, table);
+    case 8: return Impl::toStringPow2<3, C>(t, table);
+    case 10: return toString<C>(t);
+    case 16: return Impl::toStringPow2<4, C>(t, table);
+    case 32: return Impl::toStringPow2<5, C>(t, table);
+    }
     
     CharType buffer[sizeof(T) * 8];
     auto p = std::end(buffer), q = p;
@@ -233,204 +424,568 @@ inline std::enable_if_t<std::is_unsigned<T>::value, String<C>> toStringBase(T t,
 }
 
 
+// A replacement field specifier, [[fill]align][sign][#][0][width][.precision][type]; zero, or -1 for the precision,
+// marks the fields that were not given. Strings take no type, or 'j' to be escaped as the contents of a JSON string
+template <typename T>
+struct FormatSpec {
+    
+    T fillChar = ' ';
+    T alignType = 0;
+    T signType = 0;
+    bool alter = false;
+    bool zero = false;
+    std::size_t width = 0;
+    int precision = -1;
+    T type = 0;
+    
+};
+
+
 namespace Impl {
 
-template <bool IS_NUMERIC, typename T>
-inline std::pair<T, T> parseFormatAlignType(const T*& p, const T* q) {
+constexpr std::size_t FORMAT_LITERAL = std::size_t(-1);
+    
+// A piece of a format string: either the literal text [begin, end) or the replacement field for argument index
+template <typename T>
+struct FormatSegment {
+    
+    std::size_t index = FORMAT_LITERAL;
+    std::size_t begin = 0;
+    std::size_t end = 0;
+    FormatSpec<T> spec;
     
-    T fillChar = ' ', alignType = IS_NUMERIC ? '>' : '<';
-    if(q - p >= 2 && (p[1] == T('<') || p[1] == T('>') || p[1] == T('^') || (IS_NUMERIC && *p == T('='))))
-        fillChar = p[0], alignType = p[1], p += 2;
-    else if(q - p >= 1 && (*p == T('<') || *p == T('>') || *p == T('^') || (IS_NUMERIC && *p == T('='))))
-        alignType = *p, ++p;
-    return {fillChar, alignType};
+};
+
+template <typename T>
+constexpr bool isFormatAlign(T c) noexcept { return c == T('<') || c == T('>') || c == T('^') || c == T('='); }
+
+template <typename T>
+constexpr FormatSpec<T> parseFormatSpec(const T* p, const T* q) {
+    
+    FormatSpec<T> spec;
+    if(q - p >= 2 && isFormatAlign(p[1])) spec.fillChar = p[0], spec.alignType = p[1], p += 2;
+    else if(p != q && isFormatAlign(*p)) spec.alignType = *p++;
+    if(p != q && (*p == T('+') || *p == T('-') || *p == T(' '))) spec.signType = *p++;
+    if(p != q && *p == T('#')) spec.alter = true, ++p;
+    if(p != q && *p == T('0')) spec.zero = true, ++p;
+    for(; p != q && *p >= T('0') && *p <= T('9'); ++p) spec.width = spec.width * 10 + (*p - T('0'));
+    if(p != q && *p == T('.')) {
+        
+        if(++p == q || *p < T('0') || *p > T('9')) throw InvalidArgumentException("Invalid format specifier");
+        for(spec.precision = 0; p != q && *p >= T('0') && *p <= T('9'); ++p) spec.precision = spec.precision * 10 + (*p - T('0'));
+        
+    }
+    if(p != q) spec.type = *p++;
+    if(p != q) throw InvalidArgumentException("Invalid format specifier");
+    return spec;
     
 }
 
+// Parses the segment starting at pos; index is the argument used by a field without an explicit one. pos is moved
+// past the segment, and "{{" and "}}" end a literal segment with a single brace.
 template <typename T>
-inline T parseFormatSignType(const T*& p, const T* q) {
+constexpr FormatSegment<T> parseFormatSegment(const T* data, std::size_t size, std::size_t& pos, std::size_t index) {
     
-    T signType = '-';
-    if(p != q && (*p == T('+') || *p == T('-') || *p == T(' ')))
-        signType = *p, ++p;
-    return signType;
+    FormatSegment<T> segment;
+    auto p = data + pos, q = data + size, b = p;
+    while(p != q && *p != T('{') && *p != T('}')) ++p;
+    if(p != q && *p == T('}')) {
+        
+        if(p + 1 == q || p[1] != T('}')) throw InvalidArgumentException("Unexpected end of format string");
+        segment.begin = b - data, segment.end = p + 1 - data, pos = p + 2 - data;
+        return segment;
+        
+    }
+    if(p != b || (p + 1 != q && p[1] == T('{'))) {
+        
+        bool escape = p != q && p + 1 != q && p[1] == T('{');
+        segment.begin = b - data, segment.end = p + escape - data, pos = p + 2 * escape - data;
+        return segment;
+        
+    }
+    b = ++p;
+    while(p != q && *p >= T('0') && *p <= T('9')) ++p;
+    if(p != b) for(index = 0; b != p; ++b) index = index * 10 + (*b - T('0'));
+    segment.index = index;
+    if(p == q) throw InvalidArgumentException("Unexpected end of format string");
+    else if(*p == T(':')) {
+        
+        b = ++p;
+        while(p != q && *p != T('}')) ++p;
+        if(p == q) throw InvalidArgumentException("Unexpected end of format string");
+        segment.spec = parseFormatSpec(b, p);
+        
+    } else if(*p != T('}')) throw InvalidArgumentException("Unexpected character");
+    pos = p + 1 - data;
+    return segment;
     
 }
 
+// Fills in the defaults of a checked specifier
 template <typename T>
-inline bool parseFormatAlter(const T*& p, const T* q) {
+constexpr FormatSpec<T> completeStringFormatSpec(FormatSpec<T> spec) noexcept {
     
-    bool alter = false;
-    if(p != q && *p == T('#'))
-        alter = true, ++p;
-    return alter;
+    if(!spec.alignType) spec.alignType = '<';
+    return spec;
     
 }
-
 template <typename T>
-inline bool parseFormatZero(const T*& p, const T* q) {
+constexpr FormatSpec<T> completeIntegerFormatSpec(FormatSpec<T> spec) noexcept {
     
-    bool zero = false;
-    if(p != q && *p == T('0'))
-        zero = true, ++p;
-    return zero;
+    if(!spec.alignType) spec.alignType = '>';
+    if(!spec.signType) spec.signType = '-';
+    if(!spec.type) spec.type = 'd';
+    if(spec.zero) spec.fillChar = '0', spec.alignType = '=';
+    return spec;
     
 }
-
 template <typename T>
-inline std::size_t parseFormatWidth(const T*& p, const T* q) {
+constexpr FormatSpec<T> completeFloatFormatSpec(FormatSpec<T> spec) noexcept {
     
-    std::size_t width = 0;
-    for(; p != q && *p >= '0' && *p <= '9'; ++p)
-        width = width * 10 + (*p - '0');
-    return width;
+    if(!spec.alignType) spec.alignType = '>';
+    if(!spec.signType) spec.signType = '-';
+    if(spec.zero) spec.fillChar = '0', spec.alignType = '=';
+    return spec;
     
 }
 
 template <typename T>
-inline T parseFormatType(const T*& p, const T* q, T t) {
+constexpr bool checkStringFormatSpec(const FormatSpec<T>& spec) noexcept {
     
-    if(p != q) return *p++;
-    else return t;
+    return spec.alignType != T('=') && !spec.signType && !spec.alter && !spec.zero && spec.precision < 0 && (!spec.type || spec.type == T('j'));
     
 }
+template <typename T>
+constexpr bool checkIntegerFormatSpec(const FormatSpec<T>& spec) noexcept {
+    
+    return spec.precision < 0 && (!spec.type || spec.type == T('b') || spec.type == T('c') || spec.type == T('d') || spec.type == T('o') || spec.type == T('x') || spec.type == T('X'));
+    
+}
+template <typename T>
+constexpr bool checkFloatFormatSpec(const FormatSpec<T>& spec) noexcept {
+    
+    return !spec.type || spec.type == T('e') || spec.type == T('E') || spec.type == T('f') || spec.type == T('F') || spec.type == T('g') || spec.type == T('G') || spec.type == T('%');
+    
+}
+
+// Whether spec can format an argument of type A
+template <typename A, typename T>
+constexpr std::enable_if_t<std::is_integral<A>::value, bool> checkFormatSpec(const FormatSpec<T>& spec) noexcept { return checkIntegerFormatSpec(spec); }
+template <typename A, typename T>
+constexpr std::enable_if_t<std::is_floating_point<A>::value, bool> checkFormatSpec(const FormatSpec<T>& spec) noexcept { return checkFloatFormatSpec(spec); }
+template <typename A, typename T>
+constexpr std::enable_if_t<!std::is_integral<A>::value && !std::is_floating_point<A>::value, bool> checkFormatSpec(const FormatSpec<T>& spec) noexcept { return checkStringFormatSpec(spec); }
 
 }
 
 
+namespace Impl {
+
+// The formatString overloads write through W::append(const CharType*, std::size_t) and W::append(CharType, std::size_t),
+// as String does; these writers send the text to an output iterator, to an OutputStream or nowhere but a count
+template <typename C, typename I>
+class IteratorFormatWriter {
+    
+public:
+    
+    using CharsetType = C;
+    using CharType = typename C::CharType;
+    
+private:
+    
+    I i;
+    
+public:
+    
+    IteratorFormatWriter(I i_) : i(std::move(i_)) {}
+    
+    void append(const CharType* data, std::size_t length) { i = std::copy(data, data + length, i); }
+    void append(CharType ch, std::size_t count = 1) { i = std::fill_n(i, count, ch); }
+    
+    I getIterator() const { return i; }
+    
+};
+
+// Collects the small pieces of a record so that the stream sees a few large writes
 template <typename C>
-void formatString(String<C>& writer, StringView<C> str, StringView<C> arg) {
+class StreamFormatWriter {
+    
+public:
     
+    using CharsetType = C;
     using CharType = typename C::CharType;
     
-    if(arg.isEmpty()) { writer += str; return; }
+private:
     
-    auto p = arg.begin(), q = arg.end();
+    static constexpr std::size_t BUFFER_SIZE = 256;
     
-    CharType fillChar, alignType; std::tie(fillChar, alignType) = Impl::parseFormatAlignType<false>(p, q);
-    std::size_t width = Impl::parseFormatWidth(p, q);
+    OutputStream<CharType>& stream;
+    CharType buffer[BUFFER_SIZE];
+    std::size_t size = 0;
     
-    if(p != q) throw InvalidArgumentException("Invalid format specifier");
+public:
+    
+    StreamFormatWriter(OutputStream<CharType>& stream_) : stream(stream_) {}
     
-    std::size_t length = str.getLength();
-    if(width <= length) { writer += str; return; }
-    std::size_t fill = width - length;
-    switch(alignType) {
-    case '<': {
+    void append(const CharType* data, std::size_t length) {
+        
+        if(length > BUFFER_SIZE - size) {
+            
+            flush();
+            if(length >= BUFFER_SIZE) { stream.writeAll(data, length); return; }
+            
+        }
+        std::copy(data, data + length, buffer + size);
+        size += length;
         
-        writer += str;
-        writer.append(fillChar, fill);
-        break;
     }
-    case '>': {
+    void append(CharType ch, std::size_t count = 1) {
         
-        writer.append(fillChar, fill);
-        writer += str;
-        break;
+        while(count) {
+            
+            if(size == BUFFER_SIZE) flush();
+            std::size_t n = std::min(count, BUFFER_SIZE - size);
+            std::fill_n(buffer + size, n, ch);
+            size += n, count -= n;
+            
+        }
         
     }
-    case '^': {
+    
+    void flush() {
         
-        std::size_t left = fill / 2, right = fill - left;
-        writer.append(fillChar, left);
-        writer += str;
-        writer.append(fillChar, right);
-        break;
+        if(size) stream.writeAll(buffer, size);
+        size = 0;
         
     }
-    }
     
-}
+};
 template <typename C>
-void formatString(String<C>& writer, const typename C::CharType* str, StringView<C> arg) { formatString(writer, StringView<C>(str), arg); }
+constexpr std::size_t StreamFormatWriter<C>::BUFFER_SIZE;
+
 template <typename C>
-void formatString(String<C>& writer, const String<C>& str, StringView<C> arg) { formatString(writer, StringView<C>(str), arg); }
+class CountFormatWriter {
+    
+public:
+    
+    using CharsetType = C;
+    using CharType = typename C::CharType;
+    
+private:
+    
+    std::size_t size = 0;
+    
+public:
+    
+    void append(const CharType*, std::size_t length) noexcept { size += length; }
+    void append(CharType, std::size_t count = 1) noexcept { size += count; }
+    
+    std::size_t getSize() const noexcept { return size; }
+    
+};
 
-template <typename C, typename T>
-std::enable_if_t<std::is_integral<T>::value> formatString(String<C>& writer, T t, StringView<C> arg) {
+// Writes prefix, then length units from data(writer), padded as spec says; for '=' the fill goes after the prefix
+template <typename W, typename D>
+inline void writeFormatPadded(W& writer, const FormatSpec<typename W::CharsetType::CharType>& spec, const typename W::CharsetType::CharType* prefix,
+    std::size_t prefixLength, std::size_t length, D&& data) {
+        
+    std::size_t total = prefixLength + length;
+    std::size_t fill = spec.width > total ? spec.width - total : 0, left = 0;
+    switch(spec.alignType) {
+    case '<': break;
+    case '>': left = fill; break;
+    case '^': left = fill / 2; break;
+    case '=': {
+        
+        writer.append(prefix, prefixLength);
+        writer.append(spec.fillChar, fill);
+        data(writer);
+        return;
+        
+    }
+    }
+    if(left) writer.append(spec.fillChar, left);
+    writer.append(prefix, prefixLength);
+    data(writer);
+    if(fill - left) writer.append(spec.fillChar, fill - left);
+    
+}
+
+// The text of a decimal d0.d1d2... * 10^exponent, in fixed or scientific notation with fraction digits after the point
+template <typename T>
+struct FloatLayout {
+    
+    const T* digits;
+    int count;
+    int exponent;
+    bool scientific;
+    int fraction;
+    bool point;
+    T exponentChar;
+    T suffix;
+    
+    template <typename W>
+    void write(W& writer) const {
+        
+        if(!scientific) {
+            
+            if(exponent < 0) writer.append(T('0'));
+            else {
+                
+                int k = std::min(count, exponent + 1);
+                writer.append(digits, k);
+                if(exponent + 1 > k) writer.append(T('0'), exponent + 1 - k);
+                
+            }
+            if(fraction || point) writer.append(T('.'));
+            if(fraction) {
+                
+                int zero = std::min(fraction, std::max(0, -exponent - 1)), b = std::max(0, exponent + 1);
+                int k = std::max(0, std::min(count - b, fraction - zero));
+                if(zero) writer.append(T('0'), zero);
+                writer.append(digits + b, k);
+                if(fraction - zero - k) writer.append(T('0'), fraction - zero - k);
+                
+            }
+            
+        } else {
+            
+            writer.append(count ? digits[0] : T('0'));
+            if(fraction || point) writer.append(T('.'));
+            int k = std::max(0, std::min(count - 1, fraction));
+            writer.append(digits + 1, k);
+            if(fraction - k) writer.append(T('0'), fraction - k);
+            T buffer[5] = {exponentChar, exponent < 0 ? T('-') : T('+')}, *e = buffer + 2;
+            int x = exponent < 0 ? -exponent : exponent;
+            if(x >= 100) *e++ = T('0' + x / 100);
+            *e++ = T('0' + x / 10 % 10), *e++ = T('0' + x % 10);
+            writer.append(buffer, e - buffer);
+            
+        }
+        if(suffix) writer.append(suffix);
+        
+    }
+    
+};
+
+// Writes [p, q) as the contents of a JSON string. The runs between escapes are found a vector at a time and copied
+// whole; units from 0x80 up pass through, so UTF-8 stays UTF-8
+template <typename W, typename T>
+inline void writeJsonEscaped(W& writer, const T* p, const T* q) {
+    
+    // The short escapes for the units below 0x20, or 'u' for \u00XX
+    static constexpr char ESCAPE[] = "uuuuuuuubtnufruuuuuuuuuuuuuuuuuu";
+    
+    while(true) {
+        
+        const T* r = findJsonEscape(p, q);
+        if(!r) break;
+        writer.append(p, r - p);
+        auto c = static_cast<std::make_unsigned_t<T>>(*r);
+        T buffer[6] = {T('\\')};
+        if(c >= 0x20) buffer[1] = *r, writer.append(buffer, 2);
+        else if(ESCAPE[c] != 'u') buffer[1] = T(ESCAPE[c]), writer.append(buffer, 2);
+        else {
+            
+            buffer[1] = T('u'), buffer[2] = T('0'), buffer[3] = T('0');
+            buffer[4] = DigitTable<T, false>::DATA[c >> 4], buffer[5] = DigitTable<T, false>::DATA[c & 15];
+            writer.append(buffer, 6);
+            
+        }
+        p = r + 1;
+        
+    }
+    writer.append(p, q - p);
+    
+}
+
+}
+
+
+template <typename W>
+void formatString(W& writer, StringView<typename W::CharsetType> str, const FormatSpec<typename W::CharsetType::CharType>& spec_) {
+    
+    using C = typename W::CharsetType;
+    
+    if(!Impl::checkStringFormatSpec(spec_)) throw InvalidArgumentException("Invalid format specifier");
+    auto spec = Impl::completeStringFormatSpec(spec_);
     
+    auto b = str.getData(), e = b + str.getLength();
+    if(spec.type == 'j') {
+        
+        if(!spec.width) Impl::writeJsonEscaped(writer, b, e);
+        else {
+            
+            Impl::CountFormatWriter<C> counter;
+            Impl::writeJsonEscaped(counter, b, e);
+            Impl::writeFormatPadded(writer, spec, b, 0, counter.getSize(), [&](W& w) { Impl::writeJsonEscaped(w, b, e); });
+            
+        }
+        
+    } else Impl::writeFormatPadded(writer, spec, b, 0, e - b, [&](W& w) { w.append(b, e - b); });
+    
+}
+
+template <typename W, typename T>
+std::enable_if_t<std::is_integral<T>::value> formatString(W& writer, T t, const FormatSpec<typename W::CharsetType::CharType>& spec_) {
+    
+    using C = typename W::CharsetType;
     using CharType = typename C::CharType;
     using UnsignedType = std::make_unsigned_t<T>;
     
-    if(arg.isEmpty()) { writer += toString<C>(t); return; }
-    
-    auto p = arg.begin(), q = arg.end();
-    CharType fillChar, alignType; std::tie(fillChar, alignType) = Impl::parseFormatAlignType<true>(p, q);
-    CharType signType = Impl::parseFormatSignType(p, q);
-    bool alter = Impl::parseFormatAlter(p, q);
-    bool zero = Impl::parseFormatZero(p, q);
-    if(zero) fillChar = CharType('0'), alignType = CharType('=');
-    std::size_t width = Impl::parseFormatWidth(p, q);
-    CharType type = Impl::parseFormatType(p, q, CharType('d'));
-    if(type != CharType('b') && type != CharType('c') && type != CharType('d') && type != CharType('o') && type != CharType('x') && type != CharType('X'))
-        throw InvalidArgumentException("Invalid format type");
-    if(p != q) throw InvalidArgumentException("Invalid format specifier");
+    if(!Impl::checkIntegerFormatSpec(spec_)) throw InvalidArgumentException("Invalid format type");
+    auto spec = Impl::completeIntegerFormatSpec(spec_);
     
-    if(type == CharType('c')) { writer += CharType(t); return; }
+    if(spec.type == CharType('c')) { writer.append(CharType(t)); return; }
     
     UnsignedType x; CharType sign;
-    if(t >= 0) x = t, sign = signType == '+' ? '+' : signType == '-' ? 0 : ' ';
+    if(t >= 0) x = t, sign = spec.signType == '+' ? '+' : spec.signType == '-' ? 0 : ' ';
     else x = UnsignedType(0) - UnsignedType(t), sign = '-';
-    String<C> str;
-    switch(type) {
-    case 'b': str = alter ? String<C>("0b"_sv) + toStringBase<C>(x, 2) : toStringBase<C>(x, 2); break;
-    case 'o': str = alter ? String<C>("0o"_sv) + toStringBase<C>(x, 8) : toStringBase<C>(x, 8); break;
-    case 'd': str = toString<C>(x); break;
-    case 'x': str = alter ? String<C>("0x"_sv) + toStringBase<C>(x, 16) : toStringBase<C>(x, 16); break;
-    case 'X': str = alter ? String<C>("0x"_sv) + toStringBase<C>(x, 16, true) : toStringBase<C>(x, 16, true); break;
-    }
     
-    std::size_t length = str.getLength() + !!sign;
-    if(width <= length) {
+    CharType buffer[sizeof(T) * 8], prefix[3];
+    CharType* b = buffer, *e = std::end(buffer);
+    std::size_t prefixLength = 0;
+    if(sign) prefix[prefixLength++] = sign;
+    if(spec.alter && spec.type != CharType('d')) prefix[prefixLength++] = '0', prefix[prefixLength++] = spec.type == CharType('X') ? 'x' : spec.type;
+    // A counting writer only needs the length, which the digit count gives without the digits
+    if(std::is_same<W, Impl::CountFormatWriter<C>>::value && spec.type == CharType('d')) {
         
-        if(sign) writer += sign;
-        writer += str;
+        writer.append(CharType('0'), std::max(spec.width, prefixLength + countDecimalDigit(x)));
         return;
         
     }
-    std::size_t fill = width - length;
-    switch(alignType) {
-    case '<': {
+    switch(spec.type) {
+    case 'b': b = Impl::writeIntegerPow2<1>(x, e, Impl::DigitTable<CharType, false>::DATA); break;
+    case 'o': b = Impl::writeIntegerPow2<3>(x, e, Impl::DigitTable<CharType, false>::DATA); break;
+    case 'd': e = sizeof(T) <= 4 ? u32ToString(std::uint32_t(x), b) : u64ToString(std::uint64_t(x), b); break;
+    case 'x': b = Impl::writeIntegerPow2<4>(x, e, Impl::DigitTable<CharType, false>::DATA); break;
+    case 'X': b = Impl::writeIntegerPow2<4>(x, e, Impl::DigitTable<CharType, true>::DATA); break;
+    }
+    
+    if(!spec.width) {
         
-        if(sign) writer += sign;
-        writer += str;
-        writer.append(fillChar, fill);
-        break;
+        writer.append(prefix, prefixLength);
+        writer.append(b, e - b);
         
-    }
-    case '>': {
+    } else Impl::writeFormatPadded(writer, spec, prefix, prefixLength, e - b, [&](W& w) { w.append(b, e - b); });
+    
+}
+
+// Without a type, the shortest digits that read back as t, in scientific notation only for exponents outside [-4, 16);
+// with a precision and no type, as 'g'
+template <typename W, typename T>
+std::enable_if_t<std::is_floating_point<T>::value> formatString(W& writer, T t, const FormatSpec<typename W::CharsetType::CharType>& spec_) {
+    
+    using C = typename W::CharsetType;
+    using CharType = typename C::CharType;
+    using F = std::conditional_t<std::is_same<T, float>::value, float, double>;
+    
+    if(!Impl::checkFloatFormatSpec(spec_)) throw InvalidArgumentException("Invalid format type");
+    auto spec = Impl::completeFloatFormatSpec(spec_);
+    
+    F f = F(t);
+    CharType prefix[1], sign = std::signbit(f) && !std::isnan(f) ? '-' : spec.signType == '+' ? '+' : spec.signType == ' ' ? ' ' : 0;
+    std::size_t prefixLength = 0;
+    if(sign) prefix[prefixLength++] = sign;
+    f = std::fabs(f);
+    CharType type = spec.type, suffix = 0;
+    bool upper = type == CharType('E') || type == CharType('F') || type == CharType('G');
+    if(type == CharType('%')) f *= 100, type = 'f', suffix = '%';
+    
+    if(!std::isfinite(f)) {
         
-        writer.append(fillChar, fill);
-        if(sign) writer += sign;
-        writer += str;
-        break;
+        CharType text[4] = {CharType(upper ? 'I' : 'i'), CharType(upper ? 'N' : 'n'), CharType(upper ? 'F' : 'f'), suffix};
+        if(std::isnan(f)) text[0] = upper ? 'N' : 'n', text[1] = upper ? 'A' : 'a', text[2] = upper ? 'N' : 'n';
+        Impl::writeFormatPadded(writer, spec, prefix, prefixLength, 3 + !!suffix, [&](W& w) { w.append(text, 3 + !!suffix); });
+        return;
         
     }
-    case '^': {
+    
+    CharType digits[Impl::FLOAT_DIGIT_MAX];
+    Impl::FloatLayout<CharType> layout = {digits, 0, 0, false, 0, spec.alter, CharType(upper ? 'E' : 'e'), suffix};
+    if(!type && spec.precision < 0) {
         
-        std::size_t left = fill / 2, right = fill - left;
-        writer.append(fillChar, left);
-        if(sign) writer += sign;
-        writer += str;
-        writer.append(fillChar, right);
-        break;
+        if(f != 0) layout.count = toShortestDigits(f, digits, layout.exponent);
+        layout.scientific = layout.exponent < -4 || layout.exponent >= 16;
+        layout.fraction = layout.scientific ? std::max(0, layout.count - 1) : std::max(0, layout.count - layout.exponent - 1);
         
-    }
-    case '=': {
+    } else if(type == CharType('f') || type == CharType('F')) {
+        
+        layout.fraction = spec.precision < 0 ? 6 : spec.precision;
+        layout.count = toRoundedDigits(f, -layout.fraction, digits, layout.exponent);
+        
+    } else {
         
-        if(sign) writer += sign;
-        writer.append(fillChar, fill);
-        writer += str;
-        break;
+        // 'e' keeps precision digits after the first one, 'g' keeps precision significant digits
+        bool general = type != CharType('e') && type != CharType('E');
+        int precision = spec.precision < 0 ? 6 : spec.precision;
+        precision = general ? std::max(precision, 1) : precision + 1;
+        int exponent = 0;
+        if(f != 0) toShortestDigits(f, digits, exponent);
+        layout.count = toRoundedDigits(f, exponent - precision + 1, digits, layout.exponent);
+        // The shortest digits can name the next power of ten; the first digit then sits one place lower
+        if(layout.count && layout.exponent < exponent) layout.count = toRoundedDigits(f, layout.exponent - precision + 1, digits, layout.exponent);
+        if(!general) layout.scientific = true, layout.fraction = precision - 1;
+        else {
+            
+            layout.scientific = layout.exponent < -4 || layout.exponent >= precision;
+            if(spec.alter) layout.fraction = layout.scientific ? precision - 1 : precision - 1 - layout.exponent;
+            else layout.fraction = layout.scientific ? std::max(0, layout.count - 1) : std::max(0, layout.count - layout.exponent - 1);
+            
+        }
         
     }
+    
+    if(!spec.width) {
+        
+        writer.append(prefix, prefixLength);
+        layout.write(writer);
+        
+    } else {
+        
+        Impl::CountFormatWriter<C> counter;
+        layout.write(counter);
+        Impl::writeFormatPadded(writer, spec, prefix, prefixLength, counter.getSize(), [&](W& w) { layout.write(w); });
+        
     }
     
 }
 
+template <typename C, typename T>
+String<C> toString(T t, std::enable_if_t<std::is_floating_point<T>::value>*) {
+    
+    String<C> s;
+    formatString(s, t, FormatSpec<typename C::CharType>());
+    return s;
+    
+}
 
-template <typename C>
-class Formatter {
+// Formats t with the specifier text arg, as found after the ':' of a replacement field
+template <typename W, typename T>
+void formatString(W& writer, T&& t, StringView<typename W::CharsetType> arg) { formatString(writer, std::forward<T>(t), Impl::parseFormatSpec(arg.begin(), arg.end())); }
+
+// How Formatter and CORECAT_FORMAT write an argument of type T. A specialisation for a type of its own provides
+//     template <typename C> static constexpr bool check(const FormatSpec<C>& spec);
+//     template <typename W> static void format(W& writer, const T& t, const FormatSpec<typename W::CharsetType::CharType>& spec);
+// check() tells whether spec suits T, and CORECAT_FORMAT calls it during compilation; format() writes t straight into
+// the writer, given the specifier parsed once with the format string. The second parameter is there for partial
+// specialisations with std::enable_if_t. By default T goes to the formatString overloads, found by ADL as before.
+template <typename T, typename = void>
+struct FormatTraits {
+    
+    template <typename C>
+    static constexpr bool check(const FormatSpec<C>& spec) noexcept { return Impl::checkFormatSpec<T>(spec); }
+    template <typename W>
+    static void format(W& writer, const T& t, const FormatSpec<typename W::CharsetType::CharType>& spec) { formatString(writer, t, spec); }
+    
+};
+
+
+namespace Impl {
+
+// The output functions shared by Formatter and StaticFormatter; F::write(writer, arg...) formats into any writer
+template <typename F, typename C>
+class FormatterBase {
     
 public:
     
@@ -442,98 +997,120 @@ public:
     
 private:
     
-    class HolderBase {
+    const F& getDerived() const noexcept { return static_cast<const F&>(*this); }
+    
+public:
+    
+    template<typename... Arg>
+    StringType operator ()(Arg&&... arg) const { return format(std::forward<Arg>(arg)...); }
+    
+    template<typename... Arg>
+    StringType format(Arg&&... arg) const {
         
-    public:
+        StringType str;
+        str.reserve(getDerived().getLiteralLength());
+        getDerived().write(str, std::forward<Arg>(arg)...);
+        return str;
         
-        virtual ~HolderBase() {}
+    }
+    
+    // Appends to str without clearing it
+    template<typename... Arg>
+    StringType& formatTo(StringType& str, Arg&&... arg) const {
         
-        virtual void format(StringType& writer, StringViewType arg) const = 0;
+        getDerived().write(str, std::forward<Arg>(arg)...);
+        return str;
         
-    };
-    
-    template <typename T>
-    class Holder final : public HolderBase {
+    }
+    // Writes through the output iterator i and returns it past the last unit written
+    template<typename I, typename... Arg>
+    std::enable_if_t<!std::is_same<I, StringType>::value && !std::is_base_of<OutputStream<CharType>, I>::value, I> formatTo(I i, Arg&&... arg) const {
         
-    private:
+        IteratorFormatWriter<C, I> writer(std::move(i));
+        getDerived().write(writer, std::forward<Arg>(arg)...);
+        return writer.getIterator();
         
-        T t;
+    }
+    // Writes to stream in a few large writes; the stream itself is not flushed
+    template<typename... Arg>
+    void formatTo(OutputStream<CharType>& stream, Arg&&... arg) const {
         
-    public:
+        StreamFormatWriter<C> writer(stream);
+        getDerived().write(writer, std::forward<Arg>(arg)...);
+        writer.flush();
         
-        Holder(T t_) : t(std::move(t_)) {}
-        ~Holder() final = default;
+    }
+    // The length of the result of format(arg...), for sizing a buffer in advance
+    template<typename... Arg>
+    std::size_t formattedSize(Arg&&... arg) const {
         
-        void format(StringType& writer, StringViewType arg) const final { formatString(writer, t, arg); }
+        CountFormatWriter<C> writer;
+        getDerived().write(writer, std::forward<Arg>(arg)...);
+        return writer.getSize();
         
-    };
+    }
     
-    struct Segment {
-        
-        std::size_t index;
-        StringViewType arg;
+};
+
+}
+
+
+template <typename C>
+class Formatter : public Impl::FormatterBase<Formatter<C>, C> {
+    
+public:
+    
+    using CharsetType = C;
+    using CharType = typename C::CharType;
+    
+    using StringType = String<C>;
+    using StringViewType = StringView<C>;
+    
+private:
+    
+    friend Impl::FormatterBase<Formatter<C>, C>;
+    
+    // An argument is passed as its address and the FormatTraits instantiation for its type, so nothing is copied or
+    // allocated per call
+    template <typename W>
+    struct Argument {
         
-        Segment(std::size_t index_, StringViewType arg_) : index(index_), arg(arg_) {}
+        const void* data;
+        void (*format)(W& writer, const void* data, const FormatSpec<CharType>& spec);
         
     };
     
+    using Segment = Impl::FormatSegment<CharType>;
+    
 private:
     
     StringType data;
     std::vector<Segment> segments;
+    std::size_t literalLength = 0;
     
-public:
+private:
     
-    Formatter(StringViewType data_) : data(data_) {
+    template <typename W, typename T>
+    static void formatArgument(W& writer, const void* data, const FormatSpec<CharType>& spec) {
+        
+        if(!FormatTraits<std::decay_t<T>>::check(spec)) throw InvalidArgumentException("Invalid format specifier");
+        FormatTraits<std::decay_t<T>>::format(writer, *static_cast<const T*>(data), spec);
         
-        std::size_t index = 0; 
-        for(auto p = data.begin(), q = data.end(); p != q; ) {
+    }
+    
+    std::size_t getLiteralLength() const noexcept { return literalLength; }
+    
+    template<typename W, typename... Arg>
+    void write(W& writer, Arg&&... arg) const {
+        
+        const Argument<W> argument[sizeof...(Arg) + 1] = {{std::addressof(arg), &formatArgument<W, std::remove_reference_t<Arg>>}..., {nullptr, nullptr}};
+        for(auto&& segment : segments) {
             
-            auto begin = p;
-            while(*p != CharType('{') && *p != CharType('}') && p != q) ++p;
-            bool isEscape = false;
-            if(p != q) {
-                
-                if(*p == '{') {
-                    
-                    if(*(p + 1) == '{') ++p, isEscape = true;
-                    
-                } else if(*p == '}') {
-                    
-                    if(p + 1 == q || *(p + 1) != '}') throw InvalidArgumentException("Unexpected end of format string");
-                    ++p, isEscape = true;
-                    
-                }
-                
-            }
-            if(p != begin) {
-                
-                segments.emplace_back(-1, StringViewType(begin, p - begin));
-                if(isEscape) ++p;
-                
-            } else {
+            if(segment.index == Impl::FORMAT_LITERAL) writer.append(data.getData() + segment.begin, segment.end - segment.begin);
+            else {
                 
-                ++p;
-                begin = p;
-                while(p != q && *p >= '0' && *p <= '9') ++p;
-                if(p != begin) {
-                    
-                    index = *begin - '0';
-                    for(++begin; begin != p; ++begin) index = index * 10 + (*begin - '0');
-                    
-                }
-                if(p == q) throw InvalidArgumentException("Unexpected end of format string");
-                else if(*p == '}') segments.emplace_back(index, StringViewType(begin, p - begin));
-                else if(*p == ':') {
-                    
-                    begin = ++p;
-                    while(p != q && *p != CharType('}')) ++p;
-                    if(p == q) throw InvalidArgumentException("Unexpected end of format string");
-                    segments.emplace_back(index, StringViewType(begin, p - begin));
-                    
-                } else throw InvalidArgumentException("Unexpected character");
-                ++p;
-                ++index;
+                if(segment.index >= sizeof...(Arg)) throw InvalidArgumentException("Too few argument for formatter");
+                argument[segment.index].format(writer, argument[segment.index].data, segment.spec);
                 
             }
             
@@ -541,34 +1118,153 @@ public:
         
     }
     
-    template<typename... Arg>
-    StringType operator ()(Arg&&... arg) const { return format(std::forward<Arg>(arg)...); }
+public:
     
-    template<typename... Arg>
-    StringType format(Arg&&... arg) const {
+    Formatter(StringViewType data_) : data(data_) {
         
-        std::array<std::unique_ptr<HolderBase>, sizeof...(arg)> arr = {{std::unique_ptr<HolderBase>(new Holder<std::decay_t<Arg>>(arg))...}};
-        StringType str;
-        for(auto&& segment : segments) {
+        for(std::size_t pos = 0, index = 0; pos != data.getLength(); ) {
             
-            auto index = segment.index;
-            auto arg = segment.arg;
-            if(index == std::size_t(-1)) str += arg;
-            else {
-                
-                if(index >= arr.size()) throw InvalidArgumentException("Too few argument for formatter");
-                arr[index]->format(str, arg);
-                ++index;
-                
-            }
+            segments.push_back(Impl::parseFormatSegment(data.getData(), data.getLength(), pos, index));
+            auto& segment = segments.back();
+            if(segment.index != Impl::FORMAT_LITERAL) index = segment.index + 1;
+            else literalLength += segment.end - segment.begin;
             
         }
-        return str;
         
     }
     
 };
 
+
+namespace Impl {
+
+// The segments of the format string S::data(), parsed during compilation
+template <typename T, std::size_t N>
+struct FormatTable {
+    
+    FormatSegment<T> segment[N ? N : 1];
+    std::size_t argumentCount = 0;
+    std::size_t literalLength = 0;
+    
+};
+
+template <typename T>
+constexpr std::size_t countFormatSegment(const T* data, std::size_t size) {
+    
+    std::size_t count = 0;
+    for(std::size_t pos = 0, index = 0; pos != size; ++count) {
+        
+        auto segment = parseFormatSegment(data, size, pos, index);
+        if(segment.index != FORMAT_LITERAL) index = segment.index + 1;
+        
+    }
+    return count;
+    
+}
+template <typename T, std::size_t N>
+constexpr FormatTable<T, N> parseFormatTable(const T* data, std::size_t size) {
+    
+    FormatTable<T, N> table;
+    std::size_t pos = 0, index = 0;
+    for(std::size_t i = 0; i != N; ++i) {
+        
+        auto segment = parseFormatSegment(data, size, pos, index);
+        if(segment.index != FORMAT_LITERAL) {
+            
+            index = segment.index + 1;
+            if(table.argumentCount < index) table.argumentCount = index;
+            
+        } else table.literalLength += segment.end - segment.begin;
+        table.segment[i] = segment;
+        
+    }
+    return table;
+    
+}
+
+}
+
+// A formatter for a format string known at compile time, created by CORECAT_FORMAT. The string is parsed during
+// compilation, the arguments are checked against it, and write() runs one formatString call per segment.
+template <typename S>
+class StaticFormatter : public Impl::FormatterBase<StaticFormatter<S>, DefaultCharset<std::remove_const_t<std::remove_pointer_t<decltype(S::data())>>>> {
+    
+public:
+    
+    using CharType = std::remove_const_t<std::remove_pointer_t<decltype(S::data())>>;
+    using CharsetType = DefaultCharset<CharType>;
+    
+    using StringType = String<CharsetType>;
+    using StringViewType = StringView<CharsetType>;
+    
+private:
+    
+    friend Impl::FormatterBase<StaticFormatter<S>, CharsetType>;
+    
+    static constexpr std::size_t COUNT = Impl::countFormatSegment(S::data(), S::size());
+    static constexpr Impl::FormatTable<CharType, COUNT> TABLE = Impl::parseFormatTable<CharType, COUNT>(S::data(), S::size());
+    
+private:
+    
+    template <std::size_t I, typename W, typename T>
+    static void writeSegment(W& writer, const T&, std::true_type) {
+        
+        writer.append(S::data() + TABLE.segment[I].begin, TABLE.segment[I].end - TABLE.segment[I].begin);
+        
+    }
+    template <std::size_t I, typename W, typename T>
+    static void writeSegment(W& writer, const T& arg, std::false_type) {
+        
+        constexpr std::size_t INDEX = TABLE.segment[I].index;
+        using A = std::decay_t<std::tuple_element_t<INDEX, T>>;
+        static_assert(FormatTraits<A>::check(TABLE.segment[I].spec), "Invalid format specifier for argument");
+        FormatTraits<A>::format(writer, std::get<INDEX>(arg), TABLE.segment[I].spec);
+        
+    }
+    template <typename W, typename T, std::size_t... I>
+    static void writeSegment(W& writer, const T& arg, std::index_sequence<I...>) {
+        
+        using Expand = int[];
+        (void)Expand{0, (writeSegment<I>(writer, arg, std::integral_constant<bool, TABLE.segment[I].index == Impl::FORMAT_LITERAL>()), 0)...};
+        
+    }
+    
+    static constexpr std::size_t getLiteralLength() noexcept { return TABLE.literalLength; }
+    
+    template<typename W, typename... Arg>
+    static void write(W& writer, Arg&&... arg) {
+        
+        static_assert(sizeof...(Arg) >= TABLE.argumentCount, "Too few argument for formatter");
+        writeSegment(writer, std::forward_as_tuple(arg...), std::make_index_sequence<COUNT>());
+        
+    }
+    
+public:
+    
+    static constexpr std::size_t getArgumentCount() noexcept { return TABLE.argumentCount; }
+    
+};
+template <typename S>
+constexpr std::size_t StaticFormatter<S>::COUNT;
+template <typename S>
+constexpr Impl::FormatTable<typename StaticFormatter<S>::CharType, StaticFormatter<S>::COUNT> StaticFormatter<S>::TABLE;
+
+namespace Impl {
+
+template <typename S>
+constexpr StaticFormatter<S> makeStaticFormatter(S) noexcept { return {}; }
+
+}
+
+// Parses the string literal str during compilation and evaluates to its StaticFormatter
+#define CORECAT_FORMAT(str) (::Cats::Corecat::Text::Impl::makeStaticFormatter([] { \
+    struct FormatString { \
+        static constexpr decltype(str + 0) data() { return str; } \
+        static constexpr std::size_t size() { return sizeof(str) / sizeof(*(str)) - 1; } \
+    }; \
+    return FormatString(); \
+}()))
+
 using Formatter8 = Formatter<UTF8Charset<>>;
 using Formatter16 = Formatter<UTF16Charset<>>;
 using Formatter32 = Formatter<UTF32Charset<>>;
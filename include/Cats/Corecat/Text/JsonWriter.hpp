@@ -0,0 +1,129 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2016-2018 The Cats Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef CATS_CORECAT_TEXT_JSONWRITER_HPP
+#define CATS_CORECAT_TEXT_JSONWRITER_HPP
+
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include <type_traits>
+
+#include "Formatter.hpp"
+#include "String.hpp"
+#include "../Data/Stream/OutputStream.hpp"
+
+
+namespace Cats {
+namespace Corecat {
+inline namespace Text {
+
+// Writes JSON text to an OutputStream as the values come, through a small buffer. Commas and colons are placed
+// automatically, and values at the top level go on lines of their own, as in JSON Lines; whether keys and values
+// alternate properly is left to the caller. The buffer is written out by flush() or on destruction, where a failure
+// to write is ignored.
+class JsonWriter {
+    
+private:
+    
+    Impl::StreamFormatWriter<UTF8Charset<>> writer;
+    OutputStream<char>& stream;
+    std::size_t depth = 0;
+    bool comma = false;
+    
+private:
+    
+    void beginValue() {
+        
+        if(comma) writer.append(depth ? ',' : '\n');
+        comma = true;
+        
+    }
+    void writeString(StringView8 str) {
+        
+        writer.append('"');
+        Impl::writeJsonEscaped(writer, str.getData(), str.getData() + str.getLength());
+        writer.append('"');
+        
+    }
+    
+public:
+    
+    JsonWriter(OutputStream<char>& stream_) : writer(stream_), stream(stream_) {}
+    JsonWriter(const JsonWriter& src) = delete;
+    ~JsonWriter() { try { writer.flush(); } catch(...) {} }
+    
+    JsonWriter& operator =(const JsonWriter& src) = delete;
+    
+    JsonWriter& beginObject() { beginValue(), writer.append('{'), ++depth, comma = false; return *this; }
+    JsonWriter& endObject() { writer.append('}'), --depth, comma = true; return *this; }
+    JsonWriter& beginArray() { beginValue(), writer.append('['), ++depth, comma = false; return *this; }
+    JsonWriter& endArray() { writer.append(']'), --depth, comma = true; return *this; }
+    // The next value belongs to this key
+    JsonWriter& key(StringView8 str) { beginValue(), writeString(str), writer.append(':'), comma = false; return *this; }
+    
+    JsonWriter& value(std::nullptr_t) { beginValue(), writer.append("null", 4); return *this; }
+    JsonWriter& value(bool b) { beginValue(); if(b) writer.append("true", 4); else writer.append("false", 5); return *this; }
+    JsonWriter& value(StringView8 str) { beginValue(), writeString(str); return *this; }
+    JsonWriter& value(const char* str) { return value(StringView8(str)); }
+    template <typename T>
+    std::enable_if_t<std::is_integral<T>::value && std::is_unsigned<T>::value, JsonWriter&> value(T t) {
+        
+        char buffer[20];
+        beginValue(), writer.append(buffer, u64ToString(t, buffer) - buffer);
+        return *this;
+        
+    }
+    template <typename T>
+    std::enable_if_t<std::is_integral<T>::value && std::is_signed<T>::value, JsonWriter&> value(T t) {
+        
+        char buffer[20];
+        beginValue(), writer.append(buffer, i64ToString(t, buffer) - buffer);
+        return *this;
+        
+    }
+    // JSON has no infinities or NaN, so those are written as null
+    template <typename T>
+    std::enable_if_t<std::is_floating_point<T>::value, JsonWriter&> value(T t) {
+        
+        if(!std::isfinite(t)) return value(nullptr);
+        beginValue(), formatString(writer, t, FormatSpec<char>());
+        return *this;
+        
+    }
+    
+    void flush() { writer.flush(), stream.flush(); }
+    
+};
+
+}
+}
+}
+
+
+#endif
@@ -0,0 +1,346 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2016-2018 The Cats Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef CATS_CORECAT_TEXT_NUMBERPARSER_HPP
+#define CATS_CORECAT_TEXT_NUMBERPARSER_HPP
+
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <limits>
+#include <type_traits>
+
+#include "FloatConversion.hpp"
+#include "String.hpp"
+#include "../Util/Endian.hpp"
+
+
+namespace Cats {
+namespace Corecat {
+inline namespace Text {
+
+enum class ParseError {
+    
+    NONE,
+    INVALID_ARGUMENT,
+    OUT_OF_RANGE,
+    
+};
+
+// The value parsed from a string, or why there is none; value is zero on error, except for the infinities of an
+// out of range float
+template <typename T>
+struct ParseResult {
+    
+    T value;
+    ParseError error;
+    
+    explicit operator bool() const noexcept { return error == ParseError::NONE; }
+    
+};
+
+namespace Impl {
+
+template <typename T>
+inline bool isDecimalDigit(T t) noexcept { return t >= T('0') && t <= T('9'); }
+
+// Whether the eight bytes of x, first one lowest, are all ASCII digits
+inline bool isEightDigits(std::uint64_t x) noexcept {
+    
+    return !(((x + 0x4646464646464646) | (x - 0x3030303030303030)) & 0x8080808080808080);
+    
+}
+// The value of the eight ASCII digits in x, first one lowest, combining neighbours in three multiplications
+inline std::uint32_t parseEightDigits(std::uint64_t x) noexcept {
+    
+    x -= 0x3030303030303030;
+    x = x * 10 + (x >> 8);
+    x = ((x & 0x000000FF000000FF) * (100 + (1000000ull << 32)) + ((x >> 16) & 0x000000FF000000FF) * (1 + (10000ull << 32))) >> 32;
+    return std::uint32_t(x);
+    
+}
+
+template <typename T>
+inline std::enable_if_t<sizeof(T) == 1, bool> loadEightDigits(const T* p, std::uint32_t& v) noexcept {
+    
+    std::uint64_t x;
+    std::memcpy(&x, p, sizeof(x));
+    x = convertLittleToNative(x);
+    if(!isEightDigits(x)) return false;
+    v = parseEightDigits(x);
+    return true;
+    
+}
+template <typename T>
+inline std::enable_if_t<sizeof(T) != 1, bool> loadEightDigits(const T*, std::uint32_t&) noexcept { return false; }
+
+// Accumulates the decimal digits from p into v, eight at a time where the units are bytes, and returns where they end
+template <typename T>
+inline const T* parseDecimalDigits(const T* p, const T* q, std::uint64_t& v) noexcept {
+    
+    std::uint32_t x;
+    while(q - p >= 8 && loadEightDigits(p, x)) v = v * 100000000 + x, p += 8;
+    for(; p != q && isDecimalDigit(*p); ++p) v = v * 10 + std::uint64_t(*p - T('0'));
+    return p;
+    
+}
+
+template <typename T>
+inline const T* skipDecimalDigits(const T* p, const T* q) noexcept {
+    
+    while(p != q && isDecimalDigit(*p)) ++p;
+    return p;
+    
+}
+
+template <typename T>
+inline int getDigitValue(T t) noexcept {
+    
+    if(t >= T('0') && t <= T('9')) return int(t - T('0'));
+    if(t >= T('a') && t <= T('z')) return int(t - T('a')) + 10;
+    if(t >= T('A') && t <= T('Z')) return int(t - T('A')) + 10;
+    return 36;
+    
+}
+
+// The value of the digits in [p, q), written in base
+template <typename T>
+inline ParseError parseMagnitude(const T* p, const T* q, int base, std::uint64_t& v) noexcept {
+    
+    v = 0;
+    if(p == q) return ParseError::INVALID_ARGUMENT;
+    if(base == 10) {
+        
+        // Up to 19 digits cannot overflow, and a 20th only sometimes
+        while(p != q && *p == T('0')) ++p;
+        if(q - p <= 19) return parseDecimalDigits(p, q, v) == q ? ParseError::NONE : ParseError::INVALID_ARGUMENT;
+        const T* e = parseDecimalDigits(p, p + 19, v);
+        if(skipDecimalDigits(e, q) != q) return ParseError::INVALID_ARGUMENT;
+        std::uint64_t d = std::uint64_t(*e - T('0'));
+        if(q - e > 1 || v > (std::numeric_limits<std::uint64_t>::max() - d) / 10) return ParseError::OUT_OF_RANGE;
+        v = v * 10 + d;
+        return ParseError::NONE;
+        
+    }
+    bool overflow = false;
+    for(; p != q; ++p) {
+        
+        int d = getDigitValue(*p);
+        if(d >= base) return ParseError::INVALID_ARGUMENT;
+        if(v > (std::numeric_limits<std::uint64_t>::max() - std::uint64_t(d)) / std::uint64_t(base)) overflow = true;
+        else v = v * std::uint64_t(base) + std::uint64_t(d);
+        
+    }
+    return overflow ? ParseError::OUT_OF_RANGE : ParseError::NONE;
+    
+}
+
+// Whether [p, q) spells the lowercase ASCII word s, in any case
+template <typename T>
+inline bool matchIgnoreCase(const T* p, const T* q, const char* s) noexcept {
+    
+    for(; p != q && *s; ++p, ++s) if(*p != T(*s) && *p != T(*s - 'a' + 'A')) return false;
+    return p == q && !*s;
+    
+}
+
+// The at most POW10_EXACT_MAX powers of ten that a float type holds exactly
+template <typename F>
+inline F getExactPow10(int k) noexcept {
+    
+    static constexpr double POW10[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+    };
+    return F(POW10[k]);
+    
+}
+
+// The F nearest to the decimal [ib, ie).[fb, fe) * 10^e, from bits; the digits hold no sign and at least one digit
+template <typename F, typename T>
+inline typename FloatTraits<F>::BitsType parseDecimalFloat(const T* ib, const T* ie, const T* fb, const T* fe, long e) noexcept {
+    
+    using Traits = FloatTraits<F>;
+    using U = typename Traits::BitsType;
+    
+    // Only significant digits count, so zeros are skipped up to the first other digit
+    const T* s = ib;
+    while(s != ie && *s == T('0')) ++s;
+    const T* f = fb;
+    if(s == ie) while(f != fe && *f == T('0')) ++f;
+    long integerCount = long(ie - s), count = integerCount + long(fe - f);
+    // The value is the significant digits times 10^(e - fraction length); a power beyond any that matters is clamped
+    long scale = e - long(fe - fb);
+    auto getExponent = [&](long n) { long x = scale + count - n; return int(x < -100000 ? -100000 : x > 100000 ? 100000 : x); };
+    // Whether a digit after the first n is not zero
+    auto hasTail = [&](long n) {
+        
+        const T* r = f + (n - integerCount);
+        if(n < integerCount) {
+            
+            for(r = s + n; r != ie; ++r) if(*r != T('0')) return true;
+            r = f;
+            
+        }
+        for(; r != fe; ++r) if(*r != T('0')) return true;
+        return false;
+        
+    };
+    
+    // The first 19 significant digits fit in 64 bits
+    std::uint64_t w = 0;
+    long n = count < 19 ? count : 19, ni = integerCount < n ? integerCount : n;
+    parseDecimalDigits(s, s + ni, w);
+    parseDecimalDigits(f, f + (n - ni), w);
+    int q = getExponent(n);
+    bool tail = n < count && hasTail(n);
+    
+    // Exact products of exactly held values are correctly rounded by the FPU
+    if(!tail && q >= -Traits::POW10_EXACT_MAX && q <= Traits::POW10_EXACT_MAX && !(w >> (Traits::FRACTION_BITS + 1))) {
+        
+        F x = F(w);
+        x = q < 0 ? x / getExactPow10<F>(-q) : x * getExactPow10<F>(q);
+        U bits;
+        std::memcpy(&bits, &x, sizeof(F));
+        return bits;
+        
+    }
+    U bits = toBinaryFloat<F>(w, q);
+    // Digits were dropped: the value lies between w and w + 1 at this scale, and both bounds may round alike
+    if(!tail || toBinaryFloat<F>(w + 1, q) == bits) return bits;
+    
+    // Otherwise the digits decide, up to FLOAT_DIGIT_MAX of them; any halfway point has fewer
+    BigInteger d;
+    long m = count < FLOAT_DIGIT_MAX ? count : FLOAT_DIGIT_MAX, k = 0;
+    std::uint32_t chunk = 0;
+    int chunkLength = 0;
+    auto push = [&](T t) {
+        
+        chunk = chunk * 10 + std::uint32_t(t - T('0'));
+        if(++chunkLength == 9) d.multiplyPow10(9), d += chunk, chunk = 0, chunkLength = 0;
+        
+    };
+    for(const T* r = s; k < m && r != ie; ++r, ++k) push(*r);
+    for(const T* r = f; k < m && r != fe; ++r, ++k) push(*r);
+    d.multiplyPow10(chunkLength), d += chunk;
+    return adjustBinaryFloat<F>(d, getExponent(m), m < count && hasTail(m), bits);
+    
+}
+
+}
+
+// Parses an integer of type T, an optional sign followed by digits in base, between 2 and 36; the whole of sv must
+// be the number. Letters are digits from 10 on in either case, and there is no prefix such as 0x
+template <typename T, typename C>
+inline ParseResult<T> parseInteger(const StringView<C>& sv, int base = 10) noexcept {
+    
+    static_assert(std::is_integral<T>::value, "T must be an integral type");
+    
+    using CharType = typename C::CharType;
+    
+    const CharType* p = sv.getData();
+    const CharType* q = p + sv.getLength();
+    if(base < 2 || base > 36) return {0, ParseError::INVALID_ARGUMENT};
+    bool negative = false;
+    if(p != q && (*p == CharType('+') || *p == CharType('-'))) negative = *p++ == CharType('-');
+    if(negative && std::is_unsigned<T>::value) return {0, ParseError::INVALID_ARGUMENT};
+    
+    std::uint64_t v;
+    ParseError error = Impl::parseMagnitude(p, q, base, v);
+    if(error != ParseError::NONE) return {0, error};
+    if(v > std::uint64_t(std::numeric_limits<T>::max()) + negative) return {0, ParseError::OUT_OF_RANGE};
+    using U = std::make_unsigned_t<T>;
+    return {negative ? T(U(0) - U(v)) : T(v), ParseError::NONE};
+    
+}
+template <typename T, typename C>
+inline ParseResult<T> parseInteger(const String<C>& str, int base = 10) noexcept { return parseInteger<T>(str.getView(), base); }
+
+// Parses a decimal floating point number of type T, correctly rounded: an optional sign, digits with an optional
+// point, and an optional exponent, or inf, infinity or nan in any case. The whole of sv must be the number; a finite
+// number too large for T is out of range
+template <typename T, typename C>
+inline ParseResult<T> parseFloat(const StringView<C>& sv) noexcept {
+    
+    static_assert(std::is_floating_point<T>::value, "T must be a floating point type");
+    
+    using CharType = typename C::CharType;
+    using F = std::conditional_t<std::is_same<T, float>::value, float, double>;
+    using Traits = Impl::FloatTraits<F>;
+    using U = typename Traits::BitsType;
+    
+    const CharType* p = sv.getData();
+    const CharType* q = p + sv.getLength();
+    bool negative = false;
+    if(p != q && (*p == CharType('+') || *p == CharType('-'))) negative = *p++ == CharType('-');
+    
+    const CharType* ib = p;
+    const CharType* ie = p = Impl::skipDecimalDigits(p, q);
+    const CharType* fb = p;
+    const CharType* fe = p;
+    if(p != q && *p == CharType('.')) fb = ++p, fe = p = Impl::skipDecimalDigits(p, q);
+    if(ib == ie && fb == fe) {
+        
+        // A lone point is not a number
+        if(fb != ib) return {0, ParseError::INVALID_ARGUMENT};
+        if(Impl::matchIgnoreCase(p, q, "inf") || Impl::matchIgnoreCase(p, q, "infinity"))
+            return {negative ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::infinity(), ParseError::NONE};
+        if(Impl::matchIgnoreCase(p, q, "nan"))
+            return {negative ? -std::numeric_limits<T>::quiet_NaN() : std::numeric_limits<T>::quiet_NaN(), ParseError::NONE};
+        return {0, ParseError::INVALID_ARGUMENT};
+        
+    }
+    long e = 0;
+    if(p != q && (*p == CharType('e') || *p == CharType('E'))) {
+        
+        bool negativeExponent = false;
+        if(++p != q && (*p == CharType('+') || *p == CharType('-'))) negativeExponent = *p++ == CharType('-');
+        if(p == q || !Impl::isDecimalDigit(*p)) return {0, ParseError::INVALID_ARGUMENT};
+        for(; p != q && Impl::isDecimalDigit(*p); ++p) if(e < 100000) e = e * 10 + long(*p - CharType('0'));
+        if(negativeExponent) e = -e;
+        
+    }
+    if(p != q) return {0, ParseError::INVALID_ARGUMENT};
+    
+    U bits = Impl::parseDecimalFloat<F>(ib, ie, fb, fe, e);
+    ParseError error = bits == U(Traits::EXPONENT_MAX) << Traits::FRACTION_BITS ? ParseError::OUT_OF_RANGE : ParseError::NONE;
+    if(negative) bits |= U(1) << (sizeof(U) * 8 - 1);
+    F x;
+    std::memcpy(&x, &bits, sizeof(F));
+    return {T(x), error};
+    
+}
+template <typename T, typename C>
+inline ParseResult<T> parseFloat(const String<C>& str) noexcept { return parseFloat<T>(str.getView()); }
+
+}
+}
+}
+
+
+#endif
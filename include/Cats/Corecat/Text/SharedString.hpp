@@ -0,0 +1,299 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2016-2018 The Cats Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef CATS_CORECAT_TEXT_SHAREDSTRING_HPP
+#define CATS_CORECAT_TEXT_SHAREDSTRING_HPP
+
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+
+#include "String.hpp"
+
+
+namespace Cats {
+namespace Corecat {
+inline namespace Text {
+
+namespace Impl {
+
+// A word-at-a-time multiplicative hash; keys here are short, so it favours latency over statistical strength
+inline std::size_t hashString(const void* data, std::size_t size) noexcept {
+    
+    constexpr std::uint64_t K = 0x9E3779B97F4A7C15;
+    auto p = static_cast<const unsigned char*>(data);
+    std::uint64_t h = size * K;
+    for(; size >= 8; size -= 8, p += 8) {
+        
+        std::uint64_t x;
+        std::memcpy(&x, p, 8);
+        h = (h ^ x) * K;
+        h ^= h >> 32;
+        
+    }
+    if(size) {
+        
+        std::uint64_t x = 0;
+        std::memcpy(&x, p, size);
+        h = (h ^ x) * K;
+        h ^= h >> 32;
+        
+    }
+    h *= K;
+    return std::size_t(h ^ (h >> 29));
+    
+}
+
+}
+
+// An immutable string whose copies share one buffer through an atomic reference count. The length and the hash are
+// computed once at construction. Strings returned by intern() are canonical: equal interned strings share a buffer,
+// so comparing two of them is a pointer comparison.
+template <typename C>
+class SharedString {
+    
+public:
+    
+    using CharsetType = C;
+    using CharType = typename C::CharType;
+    
+    using Iterator = const CharType*;
+    using ConstIterator = Iterator;
+    
+    using StringType = String<C>;
+    using StringViewType = StringView<C>;
+    
+private:
+    
+    struct Header {
+        
+        std::atomic<std::size_t> count;
+        std::size_t length;
+        std::size_t hash;
+        bool interned;
+        
+        CharType* getData() noexcept { return reinterpret_cast<CharType*>(this + 1); }
+        
+    };
+    
+    // The table holds a reference to every interned string, so they live until the program ends. It is split into
+    // stripes by hash so that threads interning different strings rarely take the same lock.
+    class InternTable {
+        
+    private:
+        
+        static constexpr std::size_t STRIPE = 64;
+        
+        struct Stripe {
+            
+            std::mutex mutex;
+            std::unordered_multimap<std::size_t, Header*> map;
+            
+        };
+        
+    private:
+        
+        Stripe stripe[STRIPE];
+        
+    public:
+        
+        ~InternTable() {
+            
+            for(auto& s : stripe)
+                for(auto& p : s.map) release(p.second);
+                
+        }
+        
+        Header* intern(const StringViewType& sv, std::size_t hash) {
+            
+            auto& s = stripe[(hash >> 7) % STRIPE];
+            std::lock_guard<std::mutex> lock(s.mutex);
+            auto range = s.map.equal_range(hash);
+            for(auto it = range.first; it != range.second; ++it)
+                if(StringViewType(it->second->getData(), it->second->length) == sv) return it->second;
+            auto header = create(sv.getData(), sv.getLength(), hash);
+            header->interned = true;
+            s.map.emplace(hash, header);
+            return header;
+            
+        }
+        
+    };
+    
+private:
+    
+    Header* header = nullptr;
+    
+private:
+    
+    static Header* create(const CharType* data, std::size_t length, std::size_t hash) {
+        
+        auto header = new(::operator new(sizeof(Header) + (length + 1) * sizeof(CharType))) Header;
+        header->count.store(1, std::memory_order_relaxed);
+        header->length = length;
+        header->hash = hash;
+        header->interned = false;
+        std::copy(data, data + length, header->getData());
+        header->getData()[length] = CharType();
+        return header;
+        
+    }
+    static std::size_t hash(const CharType* data, std::size_t length) noexcept { return Impl::hashString(data, length * sizeof(CharType)); }
+    static InternTable& getInternTable() {
+        
+        static InternTable table;
+        return table;
+        
+    }
+    
+    static void release(Header* header) noexcept {
+        
+        if(header && header->count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            
+            header->~Header();
+            ::operator delete(header);
+            
+        }
+        
+    }
+    
+public:
+    
+    SharedString() noexcept = default;
+    SharedString(const CharType* data) : SharedString(StringViewType(data)) {}
+    SharedString(const CharType* data, std::size_t length) : SharedString(StringViewType(data, length)) {}
+    SharedString(const StringViewType& sv) {
+        
+        if(!sv.isEmpty()) header = create(sv.getData(), sv.getLength(), hash(sv.getData(), sv.getLength()));
+        
+    }
+    SharedString(const StringType& str) : SharedString(str.getView()) {}
+    SharedString(const SharedString& src) noexcept : header(src.header) {
+        
+        if(header) header->count.fetch_add(1, std::memory_order_relaxed);
+        
+    }
+    SharedString(SharedString&& src) noexcept : header(src.header) { src.header = nullptr; }
+    ~SharedString() { release(header); }
+    
+    SharedString& operator =(const SharedString& src) noexcept {
+        
+        if(src.header) src.header->count.fetch_add(1, std::memory_order_relaxed);
+        release(header);
+        header = src.header;
+        return *this;
+        
+    }
+    SharedString& operator =(SharedString&& src) noexcept { std::swap(header, src.header); return *this; }
+    
+    const CharType& operator [](std::size_t index) const noexcept { return getData()[index]; }
+    
+    friend bool operator ==(const SharedString& a, const SharedString& b) noexcept {
+        
+        if(a.header == b.header) return true;
+        if(!a.header || !b.header || (a.header->interned && b.header->interned) || a.header->hash != b.header->hash) return false;
+        return a.getView() == b.getView();
+        
+    }
+    friend bool operator !=(const SharedString& a, const SharedString& b) noexcept { return !(a == b); }
+    friend bool operator <(const SharedString& a, const SharedString& b) noexcept { return a.getView() < b.getView(); }
+    friend bool operator >(const SharedString& a, const SharedString& b) noexcept { return a.getView() > b.getView(); }
+    friend bool operator <=(const SharedString& a, const SharedString& b) noexcept { return a.getView() <= b.getView(); }
+    friend bool operator >=(const SharedString& a, const SharedString& b) noexcept { return a.getView() >= b.getView(); }
+    
+    friend std::basic_ostream<CharType>& operator <<(std::basic_ostream<CharType>& stream, const SharedString& str) {
+        
+        stream.write(str.getData(), str.getLength());
+        return stream;
+        
+    }
+    
+    operator StringViewType() const noexcept { return getView(); }
+    
+    const CharType* getData() const noexcept {
+        
+        static const CharType EMPTY = CharType();
+        return header ? header->getData() : &EMPTY;
+        
+    }
+    std::size_t getLength() const noexcept { return header ? header->length : 0; }
+    std::size_t getHash() const noexcept { return header ? header->hash : hash(nullptr, 0); }
+    StringViewType getView() const noexcept { return {getData(), getLength()}; }
+    
+    bool isEmpty() const noexcept { return !header; }
+    bool isInterned() const noexcept { return header && header->interned; }
+    
+    StringType toString() const { return StringType(getView()); }
+    
+    Iterator begin() const noexcept { return getData(); }
+    Iterator end() const noexcept { return getData() + getLength(); }
+    
+    // Returns the canonical instance equal to sv, creating it on first use
+    static SharedString intern(const StringViewType& sv) {
+        
+        SharedString ret;
+        if(sv.isEmpty()) return ret;
+        ret.header = getInternTable().intern(sv, hash(sv.getData(), sv.getLength()));
+        ret.header->count.fetch_add(1, std::memory_order_relaxed);
+        return ret;
+        
+    }
+    // Interning an interned string is free
+    SharedString intern() const { return isInterned() || !header ? *this : intern(getView()); }
+    
+};
+
+using SharedString8 = SharedString<UTF8Charset<>>;
+using SharedString16 = SharedString<UTF16Charset<>>;
+using SharedString32 = SharedString<UTF32Charset<>>;
+using WSharedString = SharedString<WideCharset<>>;
+
+}
+}
+}
+
+
+namespace std {
+
+template <typename C>
+struct hash<Cats::Corecat::Text::SharedString<C>> {
+    
+    std::size_t operator ()(const Cats::Corecat::Text::SharedString<C>& str) const noexcept { return str.getHash(); }
+    
+};
+
+}
+
+
+#endif
@@ -29,12 +29,17 @@
 
 
 #include <cstddef>
+#include <cstring>
 
 #include <algorithm>
 #include <iostream>
+#include <limits>
+#include <stdexcept>
 #include <string>
 
 #include "Charset/DefaultCharset.hpp"
+#include "Charset/Transcoder.hpp"
+#include "StringSearch.hpp"
 #include "../Util/Iterator.hpp"
 
 
@@ -48,9 +53,6 @@ template <typename C>
 class Formatter;
 
 
-// TODO: Use immutable string?
-
-
 template <typename C>
 class String {
     
@@ -92,6 +94,50 @@ private:
     
     bool isSmall() const noexcept { return static_cast<std::size_t>(storage.buffer.length) < BUFFER_SIZE; }
     
+    template <typename D>
+    String& appendTranscode(const typename D::CharType* b, const typename D::CharType* e, std::false_type) {
+        
+        CharType buf[C::MAX_CODE_UNIT];
+        while(b != e) {
+            
+            char32_t c = D::decode(b, e);
+            if(c == 0xFFFFFFFF) break;
+            auto q = buf;
+            C::encode(q, std::end(buf), c);
+            append(buf, q - buf);
+            
+        }
+        return *this;
+        
+    }
+    // Converts straight into the string's own storage; the kernel stops at anything ill-formed, and the charset's
+    // scalar decode decides how that is replaced before the kernel resumes
+    template <typename D>
+    String& appendTranscode(const typename D::CharType* b, const typename D::CharType* e, std::true_type) {
+        
+        using X = Transcoder<D, C>;
+        
+        auto length = getLength();
+        while(b != e) {
+            
+            setLength(length + (e - b) * X::RATIO);
+            auto data = getData();
+            auto r = X::transcode(b, e, data + length);
+            if(b != e) {
+                
+                char32_t c = D::decode(b, e);
+                if(c == 0xFFFFFFFF) e = b;
+                else C::encode(r, data + getLength(), c);
+                
+            }
+            length = r - data;
+            
+        }
+        setLength(length);
+        return *this;
+        
+    }
+    
 public:
     
     String() noexcept { storage.buffer.data[0] = 0; storage.buffer.length = BUFFER_SIZE - 1; }
@@ -121,15 +167,25 @@ public:
     String& operator +=(const String& str) { append(str); return *this; }
     String& operator +=(const StringViewType& sv) { append(sv); return *this; }
     
-    friend String operator +(const String& a, CharType b) { String t(a); t += b; return t; }
-    friend String operator +(const String& a, const CharType* b) { String t(a); t += b; return t; }
-    friend String operator +(const String& a, const String& b) { String t(a); t += b; return t; }
-    friend String operator +(const String& a, const StringViewType& b) { String t(a); t += b; return t; }
-    friend String operator +(CharType a, const String& b) { String t(a); t += b; return t; }
-    friend String operator +(const CharType* a, const String& b) { String t(a); t += b; return t; }
+    friend String operator +(const String& a, CharType b) { return concat(a, StringViewType(&b, 1)); }
+    friend String operator +(const String& a, const CharType* b) { return concat(a, b); }
+    friend String operator +(const String& a, const String& b) { return concat(a, b); }
+    friend String operator +(const String& a, const StringViewType& b) { return concat(a, b); }
+    friend String operator +(CharType a, const String& b) { return concat(StringViewType(&a, 1), b); }
+    friend String operator +(const CharType* a, const String& b) { return concat(a, b); }
     
     String& operator *=(std::size_t count) { return *this = repeat(count); }
     
+    // Sizes the result once instead of copying a and then growing it for b
+    static String concat(const StringViewType& a, const StringViewType& b) {
+        
+        String t;
+        t.reserve(a.getLength() + b.getLength());
+        t.append(a).append(b);
+        return t;
+        
+    }
+    
     friend String operator *(const String& a, std::size_t b) { return a.repeat(b); }
     
     CharType& operator [](std::size_t index) noexcept { return getData()[index]; };
@@ -179,6 +235,8 @@ public:
     const CharType* getData() const noexcept { return const_cast<String*>(this)->getData(); }
     std::size_t getLength() const noexcept { return isSmall() ? BUFFER_SIZE - storage.buffer.length - 1 : storage.length; }
     std::size_t getCapacity() const noexcept { return isSmall() ? BUFFER_SIZE - 1 : storage.capacity; }
+    // Leaves room for the terminator and keeps the allocation size within ptrdiff_t
+    static constexpr std::size_t getMaxCapacity() noexcept { return std::size_t(std::numeric_limits<std::ptrdiff_t>::max()) / sizeof(CharType) - 1; }
     
     StringViewType getView() const noexcept { return {getData(), getLength()}; }
     
@@ -193,6 +251,12 @@ public:
     std::ptrdiff_t find(const CharType* data_, std::size_t length_, std::ptrdiff_t beginPos) const noexcept { return getView().find(data_, length_, beginPos); }
     std::ptrdiff_t find(const CharType* data_, std::ptrdiff_t beginPos = 0) const noexcept { return getView().find(data_, beginPos); }
     std::ptrdiff_t find(const StringViewType& sv, std::ptrdiff_t beginPos = 0) const noexcept { return getView().find(sv, beginPos); }
+    std::ptrdiff_t rfind(CharType ch, std::ptrdiff_t endPos = std::numeric_limits<std::ptrdiff_t>::max()) const noexcept { return getView().rfind(ch, endPos); }
+    std::ptrdiff_t rfind(const CharType* data_, std::size_t length_, std::ptrdiff_t endPos) const noexcept { return getView().rfind(data_, length_, endPos); }
+    std::ptrdiff_t rfind(const CharType* data_, std::ptrdiff_t endPos = std::numeric_limits<std::ptrdiff_t>::max()) const noexcept { return getView().rfind(data_, endPos); }
+    std::ptrdiff_t rfind(const StringViewType& sv, std::ptrdiff_t endPos = std::numeric_limits<std::ptrdiff_t>::max()) const noexcept { return getView().rfind(sv, endPos); }
+    std::ptrdiff_t findAnyOf(const StringViewType& set, std::ptrdiff_t beginPos = 0) const noexcept { return getView().findAnyOf(set, beginPos); }
+    std::ptrdiff_t findAnyOf(const CharType* set, std::ptrdiff_t beginPos = 0) const noexcept { return getView().findAnyOf(set, beginPos); }
     
     String repeat(std::size_t count) const { return getView().repeat(count); }
     
@@ -216,15 +280,17 @@ public:
         
         if(cap > getCapacity()) {
             
+            if(cap > getMaxCapacity()) throw std::length_error("String is too long");
+            bool small = isSmall();
             auto length = getLength();
             auto oldData = getData();
             auto newData = new CharType[cap + 1];
             std::copy(oldData, oldData + length + 1, newData);
+            if(!small) delete[] oldData;
             storage.data = newData;
             storage.length = length;
             storage.capacity = cap;
-            if(isSmall()) storage.buffer.length = BUFFER_SIZE;
-            else delete[] oldData;
+            if(small) storage.buffer.length = BUFFER_SIZE;
             
         }
         
@@ -232,7 +298,13 @@ public:
     
     void setLength(std::size_t length) {
         
-        reserve(length);
+        // Grow geometrically so that a run of appends copies each character a bounded number of times
+        if(length > getCapacity()) {
+            
+            auto cap = getCapacity();
+            reserve(std::max(length, cap > getMaxCapacity() / 2 ? getMaxCapacity() : cap * 2));
+            
+        }
         getData()[length] = 0;
         if(isSmall()) storage.buffer.length = CharType(BUFFER_SIZE - length - 1);
         else storage.length = length;
@@ -285,21 +357,7 @@ public:
         
     }
     template <typename T, typename D = DefaultCharset<typename std::iterator_traits<const T*>::value_type>, typename = std::enable_if_t<!std::is_same<T, CharType>::value>>
-    String& append(const T* b, const T* e) {
-        
-        CharType buf[C::MAX_CODE_UNIT];
-        while(b != e) {
-            
-            char32_t c = D::decode(b, e);
-            if(c == 0xFFFFFFFF) break;
-            auto q = buf;
-            C::encode(q, std::end(buf), c);
-            append(buf, q - buf);
-            
-        }
-        return *this;
-        
-    }
+    String& append(const T* b, const T* e) { return appendTranscode<D>(b, e, std::integral_constant<bool, (Transcoder<D, C>::RATIO > 0)>()); }
     String& append(const CharType* b, const CharType* e) { return append(b, e - b); }
     
     String reverse() const noexcept {
@@ -367,6 +425,15 @@ private:
     const CharType* data;
     std::size_t length;
     
+private:
+    
+    std::size_t clampEnd(std::ptrdiff_t endPos) const noexcept {
+        
+        if(endPos < 0) return std::size_t(std::max<std::ptrdiff_t>(endPos + length, 0));
+        return std::min<std::size_t>(endPos, length);
+        
+    }
+    
 public:
     
     constexpr StringView() noexcept : data(nullptr), length(0) {}
@@ -378,20 +445,18 @@ public:
     
     StringView& operator =(const StringView& src) = default;
     
-    friend StringType operator +(const StringView& a, CharType b) { StringType t(a); t += b; return t; }
-    friend StringType operator +(const StringView& a, const CharType* b) { StringType t(a); t += b; return t; }
-    friend StringType operator +(const StringView& a, const StringView& b) { StringType t(a); t += b; return t; }
-    friend StringType operator +(const StringView& a, const StringType& b) { StringType t(a); t += b; return t; }
-    friend StringType operator +(CharType a, const StringView& b) { StringType t(a); t += b; return t; }
-    friend StringType operator +(const CharType* a, const StringView& b) { StringType t(a); t += b; return t; }
+    friend StringType operator +(const StringView& a, CharType b) { return StringType::concat(a, StringView(&b, 1)); }
+    friend StringType operator +(const StringView& a, const CharType* b) { return StringType::concat(a, b); }
+    friend StringType operator +(const StringView& a, const StringView& b) { return StringType::concat(a, b); }
+    friend StringType operator +(const StringView& a, const StringType& b) { return StringType::concat(a, b); }
+    friend StringType operator +(CharType a, const StringView& b) { return StringType::concat(StringView(&a, 1), b); }
+    friend StringType operator +(const CharType* a, const StringView& b) { return StringType::concat(a, b); }
     
     const CharType& operator [](std::size_t index) const noexcept { return data[index]; }
     
     friend bool operator ==(const StringView& a, const StringView& b) noexcept {
         
-        if(a.length != b.length) return false;
-        for(auto p = a.data, q = b.data, end = p + a.length; p != end; ++p, ++q) if(*p != *q) return false;
-        return true;
+        return a.length == b.length && (!a.length || !std::memcmp(a.data, b.data, a.length * sizeof(CharType)));
         
     }
     friend bool operator !=(const StringView& a, const StringView& b) noexcept { return !(a == b); }
@@ -439,28 +504,48 @@ public:
         if(beginPos >= static_cast<std::ptrdiff_t>(length)) return -1;
         if(beginPos < 0) beginPos += length;
         beginPos = std::max<std::ptrdiff_t>(beginPos, 0);
-        for(auto p = data + beginPos, end = data + length; p < end; ++p) if(*p == ch) return p - data;
-        return -1;
+        auto p = Impl::findChar(data + beginPos, data + length, ch);
+        return p ? p - data : -1;
         
     }
     std::ptrdiff_t find(const CharType* data_, std::size_t length_, std::ptrdiff_t beginPos) const noexcept {
         
-        if(length < length_ || beginPos + length_ > length) return -1;
-        if(beginPos < 0) beginPos += length;
-        beginPos = std::max<std::ptrdiff_t>(beginPos, 0);
-        for(auto p = data + beginPos, end1 = data + length - length_ + 1; p < end1; ++p) {
-            
-            auto q = p, end2 = p + length_;
-            for(auto r = data_; q < end2 && *q == *r; ++q, ++r);
-            if(q == end2) return p - data;
-            
-        }
-        return -1;
+        if(beginPos < 0) beginPos = std::max<std::ptrdiff_t>(beginPos + length, 0);
+        if(beginPos > static_cast<std::ptrdiff_t>(length)) return -1;
+        auto p = Impl::findSubstring(data + beginPos, data + length, data_, length_);
+        return p ? p - data : -1;
         
     }
     std::ptrdiff_t find(const CharType* data_, std::ptrdiff_t beginPos = 0) const noexcept { return find(data_, C::getLength(data_), beginPos); }
     std::ptrdiff_t find(const StringView& sv, std::ptrdiff_t beginPos = 0) const noexcept { return find(sv.getData(), sv.getLength(), beginPos); }
     
+    // The last match lying entirely before endPos
+    std::ptrdiff_t rfind(CharType ch, std::ptrdiff_t endPos = std::numeric_limits<std::ptrdiff_t>::max()) const noexcept {
+        
+        auto p = Impl::findLastChar(data, data + clampEnd(endPos), ch);
+        return p ? p - data : -1;
+        
+    }
+    std::ptrdiff_t rfind(const CharType* data_, std::size_t length_, std::ptrdiff_t endPos) const noexcept {
+        
+        auto p = Impl::findLastSubstring(data, data + clampEnd(endPos), data_, length_);
+        return p ? p - data : -1;
+        
+    }
+    std::ptrdiff_t rfind(const CharType* data_, std::ptrdiff_t endPos = std::numeric_limits<std::ptrdiff_t>::max()) const noexcept { return rfind(data_, C::getLength(data_), endPos); }
+    std::ptrdiff_t rfind(const StringView& sv, std::ptrdiff_t endPos = std::numeric_limits<std::ptrdiff_t>::max()) const noexcept { return rfind(sv.getData(), sv.getLength(), endPos); }
+    
+    // The first character that is in set
+    std::ptrdiff_t findAnyOf(const StringView& set, std::ptrdiff_t beginPos = 0) const noexcept {
+        
+        if(beginPos >= static_cast<std::ptrdiff_t>(length)) return -1;
+        if(beginPos < 0) beginPos = std::max<std::ptrdiff_t>(beginPos + length, 0);
+        auto p = Impl::findAnyOf(data + beginPos, data + length, set.getData(), set.getLength());
+        return p ? p - data : -1;
+        
+    }
+    std::ptrdiff_t findAnyOf(const CharType* set, std::ptrdiff_t beginPos = 0) const noexcept { return findAnyOf(StringView(set), beginPos); }
+    
     StringType repeat(std::size_t count) const {
         
         StringType t;
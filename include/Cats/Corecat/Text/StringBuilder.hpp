@@ -0,0 +1,193 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2016-2018 The Cats Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef CATS_CORECAT_TEXT_STRINGBUILDER_HPP
+#define CATS_CORECAT_TEXT_STRINGBUILDER_HPP
+
+
+#include <cstddef>
+
+#include <algorithm>
+#include <utility>
+
+#include "String.hpp"
+#include "../Data/Allocator/FastAllocator.hpp"
+
+
+namespace Cats {
+namespace Corecat {
+inline namespace Text {
+
+// Collects fragments in segments carved out of an arena and copies them into a String once, in toString(). Nothing
+// already appended is moved again, so building a large string costs one copy per character plus the final one.
+template <typename C, typename A = FastAllocator<>>
+class StringBuilder {
+    
+public:
+    
+    using CharsetType = C;
+    using CharType = typename C::CharType;
+    
+    using StringType = String<C>;
+    using StringViewType = StringView<C>;
+    
+private:
+    
+    struct Segment {
+        
+        Segment* next;
+        std::size_t length;
+        std::size_t capacity;
+        
+        CharType* getData() noexcept { return reinterpret_cast<CharType*>(this + 1); }
+        
+    };
+    
+    // In code units; the largest segment still leaves room for several in one arena block
+    static constexpr std::size_t MIN_SEGMENT = 256 / sizeof(CharType);
+    static constexpr std::size_t MAX_SEGMENT = 16384 / sizeof(CharType);
+    
+private:
+    
+    A allocator;
+    Segment* first = nullptr;
+    Segment* last = nullptr;
+    std::size_t length = 0;
+    
+private:
+    
+    // Segments double up to MAX_SEGMENT; a fragment larger than that gets a segment of its own size
+    Segment* addSegment(std::size_t count) {
+        
+        std::size_t capacity = std::max(count, last ? std::min(last->capacity * 2, MAX_SEGMENT) : MIN_SEGMENT);
+        // The arena packs allocations back to back, so keep every size a multiple of the header's alignment
+        std::size_t size = (sizeof(Segment) + capacity * sizeof(CharType) + alignof(Segment) - 1) & ~(alignof(Segment) - 1);
+        auto segment = static_cast<Segment*>(allocator.allocate(size));
+        segment->next = nullptr;
+        segment->length = 0;
+        segment->capacity = capacity;
+        if(last) last->next = segment, last = segment;
+        else first = last = segment;
+        return segment;
+        
+    }
+    
+public:
+    
+    StringBuilder() = default;
+    StringBuilder(const StringBuilder& src) = delete;
+    // The segments stay in the arena, which moves with them
+    StringBuilder(StringBuilder&& src) : allocator(std::move(src.allocator)), first(src.first), last(src.last), length(src.length) {
+        
+        src.first = src.last = nullptr, src.length = 0;
+        
+    }
+    
+    StringBuilder& operator =(const StringBuilder& src) = delete;
+    StringBuilder& operator =(StringBuilder&& src) {
+        
+        allocator = std::move(src.allocator);
+        first = src.first, last = src.last, length = src.length;
+        src.first = src.last = nullptr, src.length = 0;
+        return *this;
+        
+    }
+    
+    StringBuilder& operator +=(CharType ch) { return append(ch); }
+    StringBuilder& operator +=(const CharType* data) { return append(data); }
+    StringBuilder& operator +=(const StringViewType& sv) { return append(sv); }
+    StringBuilder& operator +=(const StringType& str) { return append(str); }
+    
+    StringBuilder& operator <<(CharType ch) { return append(ch); }
+    StringBuilder& operator <<(const CharType* data) { return append(data); }
+    StringBuilder& operator <<(const StringViewType& sv) { return append(sv); }
+    StringBuilder& operator <<(const StringType& str) { return append(str); }
+    
+    std::size_t getLength() const noexcept { return length; }
+    bool isEmpty() const noexcept { return !length; }
+    
+    StringBuilder& append(CharType ch) { return append(&ch, 1); }
+    StringBuilder& append(const CharType* data, std::size_t count) {
+        
+        length += count;
+        if(last) {
+            
+            std::size_t x = std::min(count, last->capacity - last->length);
+            std::copy(data, data + x, last->getData() + last->length);
+            last->length += x, data += x, count -= x;
+            
+        }
+        if(count) {
+            
+            auto segment = addSegment(count);
+            std::copy(data, data + count, segment->getData());
+            segment->length = count;
+            
+        }
+        return *this;
+        
+    }
+    StringBuilder& append(const CharType* data) { return append(data, C::getLength(data)); }
+    StringBuilder& append(const StringViewType& sv) { return append(sv.getData(), sv.getLength()); }
+    StringBuilder& append(const StringType& str) { return append(str.getData(), str.getLength()); }
+    
+    void clear() {
+        
+        allocator.clear();
+        first = last = nullptr;
+        length = 0;
+        
+    }
+    
+    StringType toString() const {
+        
+        StringType str;
+        str.setLength(length);
+        auto p = str.getData();
+        for(auto segment = first; segment; segment = segment->next)
+            p = std::copy(segment->getData(), segment->getData() + segment->length, p);
+        return str;
+        
+    }
+    
+};
+
+template <typename C, typename A>
+constexpr std::size_t StringBuilder<C, A>::MIN_SEGMENT;
+template <typename C, typename A>
+constexpr std::size_t StringBuilder<C, A>::MAX_SEGMENT;
+
+using StringBuilder8 = StringBuilder<UTF8Charset<>>;
+using StringBuilder16 = StringBuilder<UTF16Charset<>>;
+using StringBuilder32 = StringBuilder<UTF32Charset<>>;
+using WStringBuilder = StringBuilder<WideCharset<>>;
+
+}
+}
+}
+
+
+#endif
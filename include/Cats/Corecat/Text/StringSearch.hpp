@@ -0,0 +1,469 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2016-2018 The Cats Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef CATS_CORECAT_TEXT_STRINGSEARCH_HPP
+#define CATS_CORECAT_TEXT_STRINGSEARCH_HPP
+
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <type_traits>
+
+#include "../System/Architecture.hpp"
+#include "../System/Compiler.hpp"
+#include "../Util/Bit.hpp"
+
+#if defined(CORECAT_ARCHITECTURE_X86) || defined(CORECAT_ARCHITECTURE_X86_64)
+#   include <immintrin.h>
+#   include "../X86/X86FeatureBase.hpp"
+#endif
+
+
+namespace Cats {
+namespace Corecat {
+inline namespace Text {
+
+namespace Impl {
+
+// Search kernels behind StringView. They work on code units of 1, 2 or 4 bytes, take half-open ranges and return
+// nullptr when nothing is found.
+
+template <typename T>
+inline bool equalUnit(const T* a, const T* b, std::size_t count) noexcept {
+    
+    return !count || !std::memcmp(a, b, count * sizeof(T));
+    
+}
+
+template <typename T>
+inline const T* findCharScalar(const T* p, const T* q, T c) noexcept {
+    
+    for(; p != q; ++p) if(*p == c) return p;
+    return nullptr;
+    
+}
+template <typename T>
+inline const T* findLastCharScalar(const T* p, const T* q, T c) noexcept {
+    
+    while(q != p) if(*--q == c) return q;
+    return nullptr;
+    
+}
+
+// Boyer-Moore-Horspool, with the shift table keyed on the low byte of each code unit. The filter below does poorly
+// once a needle is long enough that whole vectors of candidates fail late, and this skips ahead by up to m instead
+template <typename T>
+inline const T* findHorspool(const T* p, const T* q, const T* s, std::size_t m) noexcept {
+    
+    std::size_t shift[256];
+    for(auto& x : shift) x = m;
+    for(std::size_t i = 0; i + 1 < m; ++i) shift[static_cast<unsigned char>(s[i])] = m - 1 - i;
+    T last = s[m - 1];
+    for(auto r = p; std::size_t(q - r) >= m; ) {
+        
+        T c = r[m - 1];
+        if(c == last && equalUnit(r, s, m - 1)) return r;
+        r += shift[static_cast<unsigned char>(c)];
+        
+    }
+    return nullptr;
+    
+}
+
+// JSON strings must escape '"', '\\' and every unit below 0x20
+template <typename T>
+inline bool isJsonEscape(T c) noexcept {
+    
+    auto u = static_cast<std::make_unsigned_t<T>>(c);
+    return u < 0x20 || u == '"' || u == '\\';
+    
+}
+template <typename T>
+inline const T* findJsonEscapeScalar(const T* p, const T* q) noexcept {
+    
+    for(; p != q; ++p) if(isJsonEscape(*p)) return p;
+    return nullptr;
+    
+}
+
+#if defined(CORECAT_ARCHITECTURE_X86) || defined(CORECAT_ARCHITECTURE_X86_64)
+template <std::size_t N>
+using SearchUnit = std::integral_constant<std::size_t, N>;
+
+CORECAT_TARGET("sse2") inline __m128i broadcastSSE2(std::uint32_t c, SearchUnit<1>) noexcept { return _mm_set1_epi8(char(c)); }
+CORECAT_TARGET("sse2") inline __m128i broadcastSSE2(std::uint32_t c, SearchUnit<2>) noexcept { return _mm_set1_epi16(short(c)); }
+CORECAT_TARGET("sse2") inline __m128i broadcastSSE2(std::uint32_t c, SearchUnit<4>) noexcept { return _mm_set1_epi32(int(c)); }
+CORECAT_TARGET("sse2") inline __m128i compareSSE2(__m128i a, __m128i b, SearchUnit<1>) noexcept { return _mm_cmpeq_epi8(a, b); }
+CORECAT_TARGET("sse2") inline __m128i compareSSE2(__m128i a, __m128i b, SearchUnit<2>) noexcept { return _mm_cmpeq_epi16(a, b); }
+CORECAT_TARGET("sse2") inline __m128i compareSSE2(__m128i a, __m128i b, SearchUnit<4>) noexcept { return _mm_cmpeq_epi32(a, b); }
+CORECAT_TARGET("avx2") inline __m256i broadcastAVX2(std::uint32_t c, SearchUnit<1>) noexcept { return _mm256_set1_epi8(char(c)); }
+CORECAT_TARGET("avx2") inline __m256i broadcastAVX2(std::uint32_t c, SearchUnit<2>) noexcept { return _mm256_set1_epi16(short(c)); }
+CORECAT_TARGET("avx2") inline __m256i broadcastAVX2(std::uint32_t c, SearchUnit<4>) noexcept { return _mm256_set1_epi32(int(c)); }
+CORECAT_TARGET("avx2") inline __m256i compareAVX2(__m256i a, __m256i b, SearchUnit<1>) noexcept { return _mm256_cmpeq_epi8(a, b); }
+CORECAT_TARGET("avx2") inline __m256i compareAVX2(__m256i a, __m256i b, SearchUnit<2>) noexcept { return _mm256_cmpeq_epi16(a, b); }
+CORECAT_TARGET("avx2") inline __m256i compareAVX2(__m256i a, __m256i b, SearchUnit<4>) noexcept { return _mm256_cmpeq_epi32(a, b); }
+
+// Movemask sets sizeof(T) bits per matching unit; these step over whole units
+template <typename T>
+inline std::uint32_t clearLowestUnit(std::uint32_t mask) noexcept { return mask & ~(((1u << sizeof(T)) - 1) << countTrailingZero(mask)); }
+
+template <typename T>
+CORECAT_TARGET("sse2") inline const T* findCharSSE2(const T* p, const T* q, T c) noexcept {
+    
+    using N = SearchUnit<sizeof(T)>;
+    constexpr std::ptrdiff_t W = 16 / sizeof(T);
+    
+    __m128i x = broadcastSSE2(std::uint32_t(c), N());
+    for(; q - p >= W; p += W) {
+        
+        std::uint32_t mask = _mm_movemask_epi8(compareSSE2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), x, N()));
+        if(mask) return p + countTrailingZero(mask) / sizeof(T);
+        
+    }
+    return findCharScalar(p, q, c);
+    
+}
+template <typename T>
+CORECAT_TARGET("avx2") inline const T* findCharAVX2(const T* p, const T* q, T c) noexcept {
+    
+    using N = SearchUnit<sizeof(T)>;
+    constexpr std::ptrdiff_t W = 32 / sizeof(T);
+    
+    __m256i x = broadcastAVX2(std::uint32_t(c), N());
+    // Two vectors per iteration with a single branch, as memchr does
+    for(; q - p >= 2 * W; p += 2 * W) {
+        
+        __m256i a = compareAVX2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)), x, N());
+        __m256i b = compareAVX2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + W)), x, N());
+        if(_mm256_testz_si256(_mm256_or_si256(a, b), _mm256_or_si256(a, b))) continue;
+        std::uint32_t mask = _mm256_movemask_epi8(a);
+        if(mask) return p + countTrailingZero(mask) / sizeof(T);
+        return p + W + countTrailingZero(std::uint32_t(_mm256_movemask_epi8(b))) / sizeof(T);
+        
+    }
+    for(; q - p >= W; p += W) {
+        
+        std::uint32_t mask = _mm256_movemask_epi8(compareAVX2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)), x, N()));
+        if(mask) return p + countTrailingZero(mask) / sizeof(T);
+        
+    }
+    return findCharScalar(p, q, c);
+    
+}
+template <typename T>
+CORECAT_TARGET("sse2") inline const T* findLastCharSSE2(const T* p, const T* q, T c) noexcept {
+    
+    using N = SearchUnit<sizeof(T)>;
+    constexpr std::ptrdiff_t W = 16 / sizeof(T);
+    
+    __m128i x = broadcastSSE2(std::uint32_t(c), N());
+    for(; q - p >= W; q -= W) {
+        
+        std::uint32_t mask = _mm_movemask_epi8(compareSSE2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(q - W)), x, N()));
+        if(mask) return q - W + (31 - countLeadingZero(mask)) / sizeof(T);
+        
+    }
+    return findLastCharScalar(p, q, c);
+    
+}
+template <typename T>
+CORECAT_TARGET("avx2") inline const T* findLastCharAVX2(const T* p, const T* q, T c) noexcept {
+    
+    using N = SearchUnit<sizeof(T)>;
+    constexpr std::ptrdiff_t W = 32 / sizeof(T);
+    
+    __m256i x = broadcastAVX2(std::uint32_t(c), N());
+    for(; q - p >= W; q -= W) {
+        
+        std::uint32_t mask = _mm256_movemask_epi8(compareAVX2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(q - W)), x, N()));
+        if(mask) return q - W + (31 - countLeadingZero(mask)) / sizeof(T);
+        
+    }
+    return findLastCharScalar(p, q, c);
+    
+}
+
+// Candidates are the positions where both the first and the last unit of the needle match, which rejects almost
+// every position a vector at a time before anything is compared (W. Mula, "SIMD-friendly algorithms for substring
+// searching")
+template <typename T>
+CORECAT_TARGET("sse2") inline const T* findSubstringSSE2(const T* p, const T* q, const T* s, std::size_t m) noexcept {
+    
+    using N = SearchUnit<sizeof(T)>;
+    constexpr std::ptrdiff_t W = 16 / sizeof(T);
+    
+    __m128i first = broadcastSSE2(std::uint32_t(s[0]), N()), last = broadcastSSE2(std::uint32_t(s[m - 1]), N());
+    for(; q - p >= std::ptrdiff_t(m - 1) + W; p += W) {
+        
+        __m128i a = compareSSE2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), first, N());
+        __m128i b = compareSSE2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + m - 1)), last, N());
+        for(std::uint32_t mask = _mm_movemask_epi8(_mm_and_si128(a, b)); mask; mask = clearLowestUnit<T>(mask)) {
+            
+            auto r = p + countTrailingZero(mask) / sizeof(T);
+            if(equalUnit(r + 1, s + 1, m - 2)) return r;
+            
+        }
+        
+    }
+    return findHorspool(p, q, s, m);
+    
+}
+template <typename T>
+CORECAT_TARGET("avx2") inline const T* findSubstringAVX2(const T* p, const T* q, const T* s, std::size_t m) noexcept {
+    
+    using N = SearchUnit<sizeof(T)>;
+    constexpr std::ptrdiff_t W = 32 / sizeof(T);
+    
+    __m256i first = broadcastAVX2(std::uint32_t(s[0]), N()), last = broadcastAVX2(std::uint32_t(s[m - 1]), N());
+    for(; q - p >= std::ptrdiff_t(m - 1) + W; p += W) {
+        
+        __m256i a = compareAVX2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)), first, N());
+        __m256i b = compareAVX2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + m - 1)), last, N());
+        for(std::uint32_t mask = _mm256_movemask_epi8(_mm256_and_si256(a, b)); mask; mask = clearLowestUnit<T>(mask)) {
+            
+            auto r = p + countTrailingZero(mask) / sizeof(T);
+            if(equalUnit(r + 1, s + 1, m - 2)) return r;
+            
+        }
+        
+    }
+    return findHorspool(p, q, s, m);
+    
+}
+
+// Byte-set membership with two nibble lookups (W. Mula, "SIMD byte lookup"): the low nibble selects the set of high
+// nibbles present in the set, split over two tables for high nibbles 0-7 and 8-F
+struct ByteSetTable {
+    
+    alignas(16) unsigned char low[2][16] = {};
+    alignas(16) unsigned char high[2][16] = {};
+    
+    ByteSetTable(const unsigned char* s, std::size_t k) noexcept {
+        
+        for(std::size_t i = 0; i < k; ++i) low[s[i] >> 7][s[i] & 0x0F] |= static_cast<unsigned char>(1 << ((s[i] >> 4) & 7));
+        for(std::size_t i = 0; i < 16; ++i) high[i >> 3][i] = static_cast<unsigned char>(1 << (i & 7));
+        
+    }
+    
+};
+
+// These return the first match or the start of the tail left for the scalar loop
+CORECAT_TARGET("ssse3") inline const unsigned char* findAnyOfSSSE3(const unsigned char* p, const unsigned char* q, const ByteSetTable& t) noexcept {
+    
+    const __m128i low0 = _mm_load_si128(reinterpret_cast<const __m128i*>(t.low[0])), low1 = _mm_load_si128(reinterpret_cast<const __m128i*>(t.low[1]));
+    const __m128i high0 = _mm_load_si128(reinterpret_cast<const __m128i*>(t.high[0])), high1 = _mm_load_si128(reinterpret_cast<const __m128i*>(t.high[1]));
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    for(; q - p >= 16; p += 16) {
+        
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i l = _mm_and_si128(x, nibble), h = _mm_and_si128(_mm_srli_epi16(x, 4), nibble);
+        __m128i r = _mm_or_si128(_mm_and_si128(_mm_shuffle_epi8(low0, l), _mm_shuffle_epi8(high0, h)),
+            _mm_and_si128(_mm_shuffle_epi8(low1, l), _mm_shuffle_epi8(high1, h)));
+        std::uint32_t mask = ~_mm_movemask_epi8(_mm_cmpeq_epi8(r, _mm_setzero_si128())) & 0xFFFF;
+        if(mask) return p + countTrailingZero(mask);
+        
+    }
+    return p;
+    
+}
+CORECAT_TARGET("avx2") inline const unsigned char* findAnyOfAVX2(const unsigned char* p, const unsigned char* q, const ByteSetTable& t) noexcept {
+    
+    const __m256i low0 = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(t.low[0])));
+    const __m256i low1 = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(t.low[1])));
+    const __m256i high0 = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(t.high[0])));
+    const __m256i high1 = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(t.high[1])));
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    for(; q - p >= 32; p += 32) {
+        
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i l = _mm256_and_si256(x, nibble), h = _mm256_and_si256(_mm256_srli_epi16(x, 4), nibble);
+        __m256i r = _mm256_or_si256(_mm256_and_si256(_mm256_shuffle_epi8(low0, l), _mm256_shuffle_epi8(high0, h)),
+            _mm256_and_si256(_mm256_shuffle_epi8(low1, l), _mm256_shuffle_epi8(high1, h)));
+        std::uint32_t mask = ~std::uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(r, _mm256_setzero_si256())));
+        if(mask) return p + countTrailingZero(mask);
+        
+    }
+    return p;
+    
+}
+
+// A unit is below 0x20 exactly when it has no bits outside 0x1F, which holds for every unit width
+template <typename T>
+CORECAT_TARGET("sse2") inline const T* findJsonEscapeSSE2(const T* p, const T* q) noexcept {
+    
+    using N = SearchUnit<sizeof(T)>;
+    constexpr std::ptrdiff_t W = 16 / sizeof(T);
+    
+    const __m128i quote = broadcastSSE2('"', N()), backslash = broadcastSSE2('\\', N()), control = broadcastSSE2(0x1F, N());
+    const __m128i zero = _mm_setzero_si128();
+    for(; q - p >= W; p += W) {
+        
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i r = _mm_or_si128(_mm_or_si128(compareSSE2(x, quote, N()), compareSSE2(x, backslash, N())),
+            compareSSE2(_mm_andnot_si128(control, x), zero, N()));
+        std::uint32_t mask = _mm_movemask_epi8(r);
+        if(mask) return p + countTrailingZero(mask) / sizeof(T);
+        
+    }
+    return findJsonEscapeScalar(p, q);
+    
+}
+template <typename T>
+CORECAT_TARGET("avx2") inline const T* findJsonEscapeAVX2(const T* p, const T* q) noexcept {
+    
+    using N = SearchUnit<sizeof(T)>;
+    constexpr std::ptrdiff_t W = 32 / sizeof(T);
+    
+    const __m256i quote = broadcastAVX2('"', N()), backslash = broadcastAVX2('\\', N()), control = broadcastAVX2(0x1F, N());
+    const __m256i zero = _mm256_setzero_si256();
+    for(; q - p >= W; p += W) {
+        
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i r = _mm256_or_si256(_mm256_or_si256(compareAVX2(x, quote, N()), compareAVX2(x, backslash, N())),
+            compareAVX2(_mm256_andnot_si256(control, x), zero, N()));
+        std::uint32_t mask = _mm256_movemask_epi8(r);
+        if(mask) return p + countTrailingZero(mask) / sizeof(T);
+        
+    }
+    return findJsonEscapeSSE2(p, q);
+    
+}
+#endif
+
+template <typename T>
+inline const T* findChar(const T* p, const T* q, T c) noexcept {
+    
+#if defined(CORECAT_ARCHITECTURE_X86) || defined(CORECAT_ARCHITECTURE_X86_64)
+    if(X86FeatureBase::AVX2) return findCharAVX2(p, q, c);
+    if(X86FeatureBase::SSE2) return findCharSSE2(p, q, c);
+#endif
+    return findCharScalar(p, q, c);
+    
+}
+template <typename T>
+inline const T* findLastChar(const T* p, const T* q, T c) noexcept {
+    
+#if defined(CORECAT_ARCHITECTURE_X86) || defined(CORECAT_ARCHITECTURE_X86_64)
+    if(X86FeatureBase::AVX2) return findLastCharAVX2(p, q, c);
+    if(X86FeatureBase::SSE2) return findLastCharSSE2(p, q, c);
+#endif
+    return findLastCharScalar(p, q, c);
+    
+}
+template <typename T>
+inline const T* findSubstring(const T* p, const T* q, const T* s, std::size_t m) noexcept {
+    
+    if(!m) return p;
+    if(std::size_t(q - p) < m) return nullptr;
+    if(m == 1) return findChar(p, q, s[0]);
+#if defined(CORECAT_ARCHITECTURE_X86) || defined(CORECAT_ARCHITECTURE_X86_64)
+    if(m < 64) {
+        
+        if(X86FeatureBase::AVX2) return findSubstringAVX2(p, q, s, m);
+        if(X86FeatureBase::SSE2) return findSubstringSSE2(p, q, s, m);
+        
+    }
+#endif
+    return findHorspool(p, q, s, m);
+    
+}
+// Scans back for the first unit of the needle and verifies the rest at each hit
+template <typename T>
+inline const T* findLastSubstring(const T* p, const T* q, const T* s, std::size_t m) noexcept {
+    
+    if(std::size_t(q - p) < m) return nullptr;
+    if(!m) return q;
+    for(auto e = q - m + 1; e != p; ) {
+        
+        auto r = findLastChar(p, e, s[0]);
+        if(!r) return nullptr;
+        if(equalUnit(r + 1, s + 1, m - 1)) return r;
+        e = r;
+        
+    }
+    return nullptr;
+    
+}
+template <typename T>
+inline const T* findAnyOf(const T* p, const T* q, const T* s, std::size_t k) noexcept {
+    
+    if(!k) return nullptr;
+    if(k == 1) return findChar(p, q, s[0]);
+    if(sizeof(T) == 1) {
+        
+        auto b = reinterpret_cast<const unsigned char*>(p), e = reinterpret_cast<const unsigned char*>(q);
+#if defined(CORECAT_ARCHITECTURE_X86) || defined(CORECAT_ARCHITECTURE_X86_64)
+        if(X86FeatureBase::SSSE3) {
+            
+            ByteSetTable t(reinterpret_cast<const unsigned char*>(s), k);
+            b = X86FeatureBase::AVX2 ? findAnyOfAVX2(b, e, t) : findAnyOfSSSE3(b, e, t);
+            
+        }
+#endif
+        p = reinterpret_cast<const T*>(b);
+        
+    }
+    // Units below 256 go through a bitmap; anything wider is compared against the set directly
+    std::uint32_t bitmap[8] = {};
+    bool wide = false;
+    for(std::size_t i = 0; i < k; ++i) {
+        
+        auto c = static_cast<std::make_unsigned_t<T>>(s[i]);
+        if(c < 256) bitmap[c >> 5] |= std::uint32_t(1) << (c & 31);
+        else wide = true;
+        
+    }
+    for(; p != q; ++p) {
+        
+        auto c = static_cast<std::make_unsigned_t<T>>(*p);
+        if(c < 256 ? (bitmap[c >> 5] >> (c & 31)) & 1 : wide && findCharScalar(s, s + k, *p)) return p;
+        
+    }
+    return nullptr;
+    
+}
+
+template <typename T>
+inline const T* findJsonEscape(const T* p, const T* q) noexcept {
+    
+#if defined(CORECAT_ARCHITECTURE_X86) || defined(CORECAT_ARCHITECTURE_X86_64)
+    if(X86FeatureBase::AVX2) return findJsonEscapeAVX2(p, q);
+    if(X86FeatureBase::SSE2) return findJsonEscapeSSE2(p, q);
+#endif
+    return findJsonEscapeScalar(p, q);
+    
+}
+
+}
+
+}
+}
+}
+
+
+#endif
@@ -0,0 +1,280 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2016-2018 The Cats Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef CATS_CORECAT_TEXT_STRINGSPLIT_HPP
+#define CATS_CORECAT_TEXT_STRINGSPLIT_HPP
+
+
+#include <cstddef>
+
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+#include "String.hpp"
+#include "StringSearch.hpp"
+#include "../Util/Range/RangeOperator.hpp"
+
+
+namespace Cats {
+namespace Corecat {
+inline namespace Text {
+
+// A lazy range of StringViews into sv; it does not own the characters, so sv must outlive it. S::next produces the
+// token starting the search at pos and moves pos past it, or returns false when the input is exhausted.
+template <typename C, typename S>
+class SplitRange {
+    
+public:
+    
+    using CharsetType = C;
+    using CharType = typename C::CharType;
+    using StringViewType = StringView<C>;
+    
+    class Iterator {
+        
+    private:
+        
+        friend SplitRange;
+        
+    public:
+        
+        using value_type = StringViewType;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const StringViewType*;
+        using reference = const StringViewType&;
+        using iterator_category = std::forward_iterator_tag;
+        
+    private:
+        
+        const SplitRange* r;
+        std::size_t pos;
+        StringViewType token;
+        bool valid;
+        
+    private:
+        
+        Iterator(const SplitRange* r_, bool begin) : r(r_), pos(0), valid(begin && r->next(pos, token)) {}
+        
+    public:
+        
+        reference operator *() const noexcept { return token; }
+        pointer operator ->() const noexcept { return &token; }
+        Iterator& operator ++() { valid = r->next(pos, token); return *this; }
+        Iterator operator ++(int) { auto t = *this; ++*this; return t; }
+        friend bool operator ==(const Iterator& a, const Iterator& b) noexcept { return a.valid == b.valid && (!a.valid || a.pos == b.pos); }
+        friend bool operator !=(const Iterator& a, const Iterator& b) noexcept { return !(a == b); }
+        
+    };
+    
+private:
+    
+    StringViewType sv;
+    S s;
+    
+private:
+    
+    bool next(std::size_t& pos, StringViewType& token) const { return s.next(sv.getData(), sv.getLength(), pos, token); }
+    
+public:
+    
+    SplitRange(const StringViewType& sv_, S s_) : sv(sv_), s(std::move(s_)) {}
+    
+    Iterator begin() const { return {this, true}; }
+    Iterator end() const { return {this, false}; }
+    
+};
+
+
+namespace Impl {
+
+// Splitting on a delimiter keeps empty tokens, so n delimiters always give n + 1 tokens; DONE marks that the token
+// after the last delimiter has been produced
+template <typename C, typename F>
+inline bool nextSplitToken(const typename C::CharType* b, std::size_t n, std::size_t& pos, StringView<C>& token, std::size_t m, F&& find) {
+    
+    constexpr std::size_t DONE = std::numeric_limits<std::size_t>::max();
+    if(pos == DONE) return false;
+    auto q = find(b + pos, b + n);
+    std::size_t end = q ? q - b : n;
+    token = {b + pos, end - pos};
+    pos = end == n ? DONE : end + m;
+    return true;
+    
+}
+
+template <typename C>
+struct CharSplitter {
+    
+    using CharType = typename C::CharType;
+    
+    CharType c;
+    
+    bool next(const CharType* b, std::size_t n, std::size_t& pos, StringView<C>& token) const {
+        
+        return nextSplitToken(b, n, pos, token, 1, [&](const CharType* p, const CharType* q) { return findChar(p, q, c); });
+        
+    }
+    
+};
+// An empty delimiter matches nowhere, so the whole input is a single token
+template <typename C>
+struct StringSplitter {
+    
+    using CharType = typename C::CharType;
+    
+    StringView<C> s;
+    
+    bool next(const CharType* b, std::size_t n, std::size_t& pos, StringView<C>& token) const {
+        
+        return nextSplitToken(b, n, pos, token, s.getLength(), [&](const CharType* p, const CharType* q) {
+            
+            return s.getLength() ? findSubstring(p, q, s.getData(), s.getLength()) : nullptr;
+            
+        });
+        
+    }
+    
+};
+template <typename C>
+struct AnySplitter {
+    
+    using CharType = typename C::CharType;
+    
+    StringView<C> s;
+    
+    bool next(const CharType* b, std::size_t n, std::size_t& pos, StringView<C>& token) const {
+        
+        return nextSplitToken(b, n, pos, token, 1, [&](const CharType* p, const CharType* q) { return findAnyOf(p, q, s.getData(), s.getLength()); });
+        
+    }
+    
+};
+// Lines end at '\n' with an optional '\r' before it; a final terminator does not start another line
+template <typename C>
+struct LineSplitter {
+    
+    using CharType = typename C::CharType;
+    
+    bool next(const CharType* b, std::size_t n, std::size_t& pos, StringView<C>& token) const {
+        
+        if(pos == n) return false;
+        auto q = findChar(b + pos, b + n, CharType('\n'));
+        std::size_t end = q ? q - b : n, e = end;
+        if(e != pos && b[e - 1] == CharType('\r')) --e;
+        token = {b + pos, e - pos};
+        pos = end == n ? n : end + 1;
+        return true;
+        
+    }
+    
+};
+// Tokens are the maximal runs of units for which f is false, so runs of separators never give empty tokens
+template <typename C, typename F>
+struct TokenSplitter {
+    
+    using CharType = typename C::CharType;
+    
+    F f;
+    
+    bool next(const CharType* b, std::size_t n, std::size_t& pos, StringView<C>& token) const {
+        
+        while(pos != n && f(b[pos])) ++pos;
+        if(pos == n) return false;
+        std::size_t end = pos + 1;
+        while(end != n && !f(b[end])) ++end;
+        token = {b + pos, end - pos};
+        pos = end;
+        return true;
+        
+    }
+    
+};
+
+// The String overloads take the characters of an lvalue; a temporary String would be gone before the range is used
+struct SplitFunc {
+    
+    template <typename T>
+    RangeOperator<SplitFunc, std::decay_t<T>> operator ()(T&& t) const { return {*this, std::forward<T>(t)}; }
+    template <typename C>
+    SplitRange<C, CharSplitter<C>> operator ()(const StringView<C>& sv, typename C::CharType c) const { return {sv, {c}}; }
+    template <typename C>
+    SplitRange<C, StringSplitter<C>> operator ()(const StringView<C>& sv, const typename String<C>::StringViewType& s) const { return {sv, {s}}; }
+    template <typename C, typename T>
+    auto operator ()(const String<C>& str, T&& t) const { return (*this)(str.getView(), std::forward<T>(t)); }
+    template <typename C, typename T>
+    void operator ()(String<C>&& str, T&& t) const = delete;
+    
+};
+struct SplitAnyFunc {
+    
+    template <typename T>
+    RangeOperator<SplitAnyFunc, std::decay_t<T>> operator ()(T&& t) const { return {*this, std::forward<T>(t)}; }
+    template <typename C>
+    SplitRange<C, AnySplitter<C>> operator ()(const StringView<C>& sv, const typename String<C>::StringViewType& s) const { return {sv, {s}}; }
+    template <typename C, typename T>
+    auto operator ()(const String<C>& str, T&& t) const { return (*this)(str.getView(), std::forward<T>(t)); }
+    template <typename C, typename T>
+    void operator ()(String<C>&& str, T&& t) const = delete;
+    
+};
+struct LinesFunc {
+    
+    RangeOperator<LinesFunc> operator ()() const { return {*this}; }
+    template <typename C>
+    SplitRange<C, LineSplitter<C>> operator ()(const StringView<C>& sv) const { return {sv, {}}; }
+    template <typename C>
+    SplitRange<C, LineSplitter<C>> operator ()(const String<C>& str) const { return {str.getView(), {}}; }
+    template <typename C>
+    void operator ()(String<C>&& str) const = delete;
+    
+};
+struct TokenizeFunc {
+    
+    template <typename F>
+    RangeOperator<TokenizeFunc, std::decay_t<F>> operator ()(F&& f) const { return {*this, std::forward<F>(f)}; }
+    template <typename C, typename F>
+    SplitRange<C, TokenSplitter<C, std::decay_t<F>>> operator ()(const StringView<C>& sv, F&& f) const { return {sv, {std::forward<F>(f)}}; }
+    template <typename C, typename F>
+    SplitRange<C, TokenSplitter<C, std::decay_t<F>>> operator ()(const String<C>& str, F&& f) const { return {str.getView(), {std::forward<F>(f)}}; }
+    template <typename C, typename F>
+    void operator ()(String<C>&& str, F&& f) const = delete;
+    
+};
+
+}
+namespace { constexpr Impl::SplitFunc split; }
+namespace { constexpr Impl::SplitAnyFunc splitAny; }
+namespace { constexpr Impl::LinesFunc lines; }
+namespace { constexpr Impl::TokenizeFunc tokenize; }
+
+}
+}
+}
+
+
+#endif
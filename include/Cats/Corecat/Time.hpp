@@ -29,6 +29,8 @@
 
 
 #include "Time/HighResolutionClock.hpp"
+#include "Time/Timestamp.hpp"
+#include "Time/WallClock.hpp"
 
 
 #endif
@@ -0,0 +1,281 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2016-2018 The Cats Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef CATS_CORECAT_TIME_TIMESTAMP_HPP
+#define CATS_CORECAT_TIME_TIMESTAMP_HPP
+
+
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <limits>
+
+#include "WallClock.hpp"
+#include "../Text/Formatter.hpp"
+#include "../Text/NumberParser.hpp"
+#include "../Text/String.hpp"
+#include "../Util/Exception.hpp"
+
+
+namespace Cats {
+namespace Corecat {
+inline namespace Time {
+
+namespace Impl {
+
+constexpr std::int64_t floorDivide(std::int64_t a, std::int64_t b) noexcept { return a / b - (a % b < 0); }
+
+// Days since 1970-01-01 of a proleptic Gregorian date and back, counting in 400-year eras that start on March 1 so
+// that the leap day ends a year (H. Hinnant, "chrono-Compatible Low-Level Date Algorithms")
+constexpr std::int64_t daysFromCivil(std::int64_t y, int m, int d) noexcept {
+    
+    y -= m <= 2;
+    std::int64_t era = (y >= 0 ? y : y - 399) / 400;
+    std::int64_t yoe = y - era * 400;
+    std::int64_t doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    return era * 146097 + yoe * 365 + yoe / 4 - yoe / 100 + doy - 719468;
+    
+}
+inline void civilFromDays(std::int64_t z, std::int64_t& y, int& m, int& d) noexcept {
+    
+    z += 719468;
+    std::int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    std::int64_t doe = z - era * 146097;
+    std::int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    std::int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    std::int64_t mp = (5 * doy + 2) / 153;
+    d = int(doy - (153 * mp + 2) / 5 + 1);
+    m = int(mp < 10 ? mp + 3 : mp - 9);
+    y = yoe + era * 400 + (m <= 2);
+    
+}
+
+constexpr bool isLeapYear(std::int64_t y) noexcept { return y % 4 == 0 && (y % 100 != 0 || y % 400 == 0); }
+constexpr int getDaysInMonth(std::int64_t y, int m) noexcept { return m == 2 ? 28 + isLeapYear(y) : 30 + ((m + (m > 7)) & 1); }
+
+template <typename T>
+inline bool parseTwoDigits(const T* p, int& v) noexcept {
+    
+    if(!Text::Impl::isDecimalDigit(p[0]) || !Text::Impl::isDecimalDigit(p[1])) return false;
+    v = int(p[0] - T('0')) * 10 + int(p[1] - T('0'));
+    return true;
+    
+}
+
+}
+
+
+// Writes time points as RFC 3339 timestamps, "2024-01-02T03:04:05.123456789Z", with a fixed number of fraction digits
+// and UTC offset. The text up to the seconds is kept for the last second written, and the date for the last day, so
+// formatting the times of a log costs little more than the fraction digits and a copy.
+class TimestampFormatter {
+    
+public:
+    
+    static constexpr std::size_t MAX_LENGTH = 35;
+    
+private:
+    
+    int precision;
+    int offset;
+    char suffix[6];
+    std::size_t suffixLength;
+    std::int64_t cachedSecond = std::numeric_limits<std::int64_t>::min();
+    std::int64_t cachedDay = std::numeric_limits<std::int64_t>::min();
+    char text[19] = {};
+    
+private:
+    
+    void update(std::int64_t second) noexcept {
+        
+        std::int64_t day = Impl::floorDivide(second, 86400);
+        int time = int(second - day * 86400);
+        if(day != cachedDay) {
+            
+            std::int64_t y;
+            int m, d;
+            Impl::civilFromDays(day, y, m, d);
+            char* p = text;
+            Text::Impl::toStringMiddle2(std::uint8_t(y / 100), p), Text::Impl::toStringMiddle2(std::uint8_t(y % 100), p);
+            *p++ = '-', Text::Impl::toStringMiddle2(std::uint8_t(m), p);
+            *p++ = '-', Text::Impl::toStringMiddle2(std::uint8_t(d), p);
+            *p++ = 'T';
+            cachedDay = day;
+            
+        }
+        char* p = text + 11;
+        Text::Impl::toStringMiddle2(std::uint8_t(time / 3600), p);
+        *p++ = ':', Text::Impl::toStringMiddle2(std::uint8_t(time / 60 % 60), p);
+        *p++ = ':', Text::Impl::toStringMiddle2(std::uint8_t(time % 60), p);
+        cachedSecond = second;
+        
+    }
+    
+public:
+    
+    // precision is the number of fraction digits, up to 9; offset is the local time offset in minutes east of UTC
+    TimestampFormatter(int precision_ = 9, int offset_ = 0) : precision(precision_), offset(offset_) {
+        
+        if(precision < 0 || precision > 9) throw InvalidArgumentException("Invalid precision");
+        if(offset <= -1440 || offset >= 1440) throw InvalidArgumentException("Invalid offset");
+        if(!offset) suffix[0] = 'Z', suffixLength = 1;
+        else {
+            
+            char* p = suffix;
+            int x = offset < 0 ? -offset : offset;
+            *p++ = offset < 0 ? '-' : '+';
+            Text::Impl::toStringMiddle2(std::uint8_t(x / 60), p);
+            *p++ = ':', Text::Impl::toStringMiddle2(std::uint8_t(x % 60), p);
+            suffixLength = 6;
+            
+        }
+        
+    }
+    
+    int getPrecision() const noexcept { return precision; }
+    int getOffset() const noexcept { return offset; }
+    
+    // Writes t to p, which has room for MAX_LENGTH units, with precision fraction digits; returns the end
+    template <typename T>
+    T* format(WallClock::time_point t, T* p, int precision_) noexcept {
+        
+        std::int64_t x = t.time_since_epoch().count();
+        std::int64_t second = Impl::floorDivide(x, 1000000000);
+        auto fraction = std::uint32_t(x - second * 1000000000);
+        second += std::int64_t(offset) * 60;
+        if(second != cachedSecond) update(second);
+        p = std::copy(text, text + 19, p);
+        if(precision_) {
+            
+            T digits[9], *q = digits;
+            *q++ = T('0' + fraction / 100000000);
+            Text::Impl::toStringMiddle8(fraction % 100000000, q);
+            *p++ = T('.');
+            p = std::copy(digits, digits + precision_, p);
+            
+        }
+        return std::copy(suffix, suffix + suffixLength, p);
+        
+    }
+    template <typename T>
+    T* format(WallClock::time_point t, T* p) noexcept { return format(t, p, precision); }
+    template <typename W>
+    void format(W& writer, WallClock::time_point t) {
+        
+        typename W::CharsetType::CharType buffer[MAX_LENGTH];
+        writer.append(buffer, format(t, buffer) - buffer);
+        
+    }
+    
+    String8 operator ()(WallClock::time_point t) {
+        
+        char buffer[MAX_LENGTH];
+        return {buffer, std::size_t(format(t, buffer) - buffer)};
+        
+    }
+    
+};
+
+// Parses an RFC 3339 timestamp, "YYYY-MM-DDTHH:MM:SS[.fraction](Z|+HH:MM|-HH:MM)"; the separator may also be 't' or a
+// space and the zone 'z'. Digits past the nanoseconds are dropped, and a leap second, :60, reads as the first instant
+// of the next minute. Times the clock cannot represent give ParseError::OUT_OF_RANGE.
+template <typename C>
+inline ParseResult<WallClock::time_point> parseTimestamp(const StringView<C>& sv) noexcept {
+    
+    using T = typename C::CharType;
+    
+    const ParseResult<WallClock::time_point> invalid = {{}, ParseError::INVALID_ARGUMENT};
+    auto p = sv.getData(), q = p + sv.getLength();
+    int y0, y1, mo, d, h, mi, s, fraction = 0;
+    if(q - p < 20) return invalid;
+    if(!Impl::parseTwoDigits(p, y0) || !Impl::parseTwoDigits(p + 2, y1) || p[4] != T('-') || !Impl::parseTwoDigits(p + 5, mo) || p[7] != T('-')
+        || !Impl::parseTwoDigits(p + 8, d) || (p[10] != T('T') && p[10] != T('t') && p[10] != T(' '))
+        || !Impl::parseTwoDigits(p + 11, h) || p[13] != T(':') || !Impl::parseTwoDigits(p + 14, mi) || p[16] != T(':') || !Impl::parseTwoDigits(p + 17, s))
+        return invalid;
+    std::int64_t y = y0 * 100 + y1;
+    if(mo < 1 || mo > 12 || d < 1 || d > Impl::getDaysInMonth(y, mo) || h > 23 || mi > 59 || s > 60) return invalid;
+    p += 19;
+    if(*p == T('.')) {
+        
+        auto b = ++p;
+        for(; p != q && Text::Impl::isDecimalDigit(*p); ++p) if(p - b < 9) fraction = fraction * 10 + int(*p - T('0'));
+        if(p == b) return invalid;
+        for(auto n = p - b; n < 9; ++n) fraction *= 10;
+        
+    }
+    int offset;
+    if(q - p == 1 && (*p == T('Z') || *p == T('z'))) offset = 0;
+    else if(q - p == 6 && (*p == T('+') || *p == T('-'))) {
+        
+        int oh, om;
+        if(!Impl::parseTwoDigits(p + 1, oh) || p[3] != T(':') || !Impl::parseTwoDigits(p + 4, om) || oh > 23 || om > 59) return invalid;
+        offset = (oh * 60 + om) * (*p == T('-') ? -1 : 1);
+        
+    } else return invalid;
+    
+    std::int64_t second = Impl::daysFromCivil(y, mo, d) * 86400 + h * 3600 + mi * 60 + s - std::int64_t(offset) * 60;
+    // Computed modulo 2^64; the value is representable exactly when it divides back to the same second
+    auto x = std::int64_t(std::uint64_t(second) * 1000000000 + std::uint32_t(fraction));
+    if(Impl::floorDivide(x, 1000000000) != second) return {{}, ParseError::OUT_OF_RANGE};
+    return {WallClock::time_point(WallClock::duration(x)), ParseError::NONE};
+    
+}
+template <typename C>
+inline ParseResult<WallClock::time_point> parseTimestamp(const String<C>& str) noexcept { return parseTimestamp(str.getView()); }
+
+}
+
+
+// "{}" writes an RFC 3339 timestamp in UTC with nine fraction digits, "{:.3}" with three; width and alignment apply
+template <>
+struct FormatTraits<WallClock::time_point> {
+    
+    template <typename C>
+    static constexpr bool check(const FormatSpec<C>& spec) noexcept {
+        
+        return spec.alignType != C('=') && !spec.signType && !spec.alter && !spec.zero && spec.precision <= 9 && !spec.type;
+        
+    }
+    template <typename W>
+    static void format(W& writer, const WallClock::time_point& t, const FormatSpec<typename W::CharsetType::CharType>& spec) {
+        
+        using CharType = typename W::CharsetType::CharType;
+        
+        static thread_local TimestampFormatter formatter;
+        CharType buffer[TimestampFormatter::MAX_LENGTH];
+        auto e = formatter.format(t, buffer, spec.precision < 0 ? 9 : spec.precision);
+        Text::Impl::writeFormatPadded(writer, Text::Impl::completeStringFormatSpec(spec), buffer, 0, e - buffer, [&](W& w) { w.append(buffer, e - buffer); });
+        
+    }
+    
+};
+
+}
+}
+
+
+#endif
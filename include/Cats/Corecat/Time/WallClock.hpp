@@ -0,0 +1,86 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2016-2018 The Cats Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef CATS_CORECAT_TIME_WALLCLOCK_HPP
+#define CATS_CORECAT_TIME_WALLCLOCK_HPP
+
+
+#include <cstdint>
+
+#include <chrono>
+
+#include "../System/OS.hpp"
+
+#if defined(CORECAT_OS_WINDOWS)
+#   include "../Win32/Windows.hpp"
+#elif defined(CORECAT_OS_LINUX) || defined(CORECAT_OS_MACOS)
+#include <time.h>
+#else
+#   error Unknown OS
+#endif
+
+
+namespace Cats {
+namespace Corecat {
+inline namespace Time {
+
+// The real-time clock, in nanoseconds since 1970-01-01T00:00:00Z with leap seconds left out, as POSIX counts. The
+// representation is fixed, unlike that of std::chrono::system_clock, and covers the years 1677 to 2262.
+struct WallClock {
+    
+    using rep = std::int64_t;
+    using period = std::nano;
+    using duration = std::chrono::duration<rep, period>;
+    using time_point = std::chrono::time_point<WallClock>;
+    
+    static constexpr bool is_steady = false;
+    
+    static time_point now() noexcept {
+#if defined(CORECAT_OS_WINDOWS)
+        // FILETIME counts 100 ns from 1601-01-01
+        FILETIME t;
+#   if _WIN32_WINNT >= 0x0602
+        ::GetSystemTimePreciseAsFileTime(&t);
+#   else
+        ::GetSystemTimeAsFileTime(&t);
+#   endif
+        std::int64_t x = std::int64_t((std::uint64_t(t.dwHighDateTime) << 32) | t.dwLowDateTime) - 116444736000000000;
+        return time_point(duration(x * 100));
+#elif defined(CORECAT_OS_LINUX) || defined(CORECAT_OS_MACOS)
+        timespec t;
+        ::clock_gettime(CLOCK_REALTIME, &t);
+        return time_point(duration(std::int64_t(t.tv_sec) * 1000000000 + t.tv_nsec));
+#endif
+    }
+    
+};
+
+}
+}
+}
+
+
+#endif
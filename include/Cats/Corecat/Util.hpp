@@ -30,6 +30,7 @@
 
 #include "Util/Any.hpp"
 #include "Util/Benchmark.hpp"
+#include "Util/Bit.hpp"
 #include "Util/Byte.hpp"
 #include "Util/CommandLine.hpp"
 #include "Util/Detector.hpp"
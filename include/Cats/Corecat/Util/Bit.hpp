@@ -0,0 +1,126 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2016-2018 The Cats Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef CATS_CORECAT_UTIL_BIT_HPP
+#define CATS_CORECAT_UTIL_BIT_HPP
+
+
+#include <cstdint>
+
+#include <type_traits>
+
+#include "../System/Compiler.hpp"
+
+#if defined(CORECAT_COMPILER_MSVC)
+#   include <intrin.h>
+#endif
+
+
+namespace Cats {
+namespace Corecat {
+inline namespace Util {
+
+// The result is undefined when t is zero
+
+template <typename T>
+inline std::enable_if_t<std::is_unsigned<T>::value && sizeof(T) <= 4, int> countLeadingZero(T t) noexcept {
+#if defined(CORECAT_COMPILER_CLANG) || defined(CORECAT_COMPILER_GCC)
+    return __builtin_clz(t) - int(32 - sizeof(T) * 8);
+#elif defined(CORECAT_COMPILER_MSVC)
+    unsigned long index;
+    _BitScanReverse(&index, t);
+    return int(sizeof(T) * 8 - 1 - index);
+#else
+    int n = 0;
+    for(T mask = T(1) << (sizeof(T) * 8 - 1); !(t & mask); mask >>= 1) ++n;
+    return n;
+#endif
+}
+template <typename T>
+inline std::enable_if_t<std::is_unsigned<T>::value && sizeof(T) == 8, int> countLeadingZero(T t) noexcept {
+#if defined(CORECAT_COMPILER_CLANG) || defined(CORECAT_COMPILER_GCC)
+    return __builtin_clzll(t);
+#elif defined(CORECAT_COMPILER_MSVC) && defined(_M_X64)
+    unsigned long index;
+    _BitScanReverse64(&index, t);
+    return int(63 - index);
+#else
+    std::uint32_t h = std::uint32_t(t >> 32);
+    return h ? countLeadingZero(h) : 32 + countLeadingZero(std::uint32_t(t));
+#endif
+}
+
+template <typename T>
+inline std::enable_if_t<std::is_unsigned<T>::value && sizeof(T) <= 4, int> countTrailingZero(T t) noexcept {
+#if defined(CORECAT_COMPILER_CLANG) || defined(CORECAT_COMPILER_GCC)
+    return __builtin_ctz(t);
+#elif defined(CORECAT_COMPILER_MSVC)
+    unsigned long index;
+    _BitScanForward(&index, t);
+    return int(index);
+#else
+    int n = 0;
+    for(; !(t & 1); t >>= 1) ++n;
+    return n;
+#endif
+}
+template <typename T>
+inline std::enable_if_t<std::is_unsigned<T>::value && sizeof(T) == 8, int> countTrailingZero(T t) noexcept {
+#if defined(CORECAT_COMPILER_CLANG) || defined(CORECAT_COMPILER_GCC)
+    return __builtin_ctzll(t);
+#elif defined(CORECAT_COMPILER_MSVC) && defined(_M_X64)
+    unsigned long index;
+    _BitScanForward64(&index, t);
+    return int(index);
+#else
+    std::uint32_t l = std::uint32_t(t);
+    return l ? countTrailingZero(l) : 32 + countTrailingZero(std::uint32_t(t >> 32));
+#endif
+}
+
+// Returns the low half of the 128-bit product and stores the high half in high
+inline std::uint64_t multiplyWide(std::uint64_t a, std::uint64_t b, std::uint64_t& high) noexcept {
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 x = static_cast<unsigned __int128>(a) * b;
+    high = std::uint64_t(x >> 64);
+    return std::uint64_t(x);
+#elif defined(CORECAT_COMPILER_MSVC) && defined(_M_X64)
+    return _umul128(a, b, &high);
+#else
+    std::uint64_t al = a & 0xFFFFFFFF, ah = a >> 32, bl = b & 0xFFFFFFFF, bh = b >> 32;
+    std::uint64_t ll = al * bl, lh = al * bh, hl = ah * bl, hh = ah * bh;
+    std::uint64_t m = (ll >> 32) + (lh & 0xFFFFFFFF) + (hl & 0xFFFFFFFF);
+    high = hh + (lh >> 32) + (hl >> 32) + (m >> 32);
+    return (m << 32) | (ll & 0xFFFFFFFF);
+#endif
+}
+
+}
+}
+}
+
+
+#endif
@@ -28,14 +28,22 @@
 #define CATS_CORECAT_UTIL_ENDIAN_HPP
 
 
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
 
 #include <type_traits>
 #include <utility>
 
 #include "Byte.hpp"
+#include "../System/Architecture.hpp"
 #include "../System/Compiler.hpp"
 
+#if defined(CORECAT_ARCHITECTURE_X86) || defined(CORECAT_ARCHITECTURE_X86_64)
+#   include <immintrin.h>
+#   include "../X86/X86FeatureBase.hpp"
+#endif
+
 
 namespace Cats {
 namespace Corecat {
@@ -107,6 +115,80 @@ std::enable_if_t<E1 == E2, T> convertEndian(T t) { return t; }
 template <Endian E1, Endian E2, typename T>
 std::enable_if_t<E1 != E2, T> convertEndian(T t) { return reverseEndian(t); }
 
+
+namespace Impl {
+
+template <std::size_t S>
+struct EndianUnit;
+template <>
+struct EndianUnit<1> { using Type = std::uint8_t; };
+template <>
+struct EndianUnit<2> { using Type = std::uint16_t; };
+template <>
+struct EndianUnit<4> { using Type = std::uint32_t; };
+template <>
+struct EndianUnit<8> { using Type = std::uint64_t; };
+
+#if defined(CORECAT_ARCHITECTURE_X86) || defined(CORECAT_ARCHITECTURE_X86_64)
+// Reverses 16 bytes per pshufb and returns the number of elements processed
+template <std::size_t S>
+CORECAT_TARGET("ssse3") inline std::size_t reverseEndianSSSE3(unsigned char* data, std::size_t count) noexcept {
+    
+    char table[16];
+    for(std::size_t i = 0; i < 16; ++i) table[i] = char(i / S * S + S - 1 - i % S);
+    __m128i mask = _mm_loadu_si128(reinterpret_cast<const __m128i*>(table));
+    std::size_t size = count * S / 64 * 64, i = 0;
+    for(; i < size; i += 64) {
+        
+        auto p = reinterpret_cast<__m128i*>(data + i);
+        __m128i a = _mm_loadu_si128(p), b = _mm_loadu_si128(p + 1), c = _mm_loadu_si128(p + 2), d = _mm_loadu_si128(p + 3);
+        _mm_storeu_si128(p, _mm_shuffle_epi8(a, mask));
+        _mm_storeu_si128(p + 1, _mm_shuffle_epi8(b, mask));
+        _mm_storeu_si128(p + 2, _mm_shuffle_epi8(c, mask));
+        _mm_storeu_si128(p + 3, _mm_shuffle_epi8(d, mask));
+        
+    }
+    for(size = count * S / 16 * 16; i < size; i += 16) {
+        
+        auto p = reinterpret_cast<__m128i*>(data + i);
+        _mm_storeu_si128(p, _mm_shuffle_epi8(_mm_loadu_si128(p), mask));
+        
+    }
+    return i / S;
+    
+}
+#endif
+
+}
+
+template <typename T>
+inline void reverseEndian(T* data, std::size_t count) noexcept {
+    
+    static_assert(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8, "Unsupported size for reverseEndian");
+    using U = typename Impl::EndianUnit<sizeof(T)>::Type;
+    
+    if(sizeof(T) == 1) return;
+    auto p = reinterpret_cast<unsigned char*>(data);
+    std::size_t i = 0;
+#if defined(CORECAT_ARCHITECTURE_X86) || defined(CORECAT_ARCHITECTURE_X86_64)
+    if(X86FeatureBase::SSSE3) i = Impl::reverseEndianSSSE3<sizeof(T)>(p, count);
+#endif
+    for(; i < count; ++i) {
+        
+        U u;
+        std::memcpy(&u, p + i * sizeof(T), sizeof(T));
+        u = reverseEndian(u);
+        std::memcpy(p + i * sizeof(T), &u, sizeof(T));
+        
+    }
+    
+}
+
+template <Endian E1, Endian E2, typename T>
+std::enable_if_t<E1 == E2> convertEndian(T* /*data*/, std::size_t /*count*/) noexcept {}
+template <Endian E1, Endian E2, typename T>
+std::enable_if_t<E1 != E2> convertEndian(T* data, std::size_t count) noexcept { reverseEndian(data, count); }
+
 template <typename T>
 T convertNativeToLittle(T t) { return convertEndian<Endian::NATIVE, Endian::LITTLE>(t); }
 template <typename T>
@@ -29,6 +29,7 @@
 
 
 #include "X86/X86Feature.hpp"
+#include "X86/X86FeatureBase.hpp"
 
 
 #endif
@@ -28,21 +28,9 @@
 #define CATS_CORECAT_X86FEATURE_HPP
 
 
-#include <cstdint>
-
-#include <array>
-
-#include "../System/Compiler.hpp"
+#include "X86FeatureBase.hpp"
 #include "../Text/String.hpp"
 
-#if defined(CORECAT_COMPILER_CLANG) || defined(CORECAT_COMPILER_GCC)
-#   include <cpuid.h>
-#elif defined(CORECAT_COMPILER_MSVC)
-#   include <intrin.h>
-#else
-#   error Unknown compiler
-#endif
-
 
 namespace Cats {
 namespace Corecat {
@@ -50,37 +38,14 @@ inline namespace X86 {
 
 namespace {
 
-struct X86Feature {
+struct X86Feature : public X86FeatureBase {
     
 public:
     
-    static std::array<std::uint32_t, 4> cpuid(std::uint32_t func, std::uint32_t sub) {
-        
-        std::array<std::uint32_t, 4> data;
-#if defined(CORECAT_COMPILER_CLANG) || defined(CORECAT_COMPILER_GCC)
-        // __cpuid_count is a macro, so :: is not needed
-        __cpuid_count(func, sub, data[0], data[1], data[2], data[3]);
-#elif defined(CORECAT_COMPILER_MSVC)
-        ::__cpuidex(reinterpret_cast<int*>(data.data()), func, sub);
-#endif
-        return data;
-        
-    }
-    static bool cpuidBit(std::uint32_t func, std::uint32_t sub, std::uint32_t reg, std::uint32_t bit) {
-        
-        return (cpuid(func, sub)[reg] >> bit) & 1;
-        
-    }
-    
-    static const std::uint32_t MAX_BASIC_CPUID, MAX_EXTENDED_CPUID;
     static const String8 VENDOR, BRAND;
-    static const bool MMX, SSE, SSE2, SSE3, SSSE3, SSE4_1, SSE4_2, AVX, AVX2;
     
 };
 
-const std::uint32_t
-    X86Feature::MAX_BASIC_CPUID = X86Feature::cpuid(0x00, 0)[0],
-    X86Feature::MAX_EXTENDED_CPUID = X86Feature::cpuid(0x80000000, 0)[0];
 const Text::String8
     X86Feature::VENDOR = [] {
         
@@ -103,16 +68,6 @@ const Text::String8
         return Text::String8(str);
         
     }();
-const bool
-    X86Feature::MMX = X86Feature::cpuidBit(0x01, 0, 3, 23),
-    X86Feature::SSE = X86Feature::cpuidBit(0x01, 0, 3, 25),
-    X86Feature::SSE2 = X86Feature::cpuidBit(0x01, 0, 3, 26),
-    X86Feature::SSE3 = X86Feature::cpuidBit(0x01, 0, 2, 0),
-    X86Feature::SSSE3 = X86Feature::cpuidBit(0x01, 0, 2, 9),
-    X86Feature::SSE4_1 = X86Feature::cpuidBit(0x01, 0, 2, 19),
-    X86Feature::SSE4_2 = X86Feature::cpuidBit(0x01, 0, 2, 20),
-    X86Feature::AVX = X86Feature::cpuidBit(0x01, 0, 2, 28),
-    X86Feature::AVX2 = MAX_BASIC_CPUID >= 0x07 && X86Feature::cpuidBit(0x07, 0, 1, 5);
 
 }
 
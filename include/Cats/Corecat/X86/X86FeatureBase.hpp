@@ -0,0 +1,105 @@
+/*
+ *
+ * MIT License
+ *
+ * Copyright (c) 2016-2018 The Cats Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef CATS_CORECAT_X86_X86FEATUREBASE_HPP
+#define CATS_CORECAT_X86_X86FEATUREBASE_HPP
+
+
+#include <cstdint>
+
+#include <array>
+
+#include "../System/Compiler.hpp"
+
+#if defined(CORECAT_COMPILER_CLANG) || defined(CORECAT_COMPILER_GCC)
+#   include <cpuid.h>
+#elif defined(CORECAT_COMPILER_MSVC)
+#   include <intrin.h>
+#else
+#   error Unknown compiler
+#endif
+
+
+namespace Cats {
+namespace Corecat {
+inline namespace X86 {
+
+namespace {
+
+// The feature flags alone, without VENDOR and BRAND, so that Text can dispatch on them without depending on String
+struct X86FeatureBase {
+    
+public:
+    
+    static std::array<std::uint32_t, 4> cpuid(std::uint32_t func, std::uint32_t sub) {
+        
+        std::array<std::uint32_t, 4> data;
+#if defined(CORECAT_COMPILER_CLANG) || defined(CORECAT_COMPILER_GCC)
+        // __cpuid_count is a macro, so :: is not needed
+        __cpuid_count(func, sub, data[0], data[1], data[2], data[3]);
+#elif defined(CORECAT_COMPILER_MSVC)
+        ::__cpuidex(reinterpret_cast<int*>(data.data()), func, sub);
+#endif
+        return data;
+        
+    }
+    static bool cpuidBit(std::uint32_t func, std::uint32_t sub, std::uint32_t reg, std::uint32_t bit) {
+        
+        return (cpuid(func, sub)[reg] >> bit) & 1;
+        
+    }
+    
+    static const std::uint32_t MAX_BASIC_CPUID, MAX_EXTENDED_CPUID;
+    static const bool MMX, SSE, SSE2, SSE3, SSSE3, SSE4_1, SSE4_2, AVX, AVX2, BMI1, BMI2, SHA;
+    
+};
+
+const std::uint32_t
+    X86FeatureBase::MAX_BASIC_CPUID = X86FeatureBase::cpuid(0x00, 0)[0],
+    X86FeatureBase::MAX_EXTENDED_CPUID = X86FeatureBase::cpuid(0x80000000, 0)[0];
+const bool
+    X86FeatureBase::MMX = X86FeatureBase::cpuidBit(0x01, 0, 3, 23),
+    X86FeatureBase::SSE = X86FeatureBase::cpuidBit(0x01, 0, 3, 25),
+    X86FeatureBase::SSE2 = X86FeatureBase::cpuidBit(0x01, 0, 3, 26),
+    X86FeatureBase::SSE3 = X86FeatureBase::cpuidBit(0x01, 0, 2, 0),
+    X86FeatureBase::SSSE3 = X86FeatureBase::cpuidBit(0x01, 0, 2, 9),
+    X86FeatureBase::SSE4_1 = X86FeatureBase::cpuidBit(0x01, 0, 2, 19),
+    X86FeatureBase::SSE4_2 = X86FeatureBase::cpuidBit(0x01, 0, 2, 20),
+    X86FeatureBase::AVX = X86FeatureBase::cpuidBit(0x01, 0, 2, 28),
+    X86FeatureBase::AVX2 = MAX_BASIC_CPUID >= 0x07 && X86FeatureBase::cpuidBit(0x07, 0, 1, 5),
+    X86FeatureBase::BMI1 = MAX_BASIC_CPUID >= 0x07 && X86FeatureBase::cpuidBit(0x07, 0, 1, 3),
+    X86FeatureBase::BMI2 = MAX_BASIC_CPUID >= 0x07 && X86FeatureBase::cpuidBit(0x07, 0, 1, 8),
+    X86FeatureBase::SHA = MAX_BASIC_CPUID >= 0x07 && X86FeatureBase::cpuidBit(0x07, 0, 1, 29);
+    
+    
+}
+
+}
+}
+}
+
+
+#endif